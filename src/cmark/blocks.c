@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "cmark_ctype.h"
 #include "syntax_extension.h"
@@ -22,6 +23,11 @@
 #include "houdini.h"
 #include "buffer.h"
 #include "footnotes.h"
+#include "timings.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define CODE_INDENT 4
 #define TAB_STOP 4
@@ -65,7 +71,7 @@ static cmark_node *make_block(cmark_mem *mem, cmark_node_type tag,
                               int start_line, int start_column) {
   cmark_node *e;
 
-  e = (cmark_node *)mem->calloc(1, sizeof(*e));
+  e = (cmark_node *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_NODE, 1, sizeof(*e));
   cmark_strbuf_init(mem, &e->content, 32);
   e->type = (uint16_t)tag;
   e->flags = CMARK_NODE__OPEN;
@@ -93,18 +99,31 @@ int cmark_parser_attach_syntax_extension(cmark_parser *parser,
   return 1;
 }
 
+static void S_events_free(cmark_parser *parser);
+
 static void cmark_parser_dispose(cmark_parser *parser) {
+  if (parser->events)
+    S_events_free(parser);
+
   if (parser->root)
     cmark_node_free(parser->root);
 
   if (parser->refmap)
     cmark_map_free(parser->refmap);
+
+  cmark_node_list_free(parser->mem, &parser->footnote_defs);
 }
 
 static void cmark_parser_reset(cmark_parser *parser) {
   cmark_llist *saved_exts = parser->syntax_extensions;
   cmark_llist *saved_inline_exts = parser->inline_syntax_extensions;
   int saved_options = parser->options;
+  int saved_num_threads = parser->num_threads;
+  int saved_max_blocks = parser->max_blocks;
+  cmark_limits saved_limits = parser->limits;
+  bool saved_has_limits = parser->has_limits;
+  cmark_limit saved_limit_exceeded = parser->limit_exceeded;
+  struct cmark_inline_pool *saved_inline_pool = parser->inline_pool;
   cmark_mem *saved_mem = parser->mem;
 
   cmark_parser_dispose(parser);
@@ -122,10 +141,17 @@ static void cmark_parser_reset(cmark_parser *parser) {
   parser->current = document;
 
   parser->last_buffer_ended_with_cr = false;
+  cmark_inlines_reset_special_characters(parser->special_chars, parser->skip_chars);
 
   parser->syntax_extensions = saved_exts;
   parser->inline_syntax_extensions = saved_inline_exts;
   parser->options = saved_options;
+  parser->inline_pool = saved_inline_pool;
+  parser->num_threads = saved_num_threads;
+  parser->max_blocks = saved_max_blocks;
+  parser->limits = saved_limits;
+  parser->has_limits = saved_has_limits;
+  parser->limit_exceeded = saved_limit_exceeded;
 }
 
 cmark_parser *cmark_parser_new_with_mem(int options, cmark_mem *mem) {
@@ -136,6 +162,49 @@ cmark_parser *cmark_parser_new_with_mem(int options, cmark_mem *mem) {
   return parser;
 }
 
+void cmark_parser_set_num_threads(cmark_parser *parser, int num_threads) {
+  parser->num_threads = num_threads;
+}
+
+void cmark_parser_set_max_blocks(cmark_parser *parser, int max_blocks) {
+  parser->max_blocks = max_blocks > 0 ? max_blocks : 0;
+}
+
+void cmark_parser_set_limits(cmark_parser *parser, const cmark_limits *limits) {
+  memset(&parser->limits, 0, sizeof(parser->limits));
+  if (limits)
+    parser->limits = *limits;
+  parser->has_limits = parser->limits.max_depth > 0 ||
+                       parser->limits.max_nodes || parser->limits.max_table_cells ||
+                       parser->limits.max_output || parser->limits.max_seconds > 0;
+}
+
+cmark_limit cmark_parser_limit_exceeded(cmark_parser *parser) {
+  return parser->limit_exceeded;
+}
+
+bool cmark_parser_limit_reached(cmark_parser *parser, bool check_time) {
+  if (parser->limit_exceeded != CMARK_LIMIT_NONE)
+    return true;
+  if (parser->limits.max_nodes && parser->nodes > parser->limits.max_nodes)
+    parser->limit_exceeded = CMARK_LIMIT_NODES;
+  else if (check_time && parser->deadline && cmark_timer_now() > parser->deadline)
+    parser->limit_exceeded = CMARK_LIMIT_TIME;
+  else
+    return false;
+  parser->stopped = true;
+  return true;
+}
+
+// Starts the clock for max_seconds, and forgets the limit which stopped the
+// previous document
+static void S_start_limits(cmark_parser *parser) {
+  parser->limit_exceeded = CMARK_LIMIT_NONE;
+  if (parser->limits.max_seconds > 0)
+    parser->deadline = cmark_timer_now() +
+                       (uint64_t)(parser->limits.max_seconds * 1e9) + 1;
+}
+
 cmark_parser *cmark_parser_new(int options) {
   extern cmark_mem CMARK_DEFAULT_MEM_ALLOCATOR;
   return cmark_parser_new_with_mem(options, &CMARK_DEFAULT_MEM_ALLOCATOR);
@@ -148,6 +217,8 @@ void cmark_parser_free(cmark_parser *parser) {
   cmark_strbuf_free(&parser->linebuf);
   cmark_llist_free(parser->mem, parser->syntax_extensions);
   cmark_llist_free(parser->mem, parser->inline_syntax_extensions);
+  if (parser->inline_pool)
+    cmark_inline_pool_free(mem, parser->inline_pool);
   mem->free(parser);
 }
 
@@ -182,7 +253,10 @@ static CMARK_INLINE bool accepts_lines(cmark_node_type block_type) {
 
 static CMARK_INLINE bool contains_inlines(cmark_node *node) {
   if (node->extension && node->extension->contains_inlines_func) {
-    return node->extension->contains_inlines_func(node->extension, node) != 0;
+    CMARK_EXT_TIMER_START(timer);
+    bool res = node->extension->contains_inlines_func(node->extension, node) != 0;
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_CONTAINS_INLINES);
+    return res;
   }
 
   return (node->type == CMARK_NODE_PARAGRAPH ||
@@ -232,21 +306,32 @@ static void remove_trailing_blank_lines(cmark_strbuf *ln) {
   }
 }
 
+static bool S_list_or_item(const cmark_node *node) {
+  return S_type(node) == CMARK_NODE_LIST || S_type(node) == CMARK_NODE_ITEM;
+}
+
 // Check to see if a node ends with a blank line, descending
-// if needed into lists and sublists.
+// if needed into lists and sublists. The lists and items on the way are
+// closed, so they remember the result; otherwise every enclosing list
+// would walk down the same nested lists again.
 static bool ends_with_blank_line(cmark_node *node) {
   cmark_node *cur = node;
+  bool res = false;
+
   while (cur != NULL) {
     if (S_last_line_blank(cur)) {
-      return true;
+      res = true;
+      break;
     }
-    if (S_type(cur) == CMARK_NODE_LIST || S_type(cur) == CMARK_NODE_ITEM) {
-      cur = cur->last_child;
-    } else {
-      cur = NULL;
+    if (cur->flags & CMARK_NODE__ENDS_BLANK_CHECKED) {
+      res = (cur->flags & CMARK_NODE__ENDS_BLANK) != 0;
+      break;
     }
+    cur = S_list_or_item(cur) ? cur->last_child : NULL;
   }
-  return false;
+  for (; node != cur && S_list_or_item(node); node = node->last_child)
+    node->flags |= CMARK_NODE__ENDS_BLANK_CHECKED | (res ? CMARK_NODE__ENDS_BLANK : 0);
+  return res;
 }
 
 static cmark_node *finalize(cmark_parser *parser, cmark_node *b) {
@@ -357,6 +442,10 @@ static cmark_node *finalize(cmark_parser *parser, cmark_node *b) {
 
     break;
 
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    cmark_node_list_push(parser->mem, &parser->footnote_defs, b);
+    break;
+
   default:
     break;
   }
@@ -378,6 +467,7 @@ static cmark_node *add_child(cmark_parser *parser, cmark_node *parent,
   cmark_node *child =
       make_block(parser->mem, block_type, parser->line_number, start_column);
   child->parent = parent;
+  parser->nodes++;
 
   if (parent->last_child) {
     parent->last_child->next = child;
@@ -390,32 +480,127 @@ static cmark_node *add_child(cmark_parser *parser, cmark_node *parent,
   return child;
 }
 
+// Sets the special characters of the parser's own tables, so that parsers
+// on other threads are not affected. Removing resets them to the core ones.
 void cmark_manage_extensions_special_characters(cmark_parser *parser, int add) {
   cmark_llist *tmp_ext;
 
+  cmark_inlines_reset_special_characters(parser->special_chars, parser->skip_chars);
+  if (!add)
+    return;
+
   for (tmp_ext = parser->inline_syntax_extensions; tmp_ext; tmp_ext=tmp_ext->next) {
     cmark_syntax_extension *ext = (cmark_syntax_extension *) tmp_ext->data;
     cmark_llist *tmp_char;
     for (tmp_char = ext->special_inline_chars; tmp_char; tmp_char=tmp_char->next) {
       unsigned char c = (unsigned char)(size_t)tmp_char->data;
-      if (add)
-        cmark_inlines_add_special_character(c, ext->emphasis);
-      else
-        cmark_inlines_remove_special_character(c, ext->emphasis);
+      parser->special_chars[c] = 1;
+      if (ext->emphasis)
+        parser->skip_chars[c] = 1;
     }
   }
 }
 
+#ifdef _OPENMP
+// Once the block structure is complete, the inline parse of a leaf block
+// only reads its own content and the reference map. Collect the leaves and
+// parse them on several threads; the inlines are attached to their own
+// leaf, so document order is kept without any merging.
+static void process_inlines_parallel(cmark_parser *parser, cmark_node *root,
+                                     cmark_map *refmap, int options) {
+  cmark_iter *iter = cmark_iter_new(root);
+  cmark_node **leaves = NULL;
+  cmark_node *cur;
+  cmark_event_type ev_type;
+  bufsize_t size = 0, n = 0, i;
+
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cur = cmark_iter_get_node(iter);
+    if (ev_type == CMARK_EVENT_ENTER && contains_inlines(cur)) {
+      if (n == size) {
+        size = size ? 2 * size : 256;
+        leaves = (cmark_node **)parser->mem->realloc(leaves, size * sizeof(cmark_node *));
+      }
+      leaves[n++] = cur;
+    }
+  }
+  cmark_iter_free(iter);
+  if (n == 0)
+    return;
+
+  // lookups must not sort the map lazily from several threads
+  cmark_map_sort(refmap);
+
+  // Every thread takes its leaves in document order, so the footnote
+  // references of a thread's pool are in order too; remember which pool
+  // holds the references of each leaf, and where they end, to merge them.
+  int nthreads = parser->num_threads;
+  cmark_inline_pool **pools = (cmark_inline_pool **)parser->mem->calloc(nthreads, sizeof(cmark_inline_pool *));
+  int *leaf_pool = NULL;
+  size_t *leaf_end = NULL;
+  if (options & CMARK_OPT_FOOTNOTES) {
+    leaf_pool = (int *)parser->mem->calloc(n, sizeof(int));
+    leaf_end = (size_t *)parser->mem->calloc(n, sizeof(size_t));
+  }
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    int t = omp_get_thread_num();
+    cmark_inline_pool *pool = pools[t] = cmark_inline_pool_new(parser->mem);
+#pragma omp for schedule(dynamic, 16)
+    for (i = 0; i < n; i++) {
+      cmark_parse_inlines_with_pool(parser, leaves[i], refmap, options, pool);
+      if (leaf_end) {
+        leaf_pool[i] = t;
+        leaf_end[i] = cmark_inline_pool_footnote_refs(pool)->len;
+      }
+    }
+  }
+
+  if (leaf_end) {
+    size_t *pos = (size_t *)parser->mem->calloc(nthreads, sizeof(size_t));
+    if (!parser->inline_pool)
+      parser->inline_pool = cmark_inline_pool_new(parser->mem);
+    cmark_node_list *refs = cmark_inline_pool_footnote_refs(parser->inline_pool);
+    for (i = 0; i < n; i++) {
+      cmark_node_list *src = cmark_inline_pool_footnote_refs(pools[leaf_pool[i]]);
+      while (pos[leaf_pool[i]] < leaf_end[i])
+        cmark_node_list_push(parser->mem, refs, src->items[pos[leaf_pool[i]]++]);
+    }
+    parser->mem->free(pos);
+    parser->mem->free(leaf_pool);
+    parser->mem->free(leaf_end);
+  }
+
+  for (int t = 0; t < nthreads; t++) {
+    if (pools[t])
+      cmark_inline_pool_free(parser->mem, pools[t]);
+  }
+  parser->mem->free(pools);
+  parser->mem->free(leaves);
+}
+#endif
+
 // Walk through node and all children, recursively, parsing
 // string content into inline content where appropriate.
-static void process_inlines(cmark_parser *parser,
+static void process_inlines(cmark_parser *parser, cmark_node *root,
                             cmark_map *refmap, int options) {
-  cmark_iter *iter = cmark_iter_new(parser->root);
+  cmark_iter *iter = cmark_iter_new(root);
   cmark_node *cur;
   cmark_event_type ev_type;
 
   cmark_manage_extensions_special_characters(parser, true);
 
+#ifdef _OPENMP
+  if (parser->num_threads > 1 && !parser->has_limits &&
+      parser->mem != cmark_get_arena_mem_allocator()) {
+    cmark_iter_free(iter);
+    process_inlines_parallel(parser, root, refmap, options);
+    cmark_manage_extensions_special_characters(parser, false);
+    return;
+  }
+#endif
+
   while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
     cur = cmark_iter_get_node(iter);
     if (ev_type == CMARK_EVENT_ENTER) {
@@ -430,82 +615,629 @@ static void process_inlines(cmark_parser *parser,
   cmark_iter_free(iter);
 }
 
-static int sort_footnote_by_ix(const void *_a, const void *_b) {
-  cmark_footnote *a = *(cmark_footnote **)_a;
-  cmark_footnote *b = *(cmark_footnote **)_b;
-  return (int)a->ix - (int)b->ix;
+static bool S_lazy_inlines(cmark_parser *parser) {
+  return (parser->options & CMARK_OPT_LAZY_INLINES) &&
+         !(parser->options & CMARK_OPT_FOOTNOTES) && !parser->has_limits;
 }
 
-static void process_footnotes(cmark_parser *parser) {
-  // * Collect definitions in a map.
-  // * Iterate the references in the document in order, assigning indices to
-  //   definitions in the order they're seen.
-  // * Write out the footnotes at the bottom of the document in index order.
-
-  cmark_map *map = cmark_footnote_map_new(parser->mem);
-
+// Flag the leaves instead of parsing them; they keep their string content.
+static void mark_pending_inlines(cmark_parser *parser) {
   cmark_iter *iter = cmark_iter_new(parser->root);
   cmark_node *cur;
   cmark_event_type ev_type;
 
   while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
     cur = cmark_iter_get_node(iter);
-    if (ev_type == CMARK_EVENT_EXIT && cur->type == CMARK_NODE_FOOTNOTE_DEFINITION) {
-      cmark_node_unlink(cur);
-      cmark_footnote_create(map, cur);
+    if (ev_type == CMARK_EVENT_ENTER && contains_inlines(cur)) {
+      cur->flags |= CMARK_NODE__INLINES_PENDING;
+      parser->pending_inlines++;
     }
   }
 
   cmark_iter_free(iter);
-  iter = cmark_iter_new(parser->root);
+}
+
+// Hand the reference map and extensions over to the document, in a parser
+// that has no block state, so the inline parser can run after the real
+// parser has been reset or freed.
+static void attach_pending_inlines(cmark_parser *parser) {
+  cmark_mem *mem = parser->mem;
+  cmark_parser *lazy = (cmark_parser *)mem->calloc(1, sizeof(cmark_parser));
+  cmark_llist *tmp;
+
+  lazy->mem = mem;
+  lazy->refmap = parser->refmap;
+  parser->refmap = NULL;
+  lazy->options = parser->options;
+  lazy->backslash_ispunct = parser->backslash_ispunct;
+  lazy->pending_inlines = parser->pending_inlines;
+  for (tmp = parser->syntax_extensions; tmp; tmp = tmp->next)
+    lazy->syntax_extensions = cmark_llist_append(mem, lazy->syntax_extensions, tmp->data);
+  for (tmp = parser->inline_syntax_extensions; tmp; tmp = tmp->next)
+    lazy->inline_syntax_extensions =
+        cmark_llist_append(mem, lazy->inline_syntax_extensions, tmp->data);
+  parser->root->as.opaque = lazy;
+}
+
+void cmark_lazy_inlines_free(cmark_parser *lazy) {
+  cmark_mem *mem = lazy->mem;
+  if (lazy->refmap)
+    cmark_map_free(lazy->refmap);
+  cmark_llist_free(mem, lazy->syntax_extensions);
+  cmark_llist_free(mem, lazy->inline_syntax_extensions);
+  if (lazy->inline_pool)
+    cmark_inline_pool_free(mem, lazy->inline_pool);
+  mem->free(lazy);
+}
+
+// An extension with a postprocess_node_func, and the node whose descendants
+// it skips, if any
+typedef struct {
+  cmark_syntax_extension *ext;
+  cmark_node *skip;
+} postprocess_visitor;
+
+static bool S_visits_type(cmark_syntax_extension *ext, uint16_t type) {
+  cmark_llist *tmp;
+
+  for (tmp = ext->postprocess_types; tmp; tmp = tmp->next) {
+    if ((uint16_t)(size_t)tmp->data == type)
+      return true;
+  }
+  return false;
+}
+
+// Merge the text nodes which follow 'text' into it
+static void S_merge_text(cmark_mem *mem, cmark_node *text) {
+  cmark_strbuf buf = CMARK_BUF_INIT(mem);
+  cmark_node *tmp;
+
+  cmark_strbuf_put(&buf, text->as.literal.data, text->as.literal.len);
+  while ((tmp = text->next) && tmp->type == CMARK_NODE_TEXT) {
+    cmark_strbuf_put(&buf, tmp->as.literal.data, tmp->as.literal.len);
+    text->end_column = tmp->end_column;
+    cmark_node_free(tmp);
+  }
+  cmark_chunk_free(mem, &text->as.literal);
+  text->as.literal = cmark_chunk_buf_detach(&buf);
+}
+
+static void S_visit_node(cmark_parser *parser, postprocess_visitor *visitors,
+                         int n, cmark_node *node) {
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if (visitors[i].skip || !S_visits_type(visitors[i].ext, node->type))
+      continue;
+    CMARK_EXT_TIMER_START(ext_timer);
+    if (!visitors[i].ext->postprocess_node_func(visitors[i].ext, parser, node))
+      visitors[i].skip = node;
+    CMARK_EXT_TIMER_STOP(ext_timer, visitors[i].ext, CMARK_EXT_POSTPROCESS);
+  }
+}
+
+static void S_leave_node(postprocess_visitor *visitors, int n, cmark_node *node) {
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if (visitors[i].skip == node)
+      visitors[i].skip = NULL;
+  }
+}
+
+// Walk 'root' once, handing every node to the extensions which visit its
+// type. Like cmark_iter, the next node is looked up before the visitors
+// run, so nodes they insert after the current one are not visited.
+static void S_postprocess_nodes(cmark_parser *parser, cmark_node *root) {
+  postprocess_visitor *visitors;
+  cmark_llist *tmp;
+  cmark_node *node, *child, *sibling;
+  bool merge_text = false;
+  int n = 0;
+
+  for (tmp = parser->syntax_extensions; tmp; tmp = tmp->next) {
+    if (((cmark_syntax_extension *)tmp->data)->postprocess_node_func)
+      n++;
+  }
+  if (n == 0)
+    return;
+
+  visitors = (postprocess_visitor *)parser->mem->calloc(n, sizeof(postprocess_visitor));
+  n = 0;
+  for (tmp = parser->syntax_extensions; tmp; tmp = tmp->next) {
+    cmark_syntax_extension *ext = (cmark_syntax_extension *)tmp->data;
+    if (ext->postprocess_node_func) {
+      visitors[n++].ext = ext;
+      merge_text = merge_text || S_visits_type(ext, CMARK_NODE_TEXT);
+    }
+  }
+
+  CMARK_TIMER_START(timer);
+  node = root;
+  while (node) {
+    if (merge_text && node->type == CMARK_NODE_TEXT && node->next &&
+        node->next->type == CMARK_NODE_TEXT)
+      S_merge_text(parser->mem, node);
+
+    child = node->first_child;
+    sibling = node->next;
+    S_visit_node(parser, visitors, n, node);
+    if (child) {
+      node = child;
+      continue;
+    }
+
+    S_leave_node(visitors, n, node);
+    while (node != root && !sibling) {
+      node = node->parent;
+      S_leave_node(visitors, n, node);
+      sibling = node->next;
+    }
+    node = node == root ? NULL : sibling;
+  }
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_POSTPROCESS, NULL);
+
+  parser->mem->free(visitors);
+}
+
+// Does for one leaf what cmark_parser_finish does for the whole document:
+// parse the inlines and run the postprocessors.
+static void S_parse_pending_leaf(cmark_parser *lazy, cmark_node *node) {
+  cmark_llist *tmp;
+
+  node->flags &= ~CMARK_NODE__INLINES_PENDING;
+  lazy->pending_inlines--;
+
+  cmark_manage_extensions_special_characters(lazy, true);
+  cmark_parse_inlines(lazy, node, lazy->refmap, lazy->options);
+  cmark_manage_extensions_special_characters(lazy, false);
+
+  S_postprocess_nodes(lazy, node);
+  for (tmp = lazy->syntax_extensions; tmp; tmp = tmp->next) {
+    cmark_syntax_extension *ext = (cmark_syntax_extension *) tmp->data;
+    if (ext->postprocess_func) {
+      CMARK_EXT_TIMER_START(ext_timer);
+      ext->postprocess_func(ext, lazy, node);
+      CMARK_EXT_TIMER_STOP(ext_timer, ext, CMARK_EXT_POSTPROCESS);
+    }
+  }
+}
+
+void cmark_parse_pending_inlines(cmark_node *node) {
+  cmark_node *root = node;
+  cmark_parser *lazy;
+
+  // only blocks can be or contain pending leaves
+  if (!CMARK_NODE_BLOCK_P(node))
+    return;
+  while (root->parent)
+    root = root->parent;
+  if (root->type != CMARK_NODE_DOCUMENT || !root->as.opaque)
+    return;
+  lazy = (cmark_parser *)root->as.opaque;
+  if (!lazy->pending_inlines)
+    return;
+
+  if (node->flags & CMARK_NODE__INLINES_PENDING) {
+    S_parse_pending_leaf(lazy, node);
+  } else {
+    // the iterator parses every pending leaf it enters
+    cmark_iter *iter = cmark_iter_new(node);
+    while (cmark_iter_next(iter) != CMARK_EVENT_DONE)
+      ;
+    cmark_iter_free(iter);
+  }
+}
+
+// Does node belong to the document, rather than to a definition which has
+// been unlinked from it?
+static bool S_in_document(cmark_parser *parser, cmark_node *node) {
+  while (node->parent)
+    node = node->parent;
+  return node == parser->root;
+}
+
+// A chunk holding the decimal representation of n
+static cmark_chunk S_number_chunk(cmark_mem *mem, unsigned int n) {
+  unsigned char digits[16], *p = digits + sizeof(digits);
+  cmark_chunk c;
+
+  do {
+    *--p = (unsigned char)('0' + n % 10);
+    n /= 10;
+  } while (n);
+
+  c.len = (bufsize_t)(digits + sizeof(digits) - p);
+  c.data = (unsigned char *)mem->calloc(c.len + 1, 1);
+  c.alloc = 1;
+  memcpy(c.data, p, c.len);
+  return c;
+}
+
+// Replace a reference without a definition by its source text
+static void S_footnote_ref_to_text(cmark_parser *parser, cmark_node *cur) {
+  cmark_node *text = (cmark_node *)cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_NODE, 1, sizeof(*text));
+  cmark_strbuf_init(parser->mem, &text->content, 0);
+  text->type = (uint16_t) CMARK_NODE_TEXT;
+
+  cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
+  cmark_strbuf_puts(&buf, "[^");
+  cmark_strbuf_put(&buf, cur->as.literal.data, cur->as.literal.len);
+  cmark_strbuf_putc(&buf, ']');
+
+  text->as.literal = cmark_chunk_buf_detach(&buf);
+  cmark_node_insert_after(cur, text);
+  cmark_node_free(cur);
+}
+
+// Returns whether references without a definition were turned into text,
+// which may need to be consolidated with the text around them.
+static bool process_footnotes(cmark_parser *parser) {
+  // * Collect the definitions, which were registered as they were closed,
+  //   in a map.
+  // * Go through the references, which the inline parser recorded in
+  //   document order, assigning indices to definitions in the order they're
+  //   seen.
+  // * Write out the footnotes at the bottom of the document in index order.
+
+  cmark_map *map = cmark_footnote_map_new(parser->mem);
+  cmark_node_list *defs = &parser->footnote_defs;
+  cmark_node_list *refs = parser->inline_pool
+                              ? cmark_inline_pool_footnote_refs(parser->inline_pool)
+                              : NULL;
+  cmark_footnote **ordered = NULL;
   unsigned int ix = 0;
+  bool unmatched = false;
+  size_t i;
 
-  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
-    cur = cmark_iter_get_node(iter);
-    if (ev_type == CMARK_EVENT_EXIT && cur->type == CMARK_NODE_FOOTNOTE_REFERENCE) {
-      cmark_footnote *footnote = (cmark_footnote *)cmark_map_lookup(map, &cur->as.literal);
-      if (footnote) {
-        if (!footnote->ix)
-          footnote->ix = ++ix;
-
-        char n[32];
-        snprintf(n, sizeof(n), "%d", footnote->ix);
-        cmark_chunk_free(parser->mem, &cur->as.literal);
-        cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
-        cmark_strbuf_puts(&buf, n);
-
-        cur->as.literal = cmark_chunk_buf_detach(&buf);
-      } else {
-        cmark_node *text = (cmark_node *)parser->mem->calloc(1, sizeof(*text));
-        cmark_strbuf_init(parser->mem, &text->content, 0);
-        text->type = (uint16_t) CMARK_NODE_TEXT;
-
-        cmark_strbuf buf = CMARK_BUF_INIT(parser->mem);
-        cmark_strbuf_puts(&buf, "[^");
-        cmark_strbuf_put(&buf, cur->as.literal.data, cur->as.literal.len);
-        cmark_strbuf_putc(&buf, ']');
-
-        text->as.literal = cmark_chunk_buf_detach(&buf);
-        cmark_node_insert_after(cur, text);
-        cmark_node_free(cur);
+  for (i = 0; i < defs->len; i++) {
+    cmark_node_unlink(defs->items[i]);
+    cmark_footnote_create(map, defs->items[i]);
+  }
+  defs->len = 0;
+
+  if (refs && refs->len)
+    ordered = (cmark_footnote **)parser->mem->calloc(refs->len, sizeof(cmark_footnote *));
+
+  for (i = 0; refs && i < refs->len; i++) {
+    cmark_node *cur = refs->items[i];
+
+    // references inside definitions are left alone
+    if (!S_in_document(parser, cur))
+      continue;
+
+    cmark_footnote *footnote = (cmark_footnote *)cmark_map_lookup(map, &cur->as.literal);
+    if (footnote) {
+      if (!footnote->ix) {
+        footnote->ix = ++ix;
+        ordered[ix - 1] = footnote;
       }
+
+      cmark_chunk_free(parser->mem, &cur->as.literal);
+      cur->as.literal = S_number_chunk(parser->mem, footnote->ix);
+    } else {
+      S_footnote_ref_to_text(parser, cur);
+      unmatched = true;
     }
   }
+  if (refs)
+    refs->len = 0;
 
-  cmark_iter_free(iter);
+  for (i = 0; i < ix; i++) {
+    cmark_node_append_child(parser->root, ordered[i]->node);
+    ordered[i]->node = NULL;
+  }
 
-  if (map->sorted) {
-    qsort(map->sorted, map->size, sizeof(cmark_map_entry *), sort_footnote_by_ix);
-    for (unsigned int i = 0; i < map->size; ++i) {
-      cmark_footnote *footnote = (cmark_footnote *)map->sorted[i];
-      if (!footnote->ix)
+  parser->mem->free(ordered);
+  cmark_map_free(map);
+  return unmatched;
+}
+
+// Event mode: instead of building the document, every top-level block is
+// finished as if it were the whole document and passed to the user as
+// soon as it is closed, then freed. A closed block cannot change anymore;
+// what it depends on later in the input are the link reference and
+// footnote definitions, which a first pass over the input collects.
+
+typedef struct cmark_event_state {
+  // NULL in the first pass, which only keeps the definitions
+  cmark_event_func func;
+  void *data;
+  // The first pass, until the input is fed a second time
+  cmark_parser *prepass;
+  bool prepassed;
+  bool entered;
+  // The references the inline parser resolves; parser->refmap only holds
+  // those that were closed since the last block was passed on
+  cmark_map *refmap;
+  // Footnote labels, and their definitions once these are closed
+  cmark_map *footnotes;
+  unsigned int footnote_ix;
+} cmark_event_state;
+
+static cmark_event_state *S_events_new(cmark_parser *parser,
+                                       cmark_event_func func, void *data) {
+  cmark_event_state *ev = (cmark_event_state *)parser->mem->calloc(1, sizeof(*ev));
+  ev->func = func;
+  ev->data = data;
+  ev->refmap = cmark_reference_map_new(parser->mem);
+  ev->footnotes = cmark_footnote_map_new(parser->mem);
+  return ev;
+}
+
+static void S_events_free(cmark_parser *parser) {
+  cmark_event_state *ev = parser->events;
+
+  if (ev->prepass)
+    cmark_parser_free(ev->prepass);
+  cmark_map_free(ev->refmap);
+  cmark_map_free(ev->footnotes);
+  parser->mem->free(ev);
+  parser->events = NULL;
+}
+
+// Move the definitions that were closed since the last block to the event
+// state. The first pass only keeps the footnote labels.
+static void S_take_definitions(cmark_parser *parser) {
+  cmark_event_state *ev = parser->events;
+  cmark_node_list *defs = &parser->footnote_defs;
+  cmark_footnote *footnote;
+  size_t i;
+
+  if (ev->func && parser->refmap->size) {
+    if (ev->prepassed) {
+      cmark_map_free(parser->refmap);
+      parser->refmap = cmark_reference_map_new(parser->mem);
+    } else {
+      cmark_map_append(ev->refmap, parser->refmap);
+    }
+  }
+
+  for (i = 0; i < defs->len; i++) {
+    cmark_node *def = defs->items[i];
+
+    if (!ev->func) {
+      footnote = cmark_footnote_create(ev->footnotes, def);
+      if (footnote)
+        footnote->node = NULL;
+      continue;
+    }
+
+    cmark_node_unlink(def);
+    footnote = (cmark_footnote *)cmark_map_lookup(ev->footnotes, &def->as.literal);
+    if (footnote && !footnote->node) {
+      footnote->node = def;
+      continue;
+    }
+    if (!footnote && !ev->prepassed) {
+      cmark_map *tmp = cmark_footnote_map_new(parser->mem);
+      footnote = cmark_footnote_create(tmp, def);
+      cmark_map_append(ev->footnotes, tmp);
+      cmark_map_free(tmp);
+      if (footnote)
         continue;
-      cmark_node_append_child(parser->root, footnote->node);
-      footnote->node = NULL;
     }
+    // a later definition of the same label
+    cmark_node_free(def);
   }
+  defs->len = 0;
+}
 
-  cmark_map_free(map);
+// Number the footnote references of the block whose inlines were just
+// parsed, continuing the numbering of the blocks before it. Returns
+// whether references without a definition were turned into text.
+static bool S_number_footnote_refs(cmark_parser *parser) {
+  cmark_event_state *ev = parser->events;
+  cmark_node_list *refs;
+  bool unmatched = false;
+  size_t i;
+
+  if (!parser->inline_pool)
+    return false;
+  refs = cmark_inline_pool_footnote_refs(parser->inline_pool);
+
+  for (i = 0; i < refs->len; i++) {
+    cmark_node *cur = refs->items[i];
+    cmark_footnote *footnote = (cmark_footnote *)cmark_map_lookup(ev->footnotes, &cur->as.literal);
+    if (footnote) {
+      if (!footnote->ix)
+        footnote->ix = ++ev->footnote_ix;
+      cmark_chunk_free(parser->mem, &cur->as.literal);
+      cur->as.literal = S_number_chunk(parser->mem, footnote->ix);
+    } else {
+      S_footnote_ref_to_text(parser, cur);
+      unmatched = true;
+    }
+  }
+  refs->len = 0;
+  return unmatched;
+}
+
+// Postprocess a block of the document, pass it to the user and free it
+static void S_pass_block(cmark_parser *parser, cmark_node *block) {
+  cmark_event_state *ev = parser->events;
+  cmark_event_type ev_type;
+  cmark_llist *tmp;
+  cmark_iter *iter;
+
+  S_postprocess_nodes(parser, block);
+  for (tmp = parser->syntax_extensions; tmp; tmp = tmp->next) {
+    cmark_syntax_extension *ext = (cmark_syntax_extension *) tmp->data;
+    if (ext->postprocess_func) {
+      CMARK_EXT_TIMER_START(ext_timer);
+      ext->postprocess_func(ext, parser, block);
+      CMARK_EXT_TIMER_STOP(ext_timer, ext, CMARK_EXT_POSTPROCESS);
+    }
+  }
+
+  if (!ev->entered) {
+    ev->entered = true;
+    ev->func(CMARK_EVENT_ENTER, parser->root, ev->data);
+  }
+  iter = cmark_iter_new(block);
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE)
+    ev->func(ev_type, cmark_iter_get_node(iter), ev->data);
+  cmark_iter_free(iter);
+
+  cmark_node_free(block);
+}
+
+static void S_emit_block(cmark_parser *parser, cmark_node *block) {
+  cmark_event_state *ev = parser->events;
+  bool definition = S_type(block) == CMARK_NODE_FOOTNOTE_DEFINITION;
+
+  S_take_definitions(parser);
+  if (!ev->func) {
+    cmark_node_free(block);
+    return;
+  }
+  // footnote definitions were taken aside for the end, or dropped
+  if (definition)
+    return;
+
+  process_inlines(parser, block, ev->refmap, parser->options);
+  if ((parser->options & CMARK_OPT_FOOTNOTES) && S_number_footnote_refs(parser))
+    cmark_consolidate_text_nodes(block);
+  S_pass_block(parser, block);
+}
+
+// Counts the top-level blocks closed since the last line, except footnote
+// definitions, and stops parsing once there are max_blocks of them. Only
+// blocks which were just started follow the last one counted: they are
+// dropped, along with the footnote definitions closed inside of them.
+static void S_count_closed_blocks(cmark_parser *parser) {
+  cmark_node_list *defs = &parser->footnote_defs;
+  cmark_node *node = parser->last_counted ? parser->last_counted->next
+                                          : parser->root->first_child;
+  size_t i, kept = 0;
+
+  while (node && !(node->flags & CMARK_NODE__OPEN) &&
+         parser->closed_blocks < parser->max_blocks) {
+    if (S_type(node) != CMARK_NODE_FOOTNOTE_DEFINITION)
+      parser->closed_blocks++;
+    parser->last_counted = node;
+    node = node->next;
+  }
+  if (parser->closed_blocks < parser->max_blocks)
+    return;
+
+  for (i = 0; i < defs->len; i++) {
+    cmark_node *top = defs->items[i];
+    while (top->parent != parser->root)
+      top = top->parent;
+    for (node = parser->last_counted->next; node && node != top; node = node->next)
+      ;
+    if (!node)
+      defs->items[kept++] = defs->items[i];
+  }
+  defs->len = kept;
+  while (parser->last_counted->next)
+    cmark_node_free(parser->last_counted->next);
+  parser->current = parser->root;
+  parser->stopped = true;
+}
+
+// Pass on the top-level blocks which are closed, called after every line
+static void S_emit_closed_blocks(cmark_parser *parser) {
+  cmark_node *block;
+
+  while ((block = parser->root->first_child) && !(block->flags & CMARK_NODE__OPEN))
+    S_emit_block(parser, block);
+}
+
+// Pass on the referenced footnote definitions in the order of their
+// numbers, and leave the document
+static void S_finish_events(cmark_parser *parser) {
+  cmark_event_state *ev = parser->events;
+  cmark_footnote **ordered = NULL;
+  cmark_map_entry *entry;
+  unsigned int i;
+
+  S_emit_closed_blocks(parser);
+
+  if (ev->footnote_ix) {
+    ordered = (cmark_footnote **)parser->mem->calloc(ev->footnote_ix, sizeof(cmark_footnote *));
+    for (entry = ev->footnotes->refs; entry; entry = entry->next) {
+      cmark_footnote *footnote = (cmark_footnote *)entry;
+      if (footnote->ix && footnote->node)
+        ordered[footnote->ix - 1] = footnote;
+    }
+  }
+
+  for (i = 0; i < ev->footnote_ix; i++) {
+    cmark_node *def;
+    if (!ordered[i])
+      continue;
+    def = ordered[i]->node;
+    ordered[i]->node = NULL;
+    cmark_node_append_child(parser->root, def);
+    process_inlines(parser, def, ev->refmap, parser->options);
+    // references inside definitions are left alone
+    if (parser->inline_pool)
+      cmark_inline_pool_footnote_refs(parser->inline_pool)->len = 0;
+    S_pass_block(parser, def);
+  }
+  parser->mem->free(ordered);
+
+  if (!ev->entered)
+    ev->func(CMARK_EVENT_ENTER, parser->root, ev->data);
+  ev->func(CMARK_EVENT_EXIT, parser->root, ev->data);
+}
+
+// Take over what the first pass collected, once the input is fed again
+static void S_end_prepass(cmark_parser *parser) {
+  cmark_event_state *ev = parser->events;
+  cmark_parser *pre = ev->prepass;
+
+  if (!pre)
+    return;
+
+  if (pre->linebuf.size) {
+    S_process_line(pre, pre->linebuf.ptr, pre->linebuf.size);
+    cmark_strbuf_clear(&pre->linebuf);
+  }
+  while (pre->current != pre->root)
+    pre->current = finalize(pre, pre->current);
+  S_emit_closed_blocks(pre);
+
+  cmark_map_free(ev->refmap);
+  ev->refmap = pre->refmap;
+  pre->refmap = NULL;
+  cmark_map_free(ev->footnotes);
+  ev->footnotes = pre->events->footnotes;
+  pre->events->footnotes = NULL;
+
+  cmark_parser_free(pre);
+  ev->prepass = NULL;
+  ev->prepassed = true;
+}
+
+void cmark_parser_set_event_func(cmark_parser *parser, cmark_event_func func,
+                                 void *data) {
+  if (parser->events)
+    S_events_free(parser);
+  if (func)
+    parser->events = S_events_new(parser, func, data);
+}
+
+void cmark_parser_feed_references(cmark_parser *parser, const char *buffer,
+                                  size_t len) {
+  cmark_event_state *ev = parser->events;
+  cmark_llist *ext;
+
+  if (!ev || ev->prepassed || parser->line_number > 0)
+    return;
+
+  if (!ev->prepass) {
+    cmark_parser *pre = cmark_parser_new_with_mem(parser->options, parser->mem);
+    for (ext = parser->syntax_extensions; ext; ext = ext->next)
+      cmark_parser_attach_syntax_extension(pre, (cmark_syntax_extension *)ext->data);
+    pre->backslash_ispunct = parser->backslash_ispunct;
+    pre->events = S_events_new(pre, NULL, NULL);
+    ev->prepass = pre;
+  }
+
+  S_parser_feed(ev->prepass, (const unsigned char *)buffer, len, false);
 }
 
 // Attempts to parse a list item marker (bullet or enumerated).
@@ -606,14 +1338,38 @@ static int lists_match(cmark_list *list_data, cmark_list *item_data) {
 }
 
 static cmark_node *finalize_document(cmark_parser *parser) {
+  CMARK_TIMER_START(finalize_timer);
   while (parser->current != parser->root) {
     parser->current = finalize(parser, parser->current);
   }
 
   finalize(parser, parser->root);
-  process_inlines(parser, parser->refmap, parser->options);
-  if (parser->options & CMARK_OPT_FOOTNOTES)
-    process_footnotes(parser);
+  CMARK_TIMER_STOP(finalize_timer, CMARK_PHASE_FINALIZE, NULL);
+
+  if (parser->events) {
+    S_finish_events(parser);
+    return parser->root;
+  }
+
+  CMARK_TIMER_START(inlines_timer);
+  if (S_lazy_inlines(parser))
+    mark_pending_inlines(parser);
+  else
+    process_inlines(parser, parser->root, parser->refmap, parser->options);
+  CMARK_TIMER_STOP(inlines_timer, CMARK_PHASE_INLINES, NULL);
+
+  // the inline parser merges text as it goes, except where footnote
+  // references turn out to be text
+  if (parser->options & CMARK_OPT_FOOTNOTES) {
+    CMARK_TIMER_START(footnotes_timer);
+    bool unmatched = process_footnotes(parser);
+    CMARK_TIMER_STOP(footnotes_timer, CMARK_PHASE_FOOTNOTES, NULL);
+    if (unmatched) {
+      CMARK_TIMER_START(consolidate_timer);
+      cmark_consolidate_text_nodes(parser->root);
+      CMARK_TIMER_STOP(consolidate_timer, CMARK_PHASE_CONSOLIDATE, NULL);
+    }
+  }
 
   return parser->root;
 }
@@ -648,8 +1404,21 @@ cmark_node *cmark_parse_document(const char *buffer, size_t len, int options) {
   return document;
 }
 
+#ifdef _OPENMP
+static bool S_parser_feed_parallel(cmark_parser *parser,
+                                   const unsigned char *buffer, size_t len);
+#endif
+
 void cmark_parser_feed(cmark_parser *parser, const char *buffer, size_t len) {
-  S_parser_feed(parser, (const unsigned char *)buffer, len, false);
+  if (parser->events)
+    S_end_prepass(parser);
+
+  CMARK_TIMER_START(timer);
+#ifdef _OPENMP
+  if (!S_parser_feed_parallel(parser, (const unsigned char *)buffer, len))
+#endif
+    S_parser_feed(parser, (const unsigned char *)buffer, len, false);
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_BLOCKS, NULL);
 }
 
 void cmark_parser_feed_reentrant(cmark_parser *parser, const char *buffer, size_t len) {
@@ -669,13 +1438,17 @@ static void S_parser_feed(cmark_parser *parser, const unsigned char *buffer,
                           size_t len, bool eof) {
   const unsigned char *end = buffer + len;
   static const uint8_t repl[] = {239, 191, 189};
+  CMARK_TIMER_START(timer);
+
+  if (parser->has_limits && parser->line_number == 0 && !parser->linebuf.size)
+    S_start_limits(parser);
 
   if (parser->last_buffer_ended_with_cr && *buffer == '\n') {
     // skip NL if last buffer ended with CR ; see #117
     buffer++;
   }
   parser->last_buffer_ended_with_cr = false;
-  while (buffer < end) {
+  while (buffer < end && !parser->stopped) {
     const unsigned char *eol;
     bufsize_t chunk_len;
     bool process = false;
@@ -729,8 +1502,240 @@ static void S_parser_feed(cmark_parser *parser, const unsigned char *buffer,
       }
     }
   }
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_BLOCKS, NULL);
 }
 
+#ifdef _OPENMP
+// Speculative parallel block parsing.
+//
+// Large documents are usually a sequence of top-level sections. The input
+// is cut into chunks at lines that start an ATX heading or a thematic break
+// in the first column, and every chunk is block parsed by its own parser.
+// Such a line closes every open block, except a few that can swallow it;
+// if one of those is open at the end of a chunk, the speculative parse of
+// the next chunk is discarded and it is fed to the preceding parser instead.
+// The trees and reference maps are then concatenated in document order.
+
+#define PARALLEL_MIN_CHUNK 65536
+
+static bool S_is_chunk_boundary(const unsigned char *p,
+                                const unsigned char *end) {
+  const unsigned char *q = p;
+  int n = 0;
+
+  if (p < end && *p == '#') {
+    while (q < end && *q == '#' && n < 7) {
+      q++;
+      n++;
+    }
+    return n <= 6 && (q == end || *q == ' ' || *q == '\t' ||
+                      S_is_line_end_char(*q));
+  }
+
+  // '-' is left out: it could also be a setext heading underline
+  if (p < end && (*p == '*' || *p == '_')) {
+    for (; q < end && !S_is_line_end_char(*q); q++) {
+      if (*q == *p)
+        n++;
+      else if (!S_is_space_or_tab(*q))
+        return false;
+    }
+    return n >= 3;
+  }
+
+  return false;
+}
+
+// Returns the start of the first boundary line at or after 'p', or 'end'
+static const unsigned char *S_next_chunk_boundary(const unsigned char *p,
+                                                  const unsigned char *end) {
+  while (p < end) {
+    const unsigned char *eol = (const unsigned char *)memchr(p, '\n', end - p);
+    if (!eol)
+      return end;
+    p = eol + 1;
+    if (S_is_chunk_boundary(p, end))
+      return p;
+  }
+  return end;
+}
+
+static int S_count_lines(const unsigned char *p, const unsigned char *end) {
+  int lines = 0;
+  for (; p < end; p++) {
+    if (*p == '\n' || (*p == '\r' && (p + 1 == end || p[1] != '\n')))
+      lines++;
+  }
+  return lines;
+}
+
+// Can the next line, a heading or thematic break, start a new top-level
+// block given the blocks that are open in 'parser'?
+static bool S_can_split(cmark_parser *parser) {
+  cmark_node *node;
+
+  if (parser->linebuf.size > 0 || parser->last_buffer_ended_with_cr)
+    return false;
+
+  for (node = parser->current; node != parser->root; node = node->parent) {
+    if (node->extension != NULL)
+      return false;
+    switch (S_type(node)) {
+    case CMARK_NODE_CODE_BLOCK:
+      if (node->as.code.fenced)
+        return false;
+      break;
+    case CMARK_NODE_HTML_BLOCK:
+      return false;
+    case CMARK_NODE_HEADING:
+      if (node->as.heading.setext)
+        return false;
+      break;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+static void S_close_blocks(cmark_parser *parser) {
+  while (parser->current != parser->root)
+    parser->current = finalize(parser, parser->current);
+}
+
+// Move the blocks and references collected by 'src' to the end of 'parser'
+static void S_append_blocks(cmark_parser *parser, cmark_parser *src) {
+  cmark_node *root = parser->root, *child = src->root->first_child;
+
+  cmark_map_append(parser->refmap, src->refmap);
+  cmark_node_list_append(parser->mem, &parser->footnote_defs, &src->footnote_defs);
+  if (!child)
+    return;
+
+  for (; child; child = child->next)
+    child->parent = root;
+  if (root->last_child) {
+    root->last_child->next = src->root->first_child;
+    src->root->first_child->prev = root->last_child;
+  } else {
+    root->first_child = src->root->first_child;
+  }
+  root->last_child = src->root->last_child;
+  src->root->first_child = src->root->last_child = NULL;
+}
+
+// Continue in 'parser' where 'src' left off in the middle of the input
+static void S_take_state(cmark_parser *parser, cmark_parser *src) {
+  cmark_strbuf tmp;
+
+  parser->current = src->current == src->root ? parser->root : src->current;
+  parser->line_number = src->line_number;
+  parser->offset = src->offset;
+  parser->column = src->column;
+  parser->first_nonspace = src->first_nonspace;
+  parser->first_nonspace_column = src->first_nonspace_column;
+  parser->indent = src->indent;
+  parser->blank = src->blank;
+  parser->partially_consumed_tab = src->partially_consumed_tab;
+  parser->last_line_length = src->last_line_length;
+  parser->last_buffer_ended_with_cr = src->last_buffer_ended_with_cr;
+
+  tmp = parser->linebuf;
+  parser->linebuf = src->linebuf;
+  src->linebuf = tmp;
+}
+
+static bool S_parser_feed_parallel(cmark_parser *parser,
+                                   const unsigned char *buffer, size_t len) {
+  const unsigned char *end = buffer + len;
+  const unsigned char **starts;
+  cmark_parser **parsers, *cur;
+  cmark_llist *ext;
+  int *lines;
+  int n = 0, max_chunks, i;
+
+  // Only a fresh parser can be split, and every parser shares the allocator
+  if (parser->num_threads < 2 || len < 2 * PARALLEL_MIN_CHUNK ||
+      parser->line_number > 0 || parser->linebuf.size > 0 || parser->events ||
+      parser->max_blocks || parser->has_limits ||
+      parser->mem == cmark_get_arena_mem_allocator())
+    return false;
+
+  max_chunks = 4 * parser->num_threads;
+  if ((size_t)max_chunks > len / PARALLEL_MIN_CHUNK)
+    max_chunks = (int)(len / PARALLEL_MIN_CHUNK);
+
+  starts = (const unsigned char **)parser->mem->calloc(max_chunks + 1, sizeof(*starts));
+  starts[n++] = buffer;
+  for (i = 1; i < max_chunks; i++) {
+    const unsigned char *target = buffer + len / max_chunks * i;
+    if (target <= starts[n - 1])
+      continue;
+    const unsigned char *p = S_next_chunk_boundary(target - 1, end);
+    if (p == end)
+      break;
+    if (p > starts[n - 1])
+      starts[n++] = p;
+  }
+  starts[n] = end;
+
+  if (n < 2) {
+    parser->mem->free(starts);
+    return false;
+  }
+
+  lines = (int *)parser->mem->calloc(n, sizeof(int));
+  parsers = (cmark_parser **)parser->mem->calloc(n, sizeof(cmark_parser *));
+  parsers[0] = parser;
+  for (i = 1; i < n; i++) {
+    parsers[i] = cmark_parser_new_with_mem(parser->options, parser->mem);
+    for (ext = parser->syntax_extensions; ext; ext = ext->next)
+      cmark_parser_attach_syntax_extension(parsers[i], (cmark_syntax_extension *)ext->data);
+    parsers[i]->backslash_ispunct = parser->backslash_ispunct;
+  }
+
+#pragma omp parallel for schedule(static) num_threads(parser->num_threads)
+  for (i = 0; i < n - 1; i++)
+    lines[i + 1] = S_count_lines(starts[i], starts[i + 1]);
+
+  for (i = 1; i < n; i++) {
+    lines[i] += lines[i - 1];
+    parsers[i]->line_number = lines[i];
+  }
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(parser->num_threads)
+  for (i = 0; i < n; i++)
+    S_parser_feed(parsers[i], starts[i], starts[i + 1] - starts[i], false);
+
+  // Validate the seams in document order, falling back to sequential parsing
+  cur = parser;
+  for (i = 1; i < n; i++) {
+    if (S_can_split(cur)) {
+      S_close_blocks(cur);
+      if (cur != parser) {
+        S_append_blocks(parser, cur);
+        cmark_parser_free(cur);
+      }
+      cur = parsers[i];
+    } else {
+      cmark_parser_free(parsers[i]);
+      S_parser_feed(cur, starts[i], starts[i + 1] - starts[i], false);
+    }
+  }
+
+  if (cur != parser) {
+    S_append_blocks(parser, cur);
+    S_take_state(parser, cur);
+    cmark_parser_free(cur);
+  }
+
+  parser->mem->free(parsers);
+  parser->mem->free(lines);
+  parser->mem->free(starts);
+  return true;
+}
+#endif
+
 static void chop_trailing_hashtags(cmark_chunk *ch) {
   bufsize_t n, orig_n;
 
@@ -949,9 +1954,11 @@ static bool parse_extension_block(cmark_parser *parser,
   bool res = false;
 
   if (container->extension->last_block_matches) {
+    CMARK_EXT_TIMER_START(timer);
     if (container->extension->last_block_matches(
         container->extension, parser, input->data, input->len, container))
       res = true;
+    CMARK_EXT_TIMER_STOP(timer, container->extension, CMARK_EXT_LAST_BLOCK_MATCHES);
   }
 
   return res;
@@ -1031,9 +2038,48 @@ done:
   return container;
 }
 
+// Scans for a thematic break like scan_thematic_break(). Without one, the
+// position where the scan failed is recorded: a scan from an earlier
+// offset could only see the same character and spaces up to there, so
+// nested list markers such as "- - - - a" are not scanned to the end of
+// the line again at every level.
+static bufsize_t S_scan_thematic_break(cmark_parser *parser, cmark_chunk *input,
+                                       bufsize_t offset) {
+  bufsize_t i = offset;
+  unsigned char c = peek_at(input, i), nextc = 0;
+  int n = 1;
+
+  if (c != '*' && c != '_' && c != '-') {
+    parser->thematic_break_kill_pos = i;
+    return 0;
+  }
+  while (++i < input->len) {
+    nextc = peek_at(input, i);
+    if (nextc == c)
+      n++;
+    else if (nextc != ' ' && nextc != '\t')
+      break;
+  }
+  if (n >= 3 && (nextc == '\n' || nextc == '\r'))
+    return i - offset + 1;
+  parser->thematic_break_kill_pos = i;
+  return 0;
+}
+
+// Nesting of the containers down to 'node', where a list and its items count
+// once, up to 'max'
+static int S_depth(cmark_node *node, int max) {
+  int depth = 0;
+
+  for (; node->parent && depth < max; node = node->parent)
+    if (S_type(node) != CMARK_NODE_LIST && !accepts_lines(S_type(node)))
+      depth++;
+  return depth;
+}
+
 static void open_new_blocks(cmark_parser *parser, cmark_node **container,
                             cmark_chunk *input, bool all_matched) {
-  bool indented;
+  bool indented, deep;
   cmark_list *data = NULL;
   bool maybe_lazy = S_type(parser->current) == CMARK_NODE_PARAGRAPH;
   cmark_node_type cont_type = S_type(*container);
@@ -1048,8 +2094,11 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
 
     S_find_first_nonspace(parser, input);
     indented = parser->indent >= CODE_INDENT;
+    // past max_depth, the markers of containers are paragraph text
+    deep = parser->limits.max_depth &&
+           S_depth(*container, parser->limits.max_depth) >= parser->limits.max_depth;
 
-    if (!indented && peek_at(input, parser->first_nonspace) == '>') {
+    if (!indented && !deep && peek_at(input, parser->first_nonspace) == '>') {
 
       bufsize_t blockquote_startpos = parser->first_nonspace;
 
@@ -1118,12 +2167,13 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       S_advance_offset(parser, input, input->len - 1 - parser->offset, false);
     } else if (!indented &&
                !(cont_type == CMARK_NODE_PARAGRAPH && !all_matched) &&
-               (matched = scan_thematic_break(input, parser->first_nonspace))) {
+               parser->thematic_break_kill_pos <= parser->first_nonspace &&
+               (matched = S_scan_thematic_break(parser, input, parser->first_nonspace))) {
       // it's only now that we know the line is not part of a setext heading:
       *container = add_child(parser, *container, CMARK_NODE_THEMATIC_BREAK,
                              parser->first_nonspace + 1);
       S_advance_offset(parser, input, input->len - 1 - parser->offset, false);
-    } else if (!indented &&
+    } else if (!indented && !deep &&
                parser->options & CMARK_OPT_FOOTNOTES &&
                (matched = scan_footnote_definition(input, parser->first_nonspace))) {
       cmark_chunk c = cmark_chunk_dup(input, parser->first_nonspace + 2, matched - 2);
@@ -1138,7 +2188,7 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
       (*container)->as.literal = c;
 
       (*container)->internal_offset = matched;
-    } else if ((!indented || cont_type == CMARK_NODE_LIST) &&
+    } else if ((!indented || cont_type == CMARK_NODE_LIST) && !deep &&
 	       parser->indent < 4 &&
                (matched = parse_list_marker(
                     parser->mem, input, parser->first_nonspace,
@@ -1213,8 +2263,10 @@ static void open_new_blocks(cmark_parser *parser, cmark_node **container,
         cmark_syntax_extension *ext = (cmark_syntax_extension *) tmp->data;
 
         if (ext->try_opening_block) {
+          CMARK_EXT_TIMER_START(timer);
           new_container = ext->try_opening_block(
               ext, indented, parser, *container, input->data, input->len);
+          CMARK_EXT_TIMER_STOP(timer, ext, CMARK_EXT_TRY_OPENING_BLOCK);
 
           if (new_container) {
             *container = new_container;
@@ -1380,6 +2432,7 @@ static void S_process_line(cmark_parser *parser, const unsigned char *buffer,
   parser->indent = 0;
   parser->blank = false;
   parser->partially_consumed_tab = false;
+  parser->thematic_break_kill_pos = 0;
 
   input.data = parser->curline.ptr;
   input.len = parser->curline.size;
@@ -1418,6 +2471,13 @@ finished:
     parser->last_line_length -= 1;
 
   cmark_strbuf_clear(&parser->curline);
+
+  if (parser->max_blocks && !parser->events)
+    S_count_closed_blocks(parser);
+  if (parser->has_limits)
+    cmark_parser_limit_reached(parser, (parser->line_number & 63) == 0);
+  if (parser->events)
+    S_emit_closed_blocks(parser);
 }
 
 cmark_node *cmark_parser_finish(cmark_parser *parser) {
@@ -1428,28 +2488,50 @@ cmark_node *cmark_parser_finish(cmark_parser *parser) {
   if (parser->root == NULL)
     return NULL;
 
-  if (parser->linebuf.size) {
+  if (parser->events)
+    S_end_prepass(parser);
+
+  if (parser->linebuf.size && !parser->stopped) {
+    CMARK_TIMER_START(blocks_timer);
     S_process_line(parser, parser->linebuf.ptr, parser->linebuf.size);
     cmark_strbuf_clear(&parser->linebuf);
+    CMARK_TIMER_STOP(blocks_timer, CMARK_PHASE_BLOCKS, NULL);
   }
 
   finalize_document(parser);
 
-  cmark_consolidate_text_nodes(parser->root);
-
   cmark_strbuf_free(&parser->curline);
   cmark_strbuf_free(&parser->linebuf);
 
+  // Postprocessing of the pending leaves happens when they are parsed, and
+  // in event mode the blocks were postprocessed one by one
+  if (parser->events || S_lazy_inlines(parser)) {
+    if (!parser->events)
+      attach_pending_inlines(parser);
+    res = parser->root;
+    parser->root = NULL;
+    cmark_parser_reset(parser);
+    return res;
+  }
+
 #if CMARK_DEBUG_NODES
   if (cmark_node_check(parser->root, stderr)) {
     abort();
   }
 #endif
 
+  // one walk for all the extensions which visit nodes, then the ones which
+  // process the whole document on their own
+  S_postprocess_nodes(parser, parser->root);
+
   for (extensions = parser->syntax_extensions; extensions; extensions = extensions->next) {
     cmark_syntax_extension *ext = (cmark_syntax_extension *) extensions->data;
     if (ext->postprocess_func) {
+      CMARK_TIMER_START(timer);
+      CMARK_EXT_TIMER_START(ext_timer);
       cmark_node *processed = ext->postprocess_func(ext, parser, parser->root);
+      CMARK_EXT_TIMER_STOP(ext_timer, ext, CMARK_EXT_POSTPROCESS);
+      CMARK_TIMER_STOP(timer, CMARK_PHASE_POSTPROCESS, ext->name);
       if (processed)
         parser->root = processed;
     }
@@ -10,6 +10,7 @@
 #include "config.h"
 #include "cmark_ctype.h"
 #include "buffer.h"
+#include "mem_stats.h"
 #include "memory.h"
 
 /* Used as default value for cmark_strbuf->ptr so that people can always
@@ -55,8 +56,9 @@ void cmark_strbuf_grow(cmark_strbuf *buf, bufsize_t target_size) {
   new_size += 1;
   new_size = (new_size + 7) & ~7;
 
-  buf->ptr = (unsigned char *)buf->mem->realloc(buf->asize ? buf->ptr : NULL,
-                                                new_size);
+  buf->ptr = (unsigned char *)cmark_mem_realloc_at(buf->mem, CMARK_MEM_SITE_STRBUF,
+                                                 buf->asize ? buf->ptr : NULL,
+                                                 new_size);
   buf->asize = new_size;
 }
 
@@ -151,7 +153,7 @@ unsigned char *cmark_strbuf_detach(cmark_strbuf *buf) {
 
   if (buf->asize == 0) {
     /* return an empty string */
-    return (unsigned char *)buf->mem->calloc(1, 1);
+    return (unsigned char *)cmark_mem_calloc_at(buf->mem, CMARK_MEM_SITE_STRBUF, 1, 1);
   }
 
   cmark_strbuf_init(buf->mem, buf, 0);
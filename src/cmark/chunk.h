@@ -7,6 +7,7 @@
 #include "cmark-gfm.h"
 #include "buffer.h"
 #include "memory.h"
+#include "mem_stats.h"
 #include "cmark_ctype.h"
 
 #define CMARK_CHUNK_EMPTY                                                      \
@@ -66,7 +67,7 @@ static CMARK_INLINE const char *cmark_chunk_to_cstr(cmark_mem *mem,
   if (c->alloc) {
     return (char *)c->data;
   }
-  str = (unsigned char *)mem->calloc(c->len + 1, 1);
+  str = (unsigned char *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_CHUNK, c->len + 1, 1);
   if (c->len > 0) {
     memcpy(str, c->data, c->len);
   }
@@ -86,7 +87,7 @@ static CMARK_INLINE void cmark_chunk_set_cstr(cmark_mem *mem, cmark_chunk *c,
     c->alloc = 0;
   } else {
     c->len = (bufsize_t)strlen(str);
-    c->data = (unsigned char *)mem->calloc(c->len + 1, 1);
+    c->data = (unsigned char *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_CHUNK, c->len + 1, 1);
     c->alloc = 1;
     memcpy(c->data, str, c->len + 1);
   }
@@ -240,6 +240,9 @@ typedef int (*cmark_commonmark_escape_func) (cmark_syntax_extension *extension,
 typedef const char* (*cmark_xml_attr_func) (cmark_syntax_extension *extension,
                                             cmark_node *node);
 
+typedef const char* (*cmark_json_attr_func) (cmark_syntax_extension *extension,
+                                             cmark_node *node);
+
 typedef void (*cmark_html_render_func) (cmark_syntax_extension *extension,
                                         struct cmark_html_renderer *renderer,
                                         cmark_node *node,
@@ -254,6 +257,21 @@ typedef cmark_node *(*cmark_postprocess_func) (cmark_syntax_extension *extension
                                                cmark_parser *parser,
                                                cmark_node *root);
 
+typedef int (*cmark_postprocess_node_func) (cmark_syntax_extension *extension,
+                                            cmark_parser *parser,
+                                            cmark_node *node);
+
+typedef size_t (*cmark_serialize_func) (cmark_syntax_extension *extension,
+                                        cmark_node *node,
+                                        unsigned char *buf,
+                                        size_t size);
+
+typedef int (*cmark_deserialize_func) (cmark_syntax_extension *extension,
+                                       cmark_mem *mem,
+                                       cmark_node *node,
+                                       const unsigned char *data,
+                                       size_t len);
+
 typedef int (*cmark_ispunct_func) (char c);
 
 typedef void (*cmark_opaque_alloc_func) (cmark_syntax_extension *extension,
@@ -354,6 +372,14 @@ CMARK_GFM_EXPORT
 void cmark_syntax_extension_set_xml_attr_func(cmark_syntax_extension *extension,
                                               cmark_xml_attr_func func);
 
+/** Like the xml attr function, for 'cmark_render_json': returns members
+ * to add to the object of the node, each preceded by a comma, such as
+ * ',"align":"left"', or NULL.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_json_attr_func(cmark_syntax_extension *extension,
+                                               cmark_json_attr_func func);
+
   /** See the documentation for 'cmark_syntax_extension'
  */
 CMARK_GFM_EXPORT
@@ -396,6 +422,51 @@ CMARK_GFM_EXPORT
 void cmark_syntax_extension_set_postprocess_func(cmark_syntax_extension *extension,
                                                  cmark_postprocess_func func);
 
+/** Visitor-style alternative to a postprocess function. After parsing,
+ * the document is walked once for all extensions, and 'func' is called for
+ * every node of a type added with
+ * 'cmark_syntax_extension_add_postprocess_type', in document order.
+ * Adjacent text nodes are merged before they are visited.
+ *
+ * 'func' may change the node and insert new nodes after it, which are not
+ * visited; it must not free or move any other node. It returns 0 to skip
+ * the descendants of the node for this extension, and 1 otherwise.
+ *
+ * The walk runs before the postprocess functions of all extensions.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_postprocess_node_func(cmark_syntax_extension *extension,
+                                                      cmark_postprocess_node_func func);
+
+/** See 'cmark_syntax_extension_set_postprocess_node_func'
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_add_postprocess_type(cmark_syntax_extension *extension,
+                                                 cmark_node_type type);
+
+/** Called by 'cmark_ast_save' for every node of the extension, to write
+ * the data the extension keeps for the node. Like snprintf, 'func' writes
+ * at most 'size' bytes to 'buf' and returns the number of bytes the data
+ * takes; if that is more than 'size', it is called again with a buffer
+ * that is large enough.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_serialize_func(cmark_syntax_extension *extension,
+                                               cmark_serialize_func func);
+
+/** Called by 'cmark_ast_load' for every node of the extension, with the
+ * 'len' bytes written by the serialize function, to restore the data of
+ * the node. The node is already appended to its parent, if it has one, and
+ * to the siblings before it, so 'func' can check where the node may be.
+ * Nodes are loaded without calling the opaque alloc function,
+ * so 'func' allocates what the opaque free function will free, also when
+ * the data is invalid. It returns 1 on success and 0 if the data is
+ * invalid, in which case the document fails to load.
+ */
+CMARK_GFM_EXPORT
+void cmark_syntax_extension_set_deserialize_func(cmark_syntax_extension *extension,
+                                                 cmark_deserialize_func func);
+
 #ifdef REGISTRY_CHECKS
 /** See the documentation for 'cmark_syntax_extension'
  */
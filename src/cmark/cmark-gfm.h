@@ -125,6 +125,165 @@ cmark_mem *cmark_get_arena_mem_allocator();
 CMARK_GFM_EXPORT
 void cmark_arena_reset(void);
 
+/** Categories of allocation sites tracked by the counting allocator.
+ */
+typedef enum {
+  CMARK_MEM_SITE_OTHER,
+  CMARK_MEM_SITE_NODE,
+  CMARK_MEM_SITE_STRBUF,
+  CMARK_MEM_SITE_CHUNK,
+  CMARK_MEM_SITE_DELIMITER,
+  CMARK_MEM_SITE_EXTENSION,
+  CMARK_MEM_SITE_COUNT
+} cmark_mem_site;
+
+/** Allocation statistics of the counting allocator. 'calls' counts the
+ * calloc and realloc calls per site, 'bytes' the bytes they requested.
+ */
+typedef struct cmark_mem_stats {
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t frees;
+  size_t calls[CMARK_MEM_SITE_COUNT];
+  size_t bytes[CMARK_MEM_SITE_COUNT];
+} cmark_mem_stats;
+
+/** A counting allocator which passes all requests on to 'base' and keeps
+ * track of live and peak bytes and the number of calls per allocation
+ * site. There is a single, global instance: the counters are shared, so
+ * only one document should be measured at a time, and every call replaces
+ * 'base' for all blocks, so 'base' may only change while none are
+ * allocated. Threads rendering the same document may share it. 'base'
+ * should not be the arena allocator, which never frees.
+ */
+CMARK_GFM_EXPORT
+cmark_mem *cmark_get_counting_mem_allocator(cmark_mem *base);
+
+/** Resets the counters of the counting allocator.
+ */
+CMARK_GFM_EXPORT
+void cmark_mem_stats_reset(void);
+
+/** Copies the counters of the counting allocator into 'stats'.
+ */
+CMARK_GFM_EXPORT
+void cmark_mem_stats_get(cmark_mem_stats *stats);
+
+/** Returns the name of an allocation site, e.g. "node".
+ */
+CMARK_GFM_EXPORT
+const char *cmark_mem_site_name(cmark_mem_site site);
+
+/**
+ * ## Phase timings
+ */
+
+/** Phases of parsing and rendering measured by the phase timers.
+ */
+typedef enum {
+  CMARK_PHASE_BLOCKS,
+  CMARK_PHASE_FINALIZE,
+  CMARK_PHASE_INLINES,
+  CMARK_PHASE_FOOTNOTES,
+  CMARK_PHASE_CONSOLIDATE,
+  CMARK_PHASE_POSTPROCESS,
+  CMARK_PHASE_RENDER,
+  CMARK_PHASE_COUNT
+} cmark_phase;
+
+/** Time spent in a phase. 'name' is the name of the extension for
+ * CMARK_PHASE_POSTPROCESS and NULL otherwise.
+ */
+typedef struct cmark_timing {
+  cmark_phase phase;
+  const char *name;
+  uint64_t ns;
+  uint64_t count;
+} cmark_timing;
+
+/** Extension callbacks measured by the extension timers.
+ */
+typedef enum {
+  CMARK_EXT_TRY_OPENING_BLOCK,
+  CMARK_EXT_LAST_BLOCK_MATCHES,
+  CMARK_EXT_MATCH_INLINE,
+  CMARK_EXT_INSERT_INLINE_FROM_DELIM,
+  CMARK_EXT_POSTPROCESS,
+  CMARK_EXT_CONTAINS_INLINES,
+  CMARK_EXT_CAN_CONTAIN,
+  CMARK_EXT_GET_TYPE_STRING,
+  CMARK_EXT_OPAQUE_ALLOC,
+  CMARK_EXT_OPAQUE_FREE,
+  CMARK_EXT_HTML_RENDER,
+  CMARK_EXT_HTML_FILTER,
+  CMARK_EXT_XML_ATTR,
+  CMARK_EXT_JSON_ATTR,
+  CMARK_EXT_COMMONMARK_RENDER,
+  CMARK_EXT_COMMONMARK_ESCAPE,
+  CMARK_EXT_LATEX_RENDER,
+  CMARK_EXT_MAN_RENDER,
+  CMARK_EXT_PLAINTEXT_RENDER,
+  CMARK_EXT_CALLBACK_COUNT
+} cmark_ext_callback;
+
+/** Time spent in the calls of one callback of an extension.
+ */
+typedef struct cmark_ext_timing {
+  const char *name;
+  cmark_ext_callback callback;
+  uint64_t ns;
+  uint64_t count;
+} cmark_ext_timing;
+
+/** Flags for cmark_timings_enable(): record the phase timers, and time
+ * every call of an extension callback. The latter adds a clock read per
+ * call, and is meant for profiling only.
+ */
+#define CMARK_TIMINGS_PHASES (1 << 0)
+#define CMARK_TIMINGS_EXTENSIONS (1 << 1)
+
+/** Returns 1 if the library was compiled with CMARK_TIMINGS, which is
+ * required for the phase and extension timers.
+ */
+CMARK_GFM_EXPORT
+int cmark_timings_available(void);
+
+/** Starts recording the timers given by 'flags', a combination of
+ * CMARK_TIMINGS_PHASES and CMARK_TIMINGS_EXTENSIONS, or stops recording
+ * with 0. The timings are global, so only one document should be
+ * measured at a time. Phases do not nest: time spent in a phase is only
+ * counted once, towards the outermost phase.
+ */
+CMARK_GFM_EXPORT
+void cmark_timings_enable(int flags);
+
+/** Clears the recorded phase and extension timings.
+ */
+CMARK_GFM_EXPORT
+void cmark_timings_reset(void);
+
+/** Points 'timings' to the recorded timings, in the order in which they
+ * were first seen, and returns their number.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_timings_get(const cmark_timing **timings);
+
+/** Points 'timings' to the recorded extension timings, in the order in
+ * which they were first seen, and returns their number.
+ */
+CMARK_GFM_EXPORT
+size_t cmark_ext_timings_get(const cmark_ext_timing **timings);
+
+/** Returns the name of a phase, e.g. "inlines".
+ */
+CMARK_GFM_EXPORT
+const char *cmark_phase_name(cmark_phase phase);
+
+/** Returns the name of an extension callback, e.g. "match_inline".
+ */
+CMARK_GFM_EXPORT
+const char *cmark_ext_callback_name(cmark_ext_callback callback);
+
 /** Callback for freeing user data with a 'cmark_mem' context.
  */
 typedef void (*cmark_free_func) (cmark_mem *mem, void *user_data);
@@ -568,6 +727,72 @@ cmark_parser *cmark_parser_new_with_mem(int options, cmark_mem *mem);
 CMARK_GFM_EXPORT
 void cmark_parser_free(cmark_parser *parser);
 
+/** Allow 'parser' to use up to 'num_threads' threads. The inline content
+ * of paragraphs, headings and other leaf blocks is then parsed
+ * concurrently once the block structure is complete. In addition, a large
+ * buffer passed to the first call of 'cmark_parser_feed' is split into
+ * top-level sections which are block parsed concurrently. The default (1)
+ * parses sequentially. This only has an effect if the library was built
+ * with OpenMP, and is ignored for parsers using the arena allocator, which
+ * is not thread-safe. Custom allocators must be thread-safe.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_set_num_threads(cmark_parser *parser, int num_threads);
+
+/** Stops parsing once 'max_blocks' top-level blocks are closed, e.g. to
+ * render an excerpt: later input is ignored, and the blocks which were
+ * started after those are dropped. Footnote definitions do not count.
+ * Links and footnotes are only resolved against definitions that precede
+ * the end of the excerpt. 0 (the default) parses everything. This has no
+ * effect in event mode, see 'cmark_parser_set_event_func'.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_set_max_blocks(cmark_parser *parser, int max_blocks);
+
+/** Limits on the work done for a document, for untrusted input. A limit
+ * of 0 does not apply.
+ */
+typedef struct cmark_limits {
+  /** Nesting of block quotes, lists, list items and footnote definitions.
+   * Deeper markers are kept as paragraph text. */
+  int max_depth;
+  /** Block nodes plus inline tokens. Parsing stops once there are more. */
+  size_t max_nodes;
+  /** Cells of a table. A header row that is wider is kept as paragraph
+   * text, and a table ends at the first row that would exceed it. */
+  size_t max_table_cells;
+  /** Bytes of link destinations and titles copied from reference
+   * definitions, the only way output can grow faster than the input.
+   * Reference links beyond it are kept as text. */
+  size_t max_output;
+  /** Seconds spent parsing, checked every 64 lines and every 256 inline
+   * tokens. Parsing stops once they have elapsed. */
+  double max_seconds;
+} cmark_limits;
+
+/** The limit which stopped a parser, see 'cmark_parser_limit_exceeded'.
+ */
+typedef enum {
+  CMARK_LIMIT_NONE,
+  CMARK_LIMIT_NODES,
+  CMARK_LIMIT_TIME
+} cmark_limit;
+
+/** Applies 'limits' to every document parsed by 'parser', or none if
+ * 'limits' is NULL. A limit on nodes or time stops parsing: later input is
+ * ignored and the inline content of the blocks so far is kept as text
+ * from where it was reached. Limits disable concurrent parsing and
+ * CMARK_OPT_LAZY_INLINES.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_set_limits(cmark_parser *parser, const cmark_limits *limits);
+
+/** Returns the limit which stopped the last document, after
+ * 'cmark_parser_finish', or CMARK_LIMIT_NONE if it was parsed completely.
+ */
+CMARK_GFM_EXPORT
+cmark_limit cmark_parser_limit_exceeded(cmark_parser *parser);
+
 /** Feeds a string of length 'len' to 'parser'.
  */
 CMARK_GFM_EXPORT
@@ -578,6 +803,37 @@ void cmark_parser_feed(cmark_parser *parser, const char *buffer, size_t len);
 CMARK_GFM_EXPORT
 cmark_node *cmark_parser_finish(cmark_parser *parser);
 
+/** Called for every node of a document parsed in event mode, see
+ * 'cmark_parser_set_event_func'.
+ */
+typedef void (*cmark_event_func)(cmark_event_type ev_type, cmark_node *node,
+                                 void *data);
+
+/** Switch a new 'parser' to event mode: instead of building the document,
+ * every top-level block is passed to 'func' as soon as it is closed, in
+ * the order of a 'cmark_iter' over it, with its inlines parsed and the
+ * extensions' postprocessing done. The block is freed when 'func' returns
+ * from its `EXIT` event, so memory is bounded by the largest top-level
+ * block, the link reference definitions and the footnote definitions,
+ * which are passed last as in the document tree. The document node is
+ * entered before the first block and left at 'cmark_parser_finish', which
+ * returns it empty. Without 'cmark_parser_feed_references', links and
+ * footnotes are only resolved against definitions that precede them.
+ * Event mode ends with 'cmark_parser_finish'.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_set_event_func(cmark_parser *parser, cmark_event_func func,
+                                 void *data);
+
+/** Feeds the input to a first pass of a parser in event mode, which only
+ * collects link reference definitions and footnote labels. The whole
+ * document has to be fed this way before it is fed again with
+ * 'cmark_parser_feed'.
+ */
+CMARK_GFM_EXPORT
+void cmark_parser_feed_references(cmark_parser *parser, const char *buffer,
+                                  size_t len);
+
 /** Parse a CommonMark document in 'buffer' of length 'len'.
  * Returns a pointer to a tree of nodes.  The memory allocated for
  * the node tree should be released using 'cmark_node_free'
@@ -609,6 +865,21 @@ char *cmark_render_xml(cmark_node *root, int options);
 CMARK_GFM_EXPORT
 char *cmark_render_xml_with_mem(cmark_node *root, int options, cmark_mem *mem);
 
+/** Render a 'node' tree as JSON: every node is an object with its type
+ * in "t" and its children in "c", and the source position in "pos" with
+ * CMARK_OPT_SOURCEPOS. The other members are named like the columns of
+ * md_ast() in the R package. It is the caller's responsibility to free
+ * the returned buffer.
+ */
+CMARK_GFM_EXPORT
+char *cmark_render_json(cmark_node *root, int options);
+
+/** As for 'cmark_render_json', but specifying the allocator to use for
+ * the resulting string.
+ */
+CMARK_GFM_EXPORT
+char *cmark_render_json_with_mem(cmark_node *root, int options, cmark_mem *mem);
+
 /** Render a 'node' tree as an HTML fragment.  It is up to the user
  * to add an appropriate header and footer. It is the caller's
  * responsibility to free the returned buffer.
@@ -622,6 +893,16 @@ char *cmark_render_html(cmark_node *root, int options, cmark_llist *extensions);
 CMARK_GFM_EXPORT
 char *cmark_render_html_with_mem(cmark_node *root, int options, cmark_llist *extensions, cmark_mem *mem);
 
+/** As for 'cmark_render_html_with_mem', but rendering ranges of top-level
+ * blocks of a document concurrently on up to 'num_threads' threads. The
+ * output is identical to the serial renderer. Falls back to serial
+ * rendering without OpenMP, for small documents, and for the arena
+ * allocator, which is not thread-safe.
+ */
+CMARK_GFM_EXPORT
+char *cmark_render_html_threaded(cmark_node *root, int options, cmark_llist *extensions,
+                                 cmark_mem *mem, int num_threads);
+
 /** Render a 'node' tree as a groff man page, without the header.
  * It is the caller's responsibility to free the returned buffer.
  */
@@ -658,6 +939,49 @@ char *cmark_render_plaintext(cmark_node *root, int options, int width);
 CMARK_GFM_EXPORT
 char *cmark_render_plaintext_with_mem(cmark_node *root, int options, int width, cmark_mem *mem);
 
+/** Extract the text content of a 'node' tree, e.g. for a search index.
+ * Literals, including those of extension inlines such as math, are
+ * copied into the output as they are, without wrapping or list markers. Blocks are separated by a blank line, line breaks and
+ * soft breaks by a newline, and table cells by a space. Html and
+ * footnote references are left out. With 'normalize_space', every run
+ * of whitespace becomes a single space, and blocks are separated by a
+ * single newline. If 'max_len' is not 0, the text is truncated to at
+ * most 'max_len' bytes, at a UTF-8 character boundary. The result is
+ * allocated with 'mem', and has no trailing newline.
+ */
+CMARK_GFM_EXPORT
+char *cmark_extract_text(cmark_node *root, int normalize_space, size_t max_len,
+                         cmark_mem *mem);
+
+/** Cuts the text of a 'node' tree after 'max_chars' characters, e.g. for
+ * an excerpt, and frees everything that follows in document order. Text,
+ * code spans and code blocks count, at UTF-8 character boundaries. The
+ * nodes which contain the end of the text are kept, so the tree renders
+ * with all its elements closed.
+ */
+CMARK_GFM_EXPORT
+void cmark_node_truncate(cmark_node *root, size_t max_chars);
+
+/** Save a 'node' tree in a compact binary form, e.g. to cache a parsed
+ * document on disk. Positions, the data of every node and the data
+ * extensions keep for their nodes are saved, so rendering the tree loaded
+ * with 'cmark_ast_load' gives the same output as rendering 'root'. Pending
+ * inlines are parsed first. Returns a buffer of '*len' bytes allocated
+ * with 'mem', or NULL if the tree uses extensions that cannot be saved.
+ */
+CMARK_GFM_EXPORT
+unsigned char *cmark_ast_save(cmark_node *root, size_t *len, cmark_mem *mem);
+
+/** Load a tree saved with 'cmark_ast_save', allocated with 'mem'. The
+ * extensions of the tree must be registered, and are found by name.
+ * Returns NULL if the data is truncated, corrupt, of another format
+ * version, or uses an extension that is not available. The data is
+ * checked for consistency, but not for every invariant of a parsed tree,
+ * so only load data written by 'cmark_ast_save'.
+ */
+CMARK_GFM_EXPORT
+cmark_node *cmark_ast_load(const unsigned char *data, size_t len, cmark_mem *mem);
+
 /** Render a 'node' tree as a LaTeX document.
  * It is the caller's responsibility to free the returned buffer.
  */
@@ -746,6 +1070,16 @@ char *cmark_render_latex_with_mem(cmark_node *root, int options, int width, cmar
  */
 #define CMARK_OPT_UNSAFE (1 << 17)
 
+/** Defer the inline parsing of paragraphs, headings and other leaf blocks
+ * until something descends into them: `cmark_node_first_child`,
+ * `cmark_node_last_child`, an iterator or a renderer. Blocks and link
+ * reference definitions are still parsed by `cmark_parser_finish`, so
+ * consumers of the block structure alone skip the inline parser. Nodes
+ * moved out of the document are parsed first. Has no effect together
+ * with CMARK_OPT_FOOTNOTES, which needs all inlines to number the notes.
+ */
+#define CMARK_OPT_LAZY_INLINES (1 << 18)
+
 /**
  * ## Version information
  */
@@ -12,6 +12,7 @@
 #include "scanners.h"
 #include "render.h"
 #include "syntax_extension.h"
+#include "timings.h"
 
 #define OUT(s, wrap, escaping) renderer->out(renderer, node, s, wrap, escaping)
 #define LIT(s) renderer->out(renderer, node, s, false, LITERAL)
@@ -194,7 +195,9 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
   }
 
   if (node->extension && node->extension->commonmark_render_func) {
+    CMARK_EXT_TIMER_START(timer);
     node->extension->commonmark_render_func(node->extension, renderer, node, ev_type, options);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_COMMONMARK_RENDER);
     return 1;
   }
 
@@ -0,0 +1,207 @@
+// Pathological-input complexity suite: every case builds an input from a
+// pattern repeated n times, parses and renders it at doubling sizes, and
+// fits the growth of the time in n. A case fails if the exponent is above
+// the threshold, i.e. it is clearly worse than linear. Run it with
+// make -f Makefile.jg check-complexity; wall-clock timings are too noisy for
+// the package tests.
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "cmark-gfm.h"
+#include "cmark-gfm-extension_api.h"
+#include "timings.h"
+
+#include "../extensions/cmark-gfm-core-extensions.h"
+
+// The input is head, then a line of body n times, tail n times and end,
+// repeated 'lines' times, or n times if that is 0. n starts at 'size'.
+typedef struct {
+  const char *name;
+  const char *extension;
+  const char *head;
+  const char *body;
+  const char *tail;
+  const char *end;
+  int lines;
+  int size;
+} complexity_case;
+
+static const complexity_case cases[] = {
+  {"math spans", "math", "", "$a$ ", "", "\n", 1, 5000},
+  {"superscript runs", "superscript", "a", "^", "", "\n", 1, 20000},
+  {"subscript runs", "subscript", "a", "~", "", "\n", 1, 20000},
+  {"autolink at signs", "autolink", "", "a@", "", "\n", 1, 5000},
+  {"autolink emails", "autolink", "", "a@b.co ", "", "\n", 1, 2000},
+  {"nested brackets", NULL, "", "[", "]", "a\n", 1, 10000},
+  {"unclosed links", NULL, "", "[a](<b", "", "\n", 1, 5000},
+  {"emphasis openers", NULL, "", "*a **", "", "\n", 1, 5000},
+  {"backtick runs", NULL, "", "`a``", "", "\n", 1, 5000},
+  {"nested block quotes", NULL, "", "> ", "", "a\n", 1, 5000},
+  {"nested lists", NULL, "", "- ", "", "a\n", 1, 2000},
+  {"wide table", "table", "", "|---", "", "|\n", 3, 2000},
+  {"long table", "table", "| a | b |\n|---|---|\n", "", "", "| c | d |\n", 0, 5000},
+  {"table header rescans", "table", "a | b\n", "", "", "|-|-|-|\n", 0, 2000},
+  {"reference links", NULL, "[a]: /url\n\n", "[a] ", "", "\n", 1, 5000},
+};
+
+#define NCASES (sizeof(cases) / sizeof(cases[0]))
+#define NSIZES 5
+#define REPEATS 3
+#define MIN_SECONDS 0.02
+
+static char *make_input(const complexity_case *c, size_t n, size_t *len) {
+  size_t head = strlen(c->head), body = strlen(c->body);
+  size_t tail = strlen(c->tail), end = strlen(c->end);
+  size_t lines = c->lines ? (size_t)c->lines : n;
+  size_t line = (body + tail) * n + end;
+  char *buf, *p;
+  size_t i, j;
+
+  *len = head + line * lines;
+  buf = p = (char *)malloc(*len + 1);
+  if (!buf)
+    return NULL;
+  memcpy(p, c->head, head);
+  p += head;
+  for (j = 0; j < lines; j++) {
+    for (i = 0; body && i < n; i++, p += body)
+      memcpy(p, c->body, body);
+    for (i = 0; tail && i < n; i++, p += tail)
+      memcpy(p, c->tail, tail);
+    memcpy(p, c->end, end);
+    p += end;
+  }
+  buf[*len] = 0;
+  return buf;
+}
+
+static void run_case(const complexity_case *c, const char *input, size_t len) {
+  cmark_parser *parser = cmark_parser_new(CMARK_OPT_DEFAULT);
+  cmark_llist *extensions = NULL;
+  cmark_node *doc;
+  char *html;
+
+  if (c->extension) {
+    cmark_syntax_extension *ext = cmark_find_syntax_extension(c->extension);
+    cmark_parser_attach_syntax_extension(parser, ext);
+    extensions = cmark_parser_get_syntax_extensions(parser);
+  }
+  cmark_parser_feed(parser, input, len);
+  doc = cmark_parser_finish(parser);
+  html = cmark_render_html(doc, CMARK_OPT_DEFAULT, extensions);
+  free(html);
+  cmark_node_free(doc);
+  cmark_parser_free(parser);
+}
+
+// Seconds to parse and render the input, the best of REPEATS measurements.
+// Each repeats the case for at least MIN_SECONDS, so that small inputs are
+// not lost in clock and scheduling noise.
+static double time_case(const complexity_case *c, const char *input, size_t len) {
+  double best = -1;
+  int i;
+
+  for (i = 0; i < REPEATS; i++) {
+    uint64_t start = cmark_timer_now();
+    double elapsed;
+    int runs = 0;
+
+    do {
+      run_case(c, input, len);
+      runs++;
+      elapsed = (double)(cmark_timer_now() - start) / 1e9;
+    } while (elapsed < MIN_SECONDS);
+    elapsed /= runs;
+    if (best < 0 || elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+// Least squares slope of log(time) against log(n)
+static double fit_exponent(const double *n, const double *t, int k) {
+  double mx = 0, my = 0, sxy = 0, sxx = 0;
+  int i;
+
+  for (i = 0; i < k; i++) {
+    mx += log(n[i]) / k;
+    my += log(t[i]) / k;
+  }
+  for (i = 0; i < k; i++) {
+    sxy += (log(n[i]) - mx) * (log(t[i]) - my);
+    sxx += (log(n[i]) - mx) * (log(n[i]) - mx);
+  }
+  return sxy / sxx;
+}
+
+static void print_usage(void) {
+  printf("Usage:   complexity [--threshold X] [--scale N] [CASE...]\n");
+  printf("Runs every case, or those whose name contains CASE, at %d doubling\n", NSIZES);
+  printf("sizes, and fails if time grows faster than n^X (default 1.5).\n");
+  printf("--scale N multiplies the sizes by N.\n");
+}
+
+static int selected(const complexity_case *c, int argc, char **argv, int first) {
+  int i;
+
+  if (first == argc)
+    return 1;
+  for (i = first; i < argc; i++)
+    if (strstr(c->name, argv[i]))
+      return 1;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  double threshold = 1.5, scale = 1;
+  int first = 1, failures = 0;
+  size_t i;
+
+  while (first < argc && argv[first][0] == '-') {
+    if (!strcmp(argv[first], "--threshold") && first + 1 < argc) {
+      threshold = atof(argv[first + 1]);
+    } else if (!strcmp(argv[first], "--scale") && first + 1 < argc) {
+      scale = atof(argv[first + 1]);
+    } else {
+      print_usage();
+      return strcmp(argv[first], "--help") ? 1 : 0;
+    }
+    first += 2;
+  }
+  if (threshold <= 0 || scale <= 0) {
+    fprintf(stderr, "--threshold and --scale must be positive\n");
+    return 1;
+  }
+
+  cmark_gfm_core_extensions_ensure_registered();
+  printf("%-24s %10s %12s %9s\n", "case", "max n", "max ms", "exponent");
+  for (i = 0; i < NCASES; i++) {
+    const complexity_case *c = &cases[i];
+    double sizes[NSIZES], times[NSIZES], exponent;
+    int k;
+
+    if (!selected(c, argc, argv, first))
+      continue;
+    for (k = 0; k < NSIZES; k++) {
+      size_t n = (size_t)(c->size * scale) << k, len;
+      char *input = make_input(c, n, &len);
+      if (!input) {
+        fprintf(stderr, "Failed to allocate input for '%s'\n", c->name);
+        return 1;
+      }
+      sizes[k] = (double)n;
+      // clock resolution is far below a microsecond, but avoid log(0)
+      times[k] = time_case(c, input, len) + 1e-9;
+      free(input);
+    }
+    exponent = fit_exponent(sizes, times, NSIZES);
+    printf("%-24s %10.0f %12.2f %9.2f%s\n", c->name, sizes[NSIZES - 1],
+           times[NSIZES - 1] * 1e3, exponent, exponent > threshold ? "  FAIL" : "");
+    if (exponent > threshold)
+      failures++;
+  }
+  if (failures)
+    printf("%d case(s) grow faster than n^%.2f\n", failures, threshold);
+  return failures ? 1 : 0;
+}
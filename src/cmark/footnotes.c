@@ -15,13 +15,13 @@ static void footnote_free(cmark_map *map, cmark_map_entry *_ref) {
   }
 }
 
-void cmark_footnote_create(cmark_map *map, cmark_node *node) {
+cmark_footnote *cmark_footnote_create(cmark_map *map, cmark_node *node) {
   cmark_footnote *ref;
   unsigned char *reflabel = normalize_map_label(map->mem, &node->as.literal);
 
   /* empty footnote name, or composed from only whitespace */
   if (reflabel == NULL)
-    return;
+    return NULL;
 
   assert(map->sorted == NULL);
 
@@ -33,6 +33,7 @@ void cmark_footnote_create(cmark_map *map, cmark_node *node) {
 
   map->refs = (cmark_map_entry *)ref;
   map->size++;
+  return ref;
 }
 
 cmark_map *cmark_footnote_map_new(cmark_mem *mem) {
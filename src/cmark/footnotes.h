@@ -15,7 +15,8 @@ struct cmark_footnote {
 
 typedef struct cmark_footnote cmark_footnote;
 
-void cmark_footnote_create(cmark_map *map, cmark_node *node);
+/* Returns the new footnote, or NULL if the label is empty */
+cmark_footnote *cmark_footnote_create(cmark_map *map, cmark_node *node);
 cmark_map *cmark_footnote_map_new(cmark_mem *mem);
 
 #ifdef __cplusplus
@@ -10,6 +10,8 @@
 #include "syntax_extension.h"
 #include "html.h"
 #include "render.h"
+#include "timings.h"
+#include "parser.h"
 
 // Functions to convert cmark_nodes to HTML strings.
 
@@ -39,10 +41,11 @@ static void filter_html_block(cmark_html_renderer *renderer, uint8_t *data, size
     filtered = false;
     for (it = renderer->filter_extensions; it; it = it->next) {
       ext = ((cmark_syntax_extension *) it->data);
-      if (!ext->html_filter_func(ext, data, len)) {
-        filtered = true;
+      CMARK_EXT_TIMER_START(timer);
+      filtered = !ext->html_filter_func(ext, data, len);
+      CMARK_EXT_TIMER_STOP(timer, ext, CMARK_EXT_HTML_FILTER);
+      if (filtered)
         break;
-      }
     }
 
     if (!filtered) {
@@ -112,7 +115,9 @@ static int S_render_node(cmark_html_renderer *renderer, cmark_node *node,
   }
 
   if (node->extension && node->extension->html_render_func) {
+    CMARK_EXT_TIMER_START(timer);
     node->extension->html_render_func(node->extension, renderer, node, ev_type, options);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_HTML_RENDER);
     return 1;
   }
 
@@ -311,10 +316,11 @@ static int S_render_node(cmark_html_renderer *renderer, cmark_node *node,
       filtered = false;
       for (it = renderer->filter_extensions; it; it = it->next) {
         ext = (cmark_syntax_extension *) it->data;
-        if (!ext->html_filter_func(ext, node->as.literal.data, node->as.literal.len)) {
-          filtered = true;
+        CMARK_EXT_TIMER_START(timer);
+        filtered = !ext->html_filter_func(ext, node->as.literal.data, node->as.literal.len);
+        CMARK_EXT_TIMER_STOP(timer, ext, CMARK_EXT_HTML_FILTER);
+        if (filtered)
           break;
-        }
       }
       if (!filtered) {
         cmark_strbuf_put(html, node->as.literal.data, node->as.literal.len);
@@ -439,6 +445,7 @@ char *cmark_render_html_with_mem(cmark_node *root, int options, cmark_llist *ext
   cmark_node *cur;
   cmark_html_renderer renderer = {&html, NULL, NULL, 0, 0, NULL};
   cmark_iter *iter = cmark_iter_new(root);
+  CMARK_TIMER_START(timer);
 
   for (; extensions; extensions = extensions->next)
     if (((cmark_syntax_extension *) extensions->data)->html_filter_func)
@@ -461,5 +468,139 @@ char *cmark_render_html_with_mem(cmark_node *root, int options, cmark_llist *ext
   cmark_llist_free(mem, renderer.filter_extensions);
 
   cmark_iter_free(iter);
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_RENDER, NULL);
+  return result;
+}
+
+#ifdef _OPENMP
+// Top-level blocks render independently, except for the footnote counter,
+// which is derived from the number of footnote definitions before each
+// range of blocks.
+typedef struct {
+  cmark_node *first;
+  unsigned int footnote_ix;
+  unsigned int footnote_end;
+  cmark_strbuf html;
+} html_range;
+
+static void S_render_blocks(cmark_html_renderer *renderer, cmark_node *first,
+                            cmark_node *end, int options) {
+  cmark_event_type ev_type;
+  cmark_node *node;
+  cmark_iter *iter;
+
+  for (node = first; node != end; node = node->next) {
+    iter = cmark_iter_new(node);
+    while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE)
+      S_render_node(renderer, cmark_iter_get_node(iter), ev_type, options);
+    cmark_iter_free(iter);
+  }
+}
+
+static void S_init_range_renderer(cmark_html_renderer *renderer,
+                                  cmark_strbuf *html, cmark_llist *filters,
+                                  unsigned int footnote_ix) {
+  memset(renderer, 0, sizeof(*renderer));
+  renderer->html = html;
+  renderer->filter_extensions = filters;
+  renderer->footnote_ix = footnote_ix;
+  renderer->written_footnote_ix = footnote_ix;
+}
+
+static char *S_render_html_threaded(cmark_node *root, int options,
+                                    cmark_llist *filters, cmark_mem *mem,
+                                    int num_threads) {
+  cmark_strbuf html = CMARK_BUF_INIT(mem);
+  cmark_html_renderer renderer;
+  html_range *ranges;
+  cmark_node *node;
+  unsigned int footnotes = 0;
+  int n = 0, nranges, per_range, i;
+  bool ok = true;
+
+  for (node = root->first_child; node; node = node->next)
+    n++;
+  nranges = 4 * num_threads;
+  if (n < 16 * nranges)
+    nranges = n / 16;
+  if (nranges < 2)
+    return NULL;
+
+  ranges = (html_range *)mem->calloc(nranges + 1, sizeof(html_range));
+  per_range = n / nranges;
+  for (i = 0, node = root->first_child; node; node = node->next, i++) {
+    if (i % per_range == 0 && i / per_range < nranges) {
+      ranges[i / per_range].first = node;
+      ranges[i / per_range].footnote_ix = footnotes;
+    }
+    if (node->type == CMARK_NODE_FOOTNOTE_DEFINITION)
+      footnotes++;
+  }
+  ranges[nranges].footnote_ix = footnotes;
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+  for (i = 0; i < nranges; i++) {
+    cmark_html_renderer r;
+    cmark_strbuf_init(mem, &ranges[i].html, 0);
+    S_init_range_renderer(&r, &ranges[i].html, filters, ranges[i].footnote_ix);
+    S_render_blocks(&r, ranges[i].first, ranges[i + 1].first, options);
+    ranges[i].footnote_end = r.footnote_ix;
+  }
+
+  // Footnote definitions nested below the top level would be miscounted
+  for (i = 0; i < nranges; i++)
+    ok = ok && ranges[i].footnote_end == ranges[i + 1].footnote_ix;
+
+  for (i = 0; ok && i < nranges; i++) {
+    // A block that starts on a new line would have added a newline after a
+    // preceding block that did not end with one; render those serially.
+    if (html.size && html.ptr[html.size - 1] != '\n') {
+      S_init_range_renderer(&renderer, &html, filters, ranges[i].footnote_ix);
+      S_render_blocks(&renderer, ranges[i].first, ranges[i + 1].first, options);
+    } else {
+      cmark_strbuf_put(&html, ranges[i].html.ptr, ranges[i].html.size);
+    }
+  }
+
+  for (i = 0; i < nranges; i++)
+    cmark_strbuf_free(&ranges[i].html);
+  mem->free(ranges);
+
+  if (!ok) {
+    cmark_strbuf_free(&html);
+    return NULL;
+  }
+
+  if (footnotes) {
+    cmark_strbuf_puts(&html, "</ol>\n</section>\n");
+  }
+
+  return (char *)cmark_strbuf_detach(&html);
+}
+#endif
+
+char *cmark_render_html_threaded(cmark_node *root, int options,
+                                 cmark_llist *extensions, cmark_mem *mem,
+                                 int num_threads) {
+  char *result = NULL;
+  CMARK_TIMER_START(timer);
+#ifdef _OPENMP
+  cmark_llist *filters = NULL, *tmp;
+
+  if (num_threads > 1 && root->type == CMARK_NODE_DOCUMENT &&
+      mem != cmark_get_arena_mem_allocator()) {
+    for (tmp = extensions; tmp; tmp = tmp->next)
+      if (((cmark_syntax_extension *) tmp->data)->html_filter_func)
+        filters = cmark_llist_append(mem, filters, tmp->data);
+    // pending inlines are parsed with the document's parser and its pools,
+    // so they cannot be parsed by the rendering threads
+    cmark_parse_pending_inlines(root);
+    result = S_render_html_threaded(root, options, filters, mem, num_threads);
+    cmark_llist_free(mem, filters);
+  }
+#endif
+  if (!result)
+    result = cmark_render_html_with_mem(root, options, extensions, mem);
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_RENDER, NULL);
   return result;
 }
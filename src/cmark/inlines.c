@@ -13,6 +13,7 @@
 #include "scanners.h"
 #include "inlines.h"
 #include "syntax_extension.h"
+#include "timings.h"
 
 static const char *EMDASH = "\xE2\x80\x94";
 static const char *ENDASH = "\xE2\x80\x93";
@@ -43,8 +44,21 @@ typedef struct bracket {
   bool bracket_after;
 } bracket;
 
+// The openers_bottom table of process_emphasis is indexed by delimiter
+// character; only the rows of characters which were set are cleared.
+#define OPENERS_CHARS 128
+
+struct cmark_inline_pool {
+  delimiter *delimiters; // free records, linked by previous
+  bracket *brackets;
+  delimiter *openers_bottom[3][OPENERS_CHARS];
+  uint32_t openers_set[OPENERS_CHARS / 32];
+  cmark_node_list footnote_refs;
+};
+
 typedef struct subject{
   cmark_mem *mem;
+  cmark_inline_pool *pool;
   cmark_chunk input;
   int line;
   bufsize_t pos;
@@ -55,10 +69,18 @@ typedef struct subject{
   bracket *last_bracket;
   bufsize_t backticks[MAXBACKTICKS + 1];
   bool scanned_for_backticks;
+  // the last child of the block, if it is text which the next text may
+  // extend, and whether text nodes may still need to be consolidated
+  cmark_node *last_text;
+  bool adjacent_text;
+  // the special and skip characters of the parser
+  const int8_t *special_chars;
+  const int8_t *skip_chars;
 } subject;
 
-// Extensions may populate this.
+// Without extensions; parsers copy these and add their extensions' own.
 static int8_t SKIP_CHARS[256];
+static int8_t SPECIAL_CHARS[256];
 
 static CMARK_INLINE bool S_is_line_end_char(char c) {
   return (c == '\n' || c == '\r');
@@ -73,24 +95,28 @@ static void subject_from_buf(cmark_mem *mem, int line_number, int block_offset,
                              cmark_chunk *buffer, cmark_map *refmap);
 static bufsize_t subject_find_special_char(subject *subj, int options);
 
+// The column of a position in the subject; columns are 1 based.
+static CMARK_INLINE int S_column(subject *subj, bufsize_t pos) {
+  return pos + 1 + subj->column_offset + subj->block_offset;
+}
+
 // Create an inline with a literal string value.
 static CMARK_INLINE cmark_node *make_literal(subject *subj, cmark_node_type t,
                                              int start_column, int end_column,
                                              cmark_chunk s) {
-  cmark_node *e = (cmark_node *)subj->mem->calloc(1, sizeof(*e));
+  cmark_node *e = (cmark_node *)cmark_mem_calloc_at(subj->mem, CMARK_MEM_SITE_NODE, 1, sizeof(*e));
   cmark_strbuf_init(subj->mem, &e->content, 0);
   e->type = (uint16_t)t;
   e->as.literal = s;
   e->start_line = e->end_line = subj->line;
-  // columns are 1 based.
-  e->start_column = start_column + 1 + subj->column_offset + subj->block_offset;
-  e->end_column = end_column + 1 + subj->column_offset + subj->block_offset;
+  e->start_column = S_column(subj, start_column);
+  e->end_column = S_column(subj, end_column);
   return e;
 }
 
 // Create an inline with no value.
 static CMARK_INLINE cmark_node *make_simple(cmark_mem *mem, cmark_node_type t) {
-  cmark_node *e = (cmark_node *)mem->calloc(1, sizeof(*e));
+  cmark_node *e = (cmark_node *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_NODE, 1, sizeof(*e));
   cmark_strbuf_init(mem, &e->content, 0);
   e->type = (uint16_t)t;
   return e;
@@ -116,7 +142,7 @@ static cmark_chunk chunk_clone(cmark_mem *mem, cmark_chunk *src) {
   bufsize_t len = src->len;
 
   c.len = len;
-  c.data = (unsigned char *)mem->calloc(len + 1, 1);
+  c.data = (unsigned char *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_CHUNK, len + 1, 1);
   c.alloc = 1;
   if (len)
     memcpy(c.data, src->data, len);
@@ -160,6 +186,7 @@ static void subject_from_buf(cmark_mem *mem, int line_number, int block_offset,
                              cmark_chunk *chunk, cmark_map *refmap) {
   int i;
   e->mem = mem;
+  e->pool = NULL;
   e->input = *chunk;
   e->line = line_number;
   e->pos = 0;
@@ -172,6 +199,10 @@ static void subject_from_buf(cmark_mem *mem, int line_number, int block_offset,
     e->backticks[i] = 0;
   }
   e->scanned_for_backticks = false;
+  e->last_text = NULL;
+  e->adjacent_text = false;
+  e->special_chars = SPECIAL_CHARS;
+  e->skip_chars = SKIP_CHARS;
 }
 
 static CMARK_INLINE int isbacktick(int c) { return (c == '`'); }
@@ -392,12 +423,12 @@ static int scan_delims(subject *subj, unsigned char c, bool *can_open,
   } else {
     before_char_pos = subj->pos - 1;
     // walk back to the beginning of the UTF_8 sequence:
-    while ((peek_at(subj, before_char_pos) >> 6 == 2 || SKIP_CHARS[peek_at(subj, before_char_pos)]) && before_char_pos > 0) {
+    while ((peek_at(subj, before_char_pos) >> 6 == 2 || subj->skip_chars[peek_at(subj, before_char_pos)]) && before_char_pos > 0) {
       before_char_pos -= 1;
     }
     len = cmark_utf8proc_iterate(subj->input.data + before_char_pos,
                                  subj->pos - before_char_pos, &before_char);
-    if (len == -1 || (before_char < 256 && SKIP_CHARS[(unsigned char) before_char])) {
+    if (len == -1 || (before_char < 256 && subj->skip_chars[(unsigned char) before_char])) {
       before_char = 10;
     }
   }
@@ -416,12 +447,12 @@ static int scan_delims(subject *subj, unsigned char c, bool *can_open,
     after_char = 10;
   } else {
     after_char_pos = subj->pos;
-    while (SKIP_CHARS[peek_at(subj, after_char_pos)] && after_char_pos < subj->input.len) {
+    while (subj->skip_chars[peek_at(subj, after_char_pos)] && after_char_pos < subj->input.len) {
       after_char_pos += 1;
     }
     len = cmark_utf8proc_iterate(subj->input.data + after_char_pos,
                                  subj->input.len - after_char_pos, &after_char);
-    if (len == -1 || (after_char < 256 && SKIP_CHARS[(unsigned char) after_char])) {
+    if (len == -1 || (after_char < 256 && subj->skip_chars[(unsigned char) after_char])) {
     after_char = 10;
   }
   }
@@ -478,7 +509,15 @@ static void remove_delimiter(subject *subj, delimiter *delim) {
   if (delim->previous != NULL) {
     delim->previous->next = delim->next;
   }
-  subj->mem->free(delim);
+  // its text stays, possibly next to other text
+  if (delim->inl_text)
+    subj->adjacent_text = true;
+  if (subj->pool) {
+    delim->previous = subj->pool->delimiters;
+    subj->pool->delimiters = delim;
+  } else {
+    subj->mem->free(delim);
+  }
 }
 
 static void pop_bracket(subject *subj) {
@@ -487,13 +526,27 @@ static void pop_bracket(subject *subj) {
     return;
   b = subj->last_bracket;
   subj->last_bracket = subj->last_bracket->previous;
-  subj->mem->free(b);
+  if (b->inl_text)
+    subj->adjacent_text = true;
+  if (subj->pool) {
+    b->previous = subj->pool->brackets;
+    subj->pool->brackets = b;
+  } else {
+    subj->mem->free(b);
+  }
 }
 
 static void push_delimiter(subject *subj, unsigned char c,
                            cmark_syntax_extension *ext,
                            bool can_open, bool can_close, cmark_node *inl_text) {
-  delimiter *delim = (delimiter *)subj->mem->calloc(1, sizeof(delimiter));
+  delimiter *delim = subj->pool ? subj->pool->delimiters : NULL;
+  if (delim) {
+    subj->pool->delimiters = delim->previous;
+    memset(delim, 0, sizeof(delimiter));
+  } else {
+    delim = (delimiter *)cmark_mem_calloc_at(subj->mem, CMARK_MEM_SITE_DELIMITER,
+                                             1, sizeof(delimiter));
+  }
   delim->delim_char = c;
   delim->ext = ext;
   delim->can_open = can_open;
@@ -509,7 +562,13 @@ static void push_delimiter(subject *subj, unsigned char c,
 }
 
 static void push_bracket(subject *subj, bool image, cmark_node *inl_text) {
-  bracket *b = (bracket *)subj->mem->calloc(1, sizeof(bracket));
+  bracket *b = subj->pool ? subj->pool->brackets : NULL;
+  if (b) {
+    subj->pool->brackets = b->previous;
+    memset(b, 0, sizeof(bracket));
+  } else {
+    b = (bracket *)cmark_mem_calloc_at(subj->mem, CMARK_MEM_SITE_DELIMITER, 1, sizeof(bracket));
+  }
   if (subj->last_bracket != NULL) {
     subj->last_bracket->bracket_after = true;
   }
@@ -559,7 +618,7 @@ static cmark_node *handle_hyphen(subject *subj, bool smart) {
   advance(subj);
 
   if (!smart || peek_char(subj) != '-') {
-    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("-"));
+    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
   }
 
   while (smart && peek_char(subj) == '-') {
@@ -604,10 +663,10 @@ static cmark_node *handle_period(subject *subj, bool smart) {
       advance(subj);
       return make_str(subj, subj->pos - 3, subj->pos - 1, cmark_chunk_literal(ELLIPSES));
     } else {
-      return make_str(subj, subj->pos - 2, subj->pos - 1, cmark_chunk_literal(".."));
+      return make_str(subj, subj->pos - 2, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 2, 2));
     }
   } else {
-    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("."));
+    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
   }
 }
 
@@ -629,23 +688,42 @@ static cmark_syntax_extension *get_extension_for_special_char(cmark_parser *pars
   return NULL;
 }
 
+static void S_set_openers_bottom(cmark_inline_pool *pool, unsigned char c,
+                                 int row, delimiter *bottom) {
+  pool->openers_bottom[row][c] = bottom;
+  pool->openers_set[c / 32] |= 1u << (c % 32);
+}
+
+// Clears only the characters which were set since the last reset.
+static void S_reset_openers_bottom(cmark_inline_pool *pool, delimiter *stack_bottom) {
+  int i, c;
+
+  for (i = 0; i < OPENERS_CHARS / 32; i++) {
+    for (c = i * 32; pool->openers_set[i]; c++) {
+      if (pool->openers_set[i] & (1u << (c % 32))) {
+        pool->openers_bottom[0][c] = pool->openers_bottom[1][c] =
+            pool->openers_bottom[2][c] = NULL;
+        pool->openers_set[i] &= ~(1u << (c % 32));
+      }
+    }
+  }
+  for (i = 0; i < 3; i++) {
+    S_set_openers_bottom(pool, '*', i, stack_bottom);
+    S_set_openers_bottom(pool, '_', i, stack_bottom);
+    S_set_openers_bottom(pool, '\'', i, stack_bottom);
+    S_set_openers_bottom(pool, '"', i, stack_bottom);
+  }
+}
+
 static void process_emphasis(cmark_parser *parser, subject *subj, delimiter *stack_bottom) {
   delimiter *closer = subj->last_delim;
   delimiter *opener;
   delimiter *old_closer;
   bool opener_found;
   bool odd_match;
-  delimiter *openers_bottom[3][128];
-  int i;
+  delimiter *(*openers_bottom)[OPENERS_CHARS] = subj->pool->openers_bottom;
 
-  // initialize openers_bottom:
-  memset(&openers_bottom, 0, sizeof(openers_bottom));
-  for (i=0; i < 3; i++) {
-    openers_bottom[i]['*'] = stack_bottom;
-    openers_bottom[i]['_'] = stack_bottom;
-    openers_bottom[i]['\''] = stack_bottom;
-    openers_bottom[i]['"'] = stack_bottom;
-  }
+  S_reset_openers_bottom(subj->pool, stack_bottom);
 
   // move back to first relevant delim.
   while (closer != NULL && closer->previous != stack_bottom) {
@@ -678,9 +756,11 @@ static void process_emphasis(cmark_parser *parser, subject *subj, delimiter *sta
       old_closer = closer;
 
       if (extension) {
-        if (opener_found)
+        if (opener_found) {
+          CMARK_EXT_TIMER_START(timer);
           closer = extension->insert_inline_from_delim(extension, parser, subj, opener, closer);
-        else
+          CMARK_EXT_TIMER_STOP(timer, extension, CMARK_EXT_INSERT_INLINE_FROM_DELIM);
+        } else
           closer = closer->next;
       } else if (closer->delim_char == '*' || closer->delim_char == '_') {
         if (opener_found) {
@@ -707,8 +787,8 @@ static void process_emphasis(cmark_parser *parser, subject *subj, delimiter *sta
       }
       if (!opener_found) {
         // set lower bound for future searches for openers
-        openers_bottom[old_closer->length % 3][old_closer->delim_char] =
-		old_closer->previous;
+        S_set_openers_bottom(subj->pool, old_closer->delim_char,
+                             old_closer->length % 3, old_closer->previous);
         if (!old_closer->can_open) {
           // we can remove a closer that can't be an
           // opener, once we've seen there's no
@@ -772,6 +852,7 @@ static delimiter *S_insert_emph(subject *subj, delimiter *opener,
   // if opener has 0 characters, remove it and its associated inline
   if (opener_num_chars == 0) {
     cmark_node_free(opener_inl);
+    opener->inl_text = NULL;
     remove_delimiter(subj, opener);
   }
 
@@ -779,6 +860,7 @@ static delimiter *S_insert_emph(subject *subj, delimiter *opener,
   if (closer_num_chars == 0) {
     // remove empty closer inline
     cmark_node_free(closer_inl);
+    closer->inl_text = NULL;
     // remove closer from list
     tmp_delim = closer->next;
     remove_delimiter(subj, closer);
@@ -799,7 +881,7 @@ static cmark_node *handle_backslash(cmark_parser *parser, subject *subj) {
   } else if (!is_eof(subj) && skip_line_end(subj)) {
     return make_linebreak(subj->mem);
   } else {
-    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("\\"));
+    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
   }
 }
 
@@ -815,7 +897,7 @@ static cmark_node *handle_entity(subject *subj) {
                              subj->input.len - subj->pos);
 
   if (len == 0)
-    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("&"));
+    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
 
   subj->pos += len;
   return make_str(subj, subj->pos - 1 - len, subj->pos - 1, cmark_chunk_buf_detach(&ent));
@@ -911,7 +993,7 @@ static cmark_node *handle_pointy_brace(subject *subj, int options) {
   }
 
   // if nothing matches, just return the opening <:
-  return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("<"));
+  return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
 }
 
 // Parse a link label.  Returns 1 if successful.
@@ -1049,13 +1131,13 @@ static cmark_node *handle_close_bracket(cmark_parser *parser, subject *subj) {
   opener = subj->last_bracket;
 
   if (opener == NULL) {
-    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("]"));
+    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
   }
 
   if (!opener->active) {
     // take delimiter off stack
     pop_bracket(subj);
-    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("]"));
+    return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
   }
 
   // If we got here, we matched a potential link/image text.
@@ -1120,6 +1202,15 @@ static cmark_node *handle_close_bracket(cmark_parser *parser, subject *subj) {
     cmark_chunk_free(subj->mem, &raw_label);
   }
 
+  // Every use copies the destination and title, so max_output bounds them
+  if (ref != NULL && parser->limits.max_output) {
+    size_t len = (size_t)ref->url.len + (size_t)ref->title.len;
+    if (parser->ref_bytes + len > parser->limits.max_output)
+      ref = NULL;
+    else
+      parser->ref_bytes += len;
+  }
+
   if (ref != NULL) { // found
     url = chunk_clone(subj->mem, &ref->url);
     title = chunk_clone(subj->mem, &ref->title);
@@ -1143,8 +1234,10 @@ noMatch:
       inl->start_column = opener->inl_text->start_column;
       inl->end_column = subj->pos + subj->column_offset + subj->block_offset;
       cmark_node_insert_before(opener->inl_text, inl);
+      cmark_node_list_push(subj->mem, &subj->pool->footnote_refs, inl);
       cmark_node_free(opener->inl_text->next);
       cmark_node_free(opener->inl_text);
+      opener->inl_text = NULL;
       process_emphasis(parser, subj, opener->previous_delimiter);
       pop_bracket(subj);
       return NULL;
@@ -1153,7 +1246,7 @@ noMatch:
 
   pop_bracket(subj); // remove this opener from delimiter list
   subj->pos = initial_pos;
-  return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("]"));
+  return make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
 
 match:
   inl = make_simple(subj->mem, is_image ? CMARK_NODE_IMAGE : CMARK_NODE_LINK);
@@ -1173,6 +1266,7 @@ match:
 
   // Free the bracket [:
   cmark_node_free(opener->inl_text);
+  opener->inl_text = NULL;
 
   process_emphasis(parser, subj, opener->previous_delimiter);
   pop_bracket(subj);
@@ -1253,7 +1347,7 @@ static bufsize_t subject_find_special_char(subject *subj, int options) {
   bufsize_t n = subj->pos + 1;
 
   while (n < subj->input.len) {
-    if (SPECIAL_CHARS[subj->input.data[n]])
+    if (subj->special_chars[subj->input.data[n]])
       return n;
     if (options & CMARK_OPT_SMART && SMART_PUNCT_CHARS[subj->input.data[n]])
       return n;
@@ -1275,6 +1369,11 @@ void cmark_inlines_remove_special_character(unsigned char c, bool emphasis) {
     SKIP_CHARS[c] = 0;
 }
 
+void cmark_inlines_reset_special_characters(int8_t *special_chars, int8_t *skip_chars) {
+  memcpy(special_chars, SPECIAL_CHARS, sizeof(SPECIAL_CHARS));
+  memcpy(skip_chars, SKIP_CHARS, sizeof(SKIP_CHARS));
+}
+
 static cmark_node *try_extensions(cmark_parser *parser,
                                   cmark_node *parent,
                                   unsigned char c,
@@ -1284,7 +1383,9 @@ static cmark_node *try_extensions(cmark_parser *parser,
 
   for (tmp = parser->inline_syntax_extensions; tmp; tmp = tmp->next) {
     cmark_syntax_extension *ext = (cmark_syntax_extension *) tmp->data;
+    CMARK_EXT_TIMER_START(timer);
     res = ext->match_inline(ext, parser, parent, c, subj);
+    CMARK_EXT_TIMER_STOP(timer, ext, CMARK_EXT_MATCH_INLINE);
 
     if (res)
       break;
@@ -1293,10 +1394,71 @@ static cmark_node *try_extensions(cmark_parser *parser,
   return res;
 }
 
+// Whether a node is the text of one of the last two delimiters or
+// brackets. Only these can be among the last two children of the block.
+static bool S_on_stack(subject *subj, cmark_node *node) {
+  delimiter *d = subj->last_delim;
+  bracket *b = subj->last_bracket;
+
+  return (d && (d->inl_text == node ||
+                (d->previous && d->previous->inl_text == node))) ||
+         (b && (b->inl_text == node ||
+                (b->previous && b->previous->inl_text == node)));
+}
+
+// Returns the last text node if 'lit' directly follows its literal in the
+// input, so that the node can be extended instead of adding another.
+static cmark_node *S_extensible_text(subject *subj, cmark_node *parent,
+                                     cmark_chunk *lit, int options) {
+  cmark_node *last = subj->last_text;
+
+  if (!last || last != parent->last_child || lit->alloc ||
+      last->as.literal.data + last->as.literal.len != lit->data)
+    return NULL;
+  // a footnote reference is recognized by a single text node after the
+  // bracket, which must not take in more than it used to
+  if ((options & CMARK_OPT_FOOTNOTES) && subj->last_bracket &&
+      subj->last_bracket->inl_text == last->prev)
+    return NULL;
+  return last;
+}
+
+// Appends a new inline to parent. Most runs of adjacent text come from
+// special characters which turn out to be literal: text which directly
+// follows the last text node in the input extends that node instead.
+// Other text next to text is left to cmark_consolidate_text_nodes, as
+// is the text of delimiters and brackets once it is known to stay.
+static void S_append_inline(subject *subj, cmark_node *parent, cmark_node *new_inl,
+                            bool from_extension, int options) {
+  cmark_node *last;
+  bool plain = !from_extension && new_inl->type == CMARK_NODE_TEXT &&
+               !S_on_stack(subj, new_inl);
+
+  if (plain &&
+      (last = S_extensible_text(subj, parent, &new_inl->as.literal, options))) {
+    last->as.literal.len += new_inl->as.literal.len;
+    last->end_column = new_inl->end_column;
+    cmark_node_free(new_inl);
+    return;
+  }
+
+  last = parent->last_child;
+  if (new_inl->type == CMARK_NODE_TEXT && !S_on_stack(subj, new_inl) &&
+      last && last->type == CMARK_NODE_TEXT && !S_on_stack(subj, last))
+    subj->adjacent_text = true;
+  cmark_node_append_child(parent, new_inl);
+  subj->last_text = plain && !new_inl->as.literal.alloc &&
+                    new_inl->as.literal.data >= subj->input.data &&
+                    new_inl->as.literal.data < subj->input.data + subj->input.len
+                        ? new_inl
+                        : NULL;
+}
+
 // Parse an inline, advancing subject, and add it as a child of parent.
 // Return 0 if no inline can be parsed, 1 otherwise.
 static int parse_inline(cmark_parser *parser, subject *subj, cmark_node *parent, int options) {
-  cmark_node *new_inl = NULL;
+  cmark_node *new_inl = NULL, *last;
+  bool from_extension = false;
   cmark_chunk contents;
   unsigned char c;
   bufsize_t startpos, endpos;
@@ -1348,13 +1510,15 @@ static int parse_inline(cmark_parser *parser, subject *subj, cmark_node *parent,
       new_inl = make_str(subj, subj->pos - 2, subj->pos - 1, cmark_chunk_literal("!["));
       push_bracket(subj, true, new_inl);
     } else {
-      new_inl = make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_literal("!"));
+      new_inl = make_str(subj, subj->pos - 1, subj->pos - 1, cmark_chunk_dup(&subj->input, subj->pos - 1, 1));
     }
     break;
   default:
     new_inl = try_extensions(parser, parent, c, subj);
-    if (new_inl != NULL)
+    if (new_inl != NULL) {
+      from_extension = true;
       break;
+    }
 
     endpos = subject_find_special_char(subj, options);
     contents = cmark_chunk_dup(&subj->input, subj->pos, endpos - subj->pos);
@@ -1366,27 +1530,94 @@ static int parse_inline(cmark_parser *parser, subject *subj, cmark_node *parent,
       cmark_chunk_rtrim(&contents);
     }
 
+    // the common case of S_append_inline, without allocating a node
+    last = S_extensible_text(subj, parent, &contents, options);
+    if (last) {
+      last->as.literal.len += contents.len;
+      last->end_column = S_column(subj, endpos - 1);
+      return 1;
+    }
+
     new_inl = make_str(subj, startpos, endpos - 1, contents);
   }
   if (new_inl != NULL) {
-    cmark_node_append_child(parent, new_inl);
+    S_append_inline(subj, parent, new_inl, from_extension, options);
+  } else {
+    // a link or footnote reference took in the last children
+    subj->last_text = NULL;
   }
 
   return 1;
 }
 
+cmark_inline_pool *cmark_inline_pool_new(cmark_mem *mem) {
+  return (cmark_inline_pool *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_DELIMITER, 1,
+                                                  sizeof(cmark_inline_pool));
+}
+
+void cmark_inline_pool_free(cmark_mem *mem, cmark_inline_pool *pool) {
+  delimiter *delim;
+  bracket *b;
+
+  while ((delim = pool->delimiters)) {
+    pool->delimiters = delim->previous;
+    mem->free(delim);
+  }
+  while ((b = pool->brackets)) {
+    pool->brackets = b->previous;
+    mem->free(b);
+  }
+  cmark_node_list_free(mem, &pool->footnote_refs);
+  mem->free(pool);
+}
+
+cmark_node_list *cmark_inline_pool_footnote_refs(cmark_inline_pool *pool) {
+  return &pool->footnote_refs;
+}
+
 // Parse inlines from parent's string_content, adding as children of parent.
 void cmark_parse_inlines(cmark_parser *parser,
                          cmark_node *parent,
                          cmark_map *refmap,
                          int options) {
+  if (!parser->inline_pool)
+    parser->inline_pool = cmark_inline_pool_new(parser->mem);
+  cmark_parse_inlines_with_pool(parser, parent, refmap, options, parser->inline_pool);
+}
+
+// Once a limit is exceeded, the rest of a leaf is kept as text
+static void S_append_rest(subject *subj, cmark_node *parent) {
+  bufsize_t len = subj->input.len - subj->pos;
+  cmark_node *text = make_str(subj, subj->pos, subj->input.len - 1,
+                              cmark_chunk_dup(&subj->input, subj->pos, len));
+
+  cmark_node_append_child(parent, text);
+  subj->pos = subj->input.len;
+  subj->adjacent_text = true;
+}
+
+void cmark_parse_inlines_with_pool(cmark_parser *parser,
+                                   cmark_node *parent,
+                                   cmark_map *refmap,
+                                   int options,
+                                   cmark_inline_pool *pool) {
   subject subj;
   cmark_chunk content = {parent->content.ptr, parent->content.size, 0};
   subject_from_buf(parser->mem, parent->start_line, parent->start_column - 1 + parent->internal_offset, &subj, &content, refmap);
+  subj.pool = pool;
+  subj.special_chars = parser->special_chars;
+  subj.skip_chars = parser->skip_chars;
   cmark_chunk_rtrim(&subj.input);
 
-  while (!is_eof(&subj) && parse_inline(parser, &subj, parent, options))
-    ;
+  while (!is_eof(&subj)) {
+    if (parser->has_limits &&
+        cmark_parser_limit_reached(parser, (++parser->nodes & 255) == 0)) {
+      S_append_rest(&subj, parent);
+      break;
+    }
+    if (!parse_inline(parser, &subj, parent, options))
+      break;
+  }
 
   process_emphasis(parser, &subj, NULL);
   // free bracket and delim stack
@@ -1396,6 +1627,9 @@ void cmark_parse_inlines(cmark_parser *parser,
   while (subj.last_bracket) {
     pop_bracket(&subj);
   }
+
+  if (subj.adjacent_text)
+    cmark_consolidate_text_nodes(parent);
 }
 
 // Parse zero or more space characters, including at most one newline.
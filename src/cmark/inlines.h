@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include "node.h"
 #include "references.h"
 
 cmark_chunk cmark_clean_url(cmark_mem *mem, cmark_chunk *url);
@@ -16,12 +17,35 @@ void cmark_parse_inlines(cmark_parser *parser,
                          cmark_map *refmap,
                          int options);
 
+/* Delimiter and bracket records which are reused across the leaves of a
+ * document, and the scratch table of process_emphasis. cmark_parse_inlines
+ * uses the pool of the parser; parsing on several threads needs a pool
+ * per thread. */
+typedef struct cmark_inline_pool cmark_inline_pool;
+
+cmark_inline_pool *cmark_inline_pool_new(cmark_mem *mem);
+void cmark_inline_pool_free(cmark_mem *mem, cmark_inline_pool *pool);
+
+/* The footnote references created with the pool, in the order they were
+ * created. */
+cmark_node_list *cmark_inline_pool_footnote_refs(cmark_inline_pool *pool);
+
+void cmark_parse_inlines_with_pool(cmark_parser *parser,
+                                   cmark_node *parent,
+                                   cmark_map *refmap,
+                                   int options,
+                                   cmark_inline_pool *pool);
+
 bufsize_t cmark_parse_reference_inline(cmark_mem *mem, cmark_chunk *input,
                                        cmark_map *refmap);
 
 void cmark_inlines_add_special_character(unsigned char c, bool emphasis);
 void cmark_inlines_remove_special_character(unsigned char c, bool emphasis);
 
+/* Copies the special and skip characters without extensions into the
+ * tables of a parser */
+void cmark_inlines_reset_special_characters(int8_t *special_chars, int8_t *skip_chars);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include "node.h"
+#include "parser.h"
 #include "cmark-gfm.h"
 #include "iterator.h"
 
@@ -39,6 +40,16 @@ static bool S_is_leaf(cmark_node *node) {
 }
 
 cmark_event_type cmark_iter_next(cmark_iter *iter) {
+  if (iter->descend_pending) {
+    iter->descend_pending = false;
+    cmark_parse_pending_inlines(iter->next.node);
+    if (iter->next.node->first_child) {
+      iter->next.node = iter->next.node->first_child;
+    } else {
+      iter->next.ev_type = CMARK_EVENT_EXIT;
+    }
+  }
+
   cmark_event_type ev_type = iter->next.ev_type;
   cmark_node *node = iter->next.node;
 
@@ -51,7 +62,12 @@ cmark_event_type cmark_iter_next(cmark_iter *iter) {
 
   /* roll forward to next item, setting both fields */
   if (ev_type == CMARK_EVENT_ENTER && !S_is_leaf(node)) {
-    if (node->first_child == NULL) {
+    if (node->flags & CMARK_NODE__INLINES_PENDING) {
+      /* parsed on the next call, unless the leaf is skipped with
+         cmark_iter_reset; see CMARK_OPT_LAZY_INLINES */
+      iter->next.ev_type = CMARK_EVENT_ENTER;
+      iter->descend_pending = true;
+    } else if (node->first_child == NULL) {
       /* stay on this node but exit */
       iter->next.ev_type = CMARK_EVENT_EXIT;
     } else {
@@ -81,6 +97,7 @@ void cmark_iter_reset(cmark_iter *iter, cmark_node *current,
                       cmark_event_type event_type) {
   iter->next.ev_type = event_type;
   iter->next.node = current;
+  iter->descend_pending = false;
   cmark_iter_next(iter);
 }
 
@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include "cmark-gfm.h"
+#include <stdbool.h>
 #include "memory.h"
 
 typedef struct {
@@ -18,6 +19,8 @@ struct cmark_iter {
   cmark_node *root;
   cmark_iter_state cur;
   cmark_iter_state next;
+  /* The next event descends into a leaf whose inlines are still pending */
+  bool descend_pending;
 };
 
 #ifdef __cplusplus
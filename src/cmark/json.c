@@ -0,0 +1,172 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "cmark-gfm.h"
+#include "node.h"
+#include "buffer.h"
+#include "syntax_extension.h"
+#include "timings.h"
+
+#define BUFFER_SIZE 100
+
+// Functions to convert cmark_nodes to JSON strings.
+//
+// Every node is an object with its type string in "t", its children (if
+// any) in "c", and the source position in "pos" as [start_line,
+// start_column, end_line, end_column] with CMARK_OPT_SOURCEPOS. The other
+// members depend on the type of node, and are named like the columns of
+// md_ast(). There is no whitespace between tokens.
+
+static const char json_escapes[32][7] = {
+    "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005",
+    "\\u0006", "\\u0007", "\\b",     "\\t",     "\\n",     "\\u000b",
+    "\\f",     "\\r",     "\\u000e", "\\u000f", "\\u0010", "\\u0011",
+    "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
+    "\\u0018", "\\u0019", "\\u001a", "\\u001b", "\\u001c", "\\u001d",
+    "\\u001e", "\\u001f"};
+
+// Writes a quoted string. UTF-8 is copied as it is, only quotes,
+// backslashes and control characters are escaped.
+static void escape_json(cmark_strbuf *dest, const unsigned char *source,
+                        bufsize_t length) {
+  bufsize_t i = 0, org;
+
+  cmark_strbuf_putc(dest, '"');
+  while (i < length) {
+    org = i;
+    while (i < length && source[i] >= 0x20 && source[i] != '"' && source[i] != '\\')
+      i++;
+    if (i > org)
+      cmark_strbuf_put(dest, source + org, i - org);
+    if (i >= length)
+      break;
+    if (source[i] < 0x20) {
+      cmark_strbuf_puts(dest, json_escapes[source[i]]);
+    } else {
+      cmark_strbuf_putc(dest, '\\');
+      cmark_strbuf_putc(dest, source[i]);
+    }
+    i++;
+  }
+  cmark_strbuf_putc(dest, '"');
+}
+
+static void put_member(cmark_strbuf *json, const char *name, cmark_chunk *value) {
+  cmark_strbuf_putc(json, ',');
+  cmark_strbuf_putc(json, '"');
+  cmark_strbuf_puts(json, name);
+  cmark_strbuf_puts(json, "\":");
+  escape_json(json, value->data, value->len);
+}
+
+static void S_render_node(cmark_node *root, cmark_node *node, cmark_event_type ev_type,
+                          cmark_strbuf *json, int options) {
+  char buffer[BUFFER_SIZE];
+  cmark_delim_type delim;
+
+  if (ev_type != CMARK_EVENT_ENTER) {
+    if (node->first_child)
+      cmark_strbuf_puts(json, "]}");
+    return;
+  }
+
+  if (node != root && node->prev)
+    cmark_strbuf_putc(json, ',');
+  cmark_strbuf_puts(json, "{\"t\":\"");
+  cmark_strbuf_puts(json, cmark_node_get_type_string(node));
+  cmark_strbuf_putc(json, '"');
+
+  if (options & CMARK_OPT_SOURCEPOS && node->start_line != 0) {
+    snprintf(buffer, BUFFER_SIZE, ",\"pos\":[%d,%d,%d,%d]", node->start_line,
+             node->start_column, node->end_line, node->end_column);
+    cmark_strbuf_puts(json, buffer);
+  }
+
+  if (node->extension && node->extension->json_attr_func) {
+    CMARK_EXT_TIMER_START(timer);
+    const char *r = node->extension->json_attr_func(node->extension, node);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_JSON_ATTR);
+    if (r != NULL)
+      cmark_strbuf_puts(json, r);
+  }
+
+  switch (node->type) {
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_CODE:
+  case CMARK_NODE_HTML_BLOCK:
+  case CMARK_NODE_HTML_INLINE:
+    put_member(json, "literal", &node->as.literal);
+    break;
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    put_member(json, "label", &node->as.literal);
+    break;
+  case CMARK_NODE_LIST:
+    if (node->as.list.list_type == CMARK_ORDERED_LIST) {
+      delim = node->as.list.delimiter;
+      snprintf(buffer, BUFFER_SIZE, ",\"list_type\":\"ordered\",\"list_start\":%d",
+               node->as.list.start);
+      cmark_strbuf_puts(json, buffer);
+      if (delim == CMARK_PAREN_DELIM)
+        cmark_strbuf_puts(json, ",\"list_delim\":\"paren\"");
+      else if (delim == CMARK_PERIOD_DELIM)
+        cmark_strbuf_puts(json, ",\"list_delim\":\"period\"");
+    } else if (node->as.list.list_type == CMARK_BULLET_LIST) {
+      cmark_strbuf_puts(json, ",\"list_type\":\"bullet\"");
+    }
+    cmark_strbuf_puts(json, node->as.list.tight ? ",\"list_tight\":true"
+                                                : ",\"list_tight\":false");
+    break;
+  case CMARK_NODE_HEADING:
+    snprintf(buffer, BUFFER_SIZE, ",\"level\":%d", node->as.heading.level);
+    cmark_strbuf_puts(json, buffer);
+    break;
+  case CMARK_NODE_CODE_BLOCK:
+    if (node->as.code.info.len > 0)
+      put_member(json, "info", &node->as.code.info);
+    put_member(json, "literal", &node->as.code.literal);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    put_member(json, "on_enter", &node->as.custom.on_enter);
+    put_member(json, "on_exit", &node->as.custom.on_exit);
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    put_member(json, "url", &node->as.link.url);
+    put_member(json, "title", &node->as.link.title);
+    break;
+  default:
+    break;
+  }
+
+  // parses the inlines of a lazy leaf, as the iterator would next
+  if (cmark_node_first_child(node))
+    cmark_strbuf_puts(json, ",\"c\":[");
+  else
+    cmark_strbuf_putc(json, '}');
+}
+
+char *cmark_render_json(cmark_node *root, int options) {
+  return cmark_render_json_with_mem(root, options, cmark_node_mem(root));
+}
+
+char *cmark_render_json_with_mem(cmark_node *root, int options, cmark_mem *mem) {
+  char *result;
+  cmark_strbuf json = CMARK_BUF_INIT(mem);
+  cmark_event_type ev_type;
+  CMARK_TIMER_START(timer);
+
+  cmark_iter *iter = cmark_iter_new(root);
+
+  while ((ev_type = cmark_iter_next(iter)) != CMARK_EVENT_DONE)
+    S_render_node(root, cmark_iter_get_node(iter), ev_type, &json, options);
+  cmark_strbuf_putc(&json, '\n');
+  result = (char *)cmark_strbuf_detach(&json);
+
+  cmark_iter_free(iter);
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_RENDER, NULL);
+  return result;
+}
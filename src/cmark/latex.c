@@ -12,6 +12,7 @@
 #include "render.h"
 #include "syntax_extension.h"
 #include "cmark-gfm-extension_api.h"
+#include "timings.h"
 
 #ifdef DEBUG
 #include <cmark_trace.h>
@@ -242,7 +243,9 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
   bool allow_wrap = renderer->width > 0 && !(CMARK_OPT_NOBREAKS & options);
 
   if (node->extension && node->extension->latex_render_func) {
+    CMARK_EXT_TIMER_START(timer);
     node->extension->latex_render_func(node->extension, renderer, node, ev_type, options);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_LATEX_RENDER);
     return 1;
   }
 
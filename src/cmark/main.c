@@ -1,3 +1,8 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+// S_ISSOCK, fdopen() and the socket calls under -std=c99
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -10,6 +15,7 @@
 #include "syntax_extension.h"
 #include "parser.h"
 #include "registry.h"
+#include "timings.h"
 
 #include "../extensions/cmark-gfm-core-extensions.h"
 
@@ -18,6 +24,22 @@
 #include <fcntl.h>
 #endif
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 typedef enum {
   FORMAT_NONE,
   FORMAT_HTML,
@@ -25,14 +47,16 @@ typedef enum {
   FORMAT_MAN,
   FORMAT_COMMONMARK,
   FORMAT_PLAINTEXT,
-  FORMAT_LATEX
+  FORMAT_LATEX,
+  FORMAT_TEXT,
+  FORMAT_JSON
 } writer_format;
 
 void print_usage() {
   printf("Usage:   cmark-gfm [FILE*]\n");
   printf("Options:\n");
   printf("  --to, -t FORMAT   Specify output format (html, xml, man, "
-         "commonmark, plaintext, latex)\n");
+         "commonmark, plaintext, latex, text, json)\n");
   printf("  --width WIDTH     Specify wrap width (default 0 = nowrap)\n");
   printf("  --sourcepos       Include source position attribute\n");
   printf("  --hardbreaks      Treat newlines as hard line breaks\n");
@@ -49,45 +73,155 @@ void print_usage() {
          "                                  instead of align attributes.\n");
   printf("  --full-info-string              Include remainder of code block info\n"
          "                                  string in a separate attribute.\n");
+  printf("  --threads N                     Parse and render HTML on N threads\n");
+  printf("  --emit-ast                      Write the parsed tree in binary form\n");
+  printf("  --from-ast                      Render a tree written with --emit-ast\n");
+  printf("  --batch                         Render every file on its own into --out-dir\n");
+  printf("  --out-dir DIR                   Directory for the outputs of --batch\n");
+  printf("  --jobs, -j N                    Render N files at a time with --batch\n");
+  printf("  --serve                         Answer requests on stdin until it is closed\n");
+  printf("  --socket PATH                   Answer requests on a Unix socket\n");
+  printf("  --mem-stats                     Print allocation statistics to stderr\n");
+  printf("  --timings                       Print time spent per phase to stderr\n");
+  printf("  --ext-timings                   Also time every extension callback\n");
   printf("  --help, -h       Print usage information\n");
   printf("  --version        Print version\n");
 }
 
-static bool print_document(cmark_node *document, writer_format writer,
-                           int options, int width, cmark_parser *parser) {
-  char *result;
+static const struct {
+  const char *name;
+  int option;
+} option_flags[] = {
+  {"--full-info-string", CMARK_OPT_FULL_INFO_STRING},
+  {"--table-prefer-style-attributes", CMARK_OPT_TABLE_PREFER_STYLE_ATTRIBUTES},
+  {"--strikethrough-double-tilde", CMARK_OPT_STRIKETHROUGH_DOUBLE_TILDE},
+  {"--sourcepos", CMARK_OPT_SOURCEPOS},
+  {"--hardbreaks", CMARK_OPT_HARDBREAKS},
+  {"--nobreaks", CMARK_OPT_NOBREAKS},
+  {"--smart", CMARK_OPT_SMART},
+  {"--github-pre-lang", CMARK_OPT_GITHUB_PRE_LANG},
+  {"--unsafe", CMARK_OPT_UNSAFE},
+  {"--validate-utf8", CMARK_OPT_VALIDATE_UTF8},
+  {"--liberal-html-tag", CMARK_OPT_LIBERAL_HTML_TAG},
+};
 
-  cmark_mem *mem = cmark_get_default_mem_allocator();
+static const char *format_names[] = {
+  NULL, "html", "xml", "man", "commonmark", "plaintext", "latex", "text", "json"
+};
+
+// File extensions of the outputs of --batch
+static const char *format_suffixes[] = {
+  NULL, "html", "xml", "1", "md", "txt", "tex", "txt", "json"
+};
+
+// Returns the option set by a flag such as --smart, or 0.
+static int find_option_flag(const char *arg) {
+  size_t i;
+
+  for (i = 0; i < sizeof(option_flags) / sizeof(option_flags[0]); i++) {
+    if (strcmp(arg, option_flags[i].name) == 0)
+      return option_flags[i].option;
+  }
+  return 0;
+}
+
+static writer_format find_format(const char *name) {
+  int i;
 
+  for (i = FORMAT_HTML; i <= FORMAT_JSON; i++) {
+    if (strcmp(name, format_names[i]) == 0)
+      return (writer_format)i;
+  }
+  return FORMAT_NONE;
+}
+
+static char *render_document(cmark_node *document, writer_format writer,
+                             int options, int width, cmark_parser *parser,
+                             int num_threads, cmark_mem *mem) {
   switch (writer) {
   case FORMAT_HTML:
-    result = cmark_render_html_with_mem(document, options, parser->syntax_extensions, mem);
-    break;
+    return cmark_render_html_threaded(document, options, parser->syntax_extensions, mem, num_threads);
   case FORMAT_XML:
-    result = cmark_render_xml_with_mem(document, options, mem);
-    break;
+    return cmark_render_xml_with_mem(document, options, mem);
+  case FORMAT_JSON:
+    return cmark_render_json_with_mem(document, options, mem);
   case FORMAT_MAN:
-    result = cmark_render_man_with_mem(document, options, width, mem);
-    break;
+    return cmark_render_man_with_mem(document, options, width, mem);
   case FORMAT_COMMONMARK:
-    result = cmark_render_commonmark_with_mem(document, options, width, mem);
-    break;
+    return cmark_render_commonmark_with_mem(document, options, width, mem);
   case FORMAT_PLAINTEXT:
-    result = cmark_render_plaintext_with_mem(document, options, width, mem);
-    break;
+    return cmark_render_plaintext_with_mem(document, options, width, mem);
   case FORMAT_LATEX:
-    result = cmark_render_latex_with_mem(document, options, width, mem);
-    break;
+    return cmark_render_latex_with_mem(document, options, width, mem);
+  case FORMAT_TEXT:
+    return cmark_extract_text(document, 0, 0, mem);
   default:
+    return NULL;
+  }
+}
+
+static bool print_document(cmark_node *document, writer_format writer,
+                           int options, int width, cmark_parser *parser,
+                           int num_threads, cmark_mem *mem) {
+  char *result = render_document(document, writer, options, width, parser,
+                                 num_threads, mem);
+
+  if (!result) {
     fprintf(stderr, "Unknown format %d\n", writer);
     return false;
   }
-  printf("%s", result);
+  printf(writer == FORMAT_TEXT ? "%s\n" : "%s", result);
   mem->free(result);
 
   return true;
 }
 
+static void print_mem_stats(void) {
+  cmark_mem_stats stats;
+  int i;
+
+  cmark_mem_stats_get(&stats);
+  fprintf(stderr, "peak bytes: %lu\nlive bytes: %lu\nfrees: %lu\n",
+          (unsigned long)stats.peak_bytes, (unsigned long)stats.live_bytes,
+          (unsigned long)stats.frees);
+  fprintf(stderr, "%-10s %12s %14s\n", "site", "calls", "bytes");
+  for (i = 0; i < CMARK_MEM_SITE_COUNT; i++) {
+    fprintf(stderr, "%-10s %12lu %14lu\n", cmark_mem_site_name((cmark_mem_site)i),
+            (unsigned long)stats.calls[i], (unsigned long)stats.bytes[i]);
+  }
+}
+
+static void print_timings(void) {
+  const cmark_timing *timings;
+  size_t i, n = cmark_timings_get(&timings);
+
+  fprintf(stderr, "%-12s %-14s %10s %14s\n", "phase", "extension", "count", "ns");
+  for (i = 0; i < n; i++) {
+    fprintf(stderr, "%-12s %-14s %10lu %14.0f\n", cmark_phase_name(timings[i].phase),
+            timings[i].name ? timings[i].name : "-", (unsigned long)timings[i].count,
+            (double)timings[i].ns);
+  }
+}
+
+static void print_ext_timings(void) {
+  const cmark_timing *timings;
+  const cmark_ext_timing *ext_timings;
+  size_t i, n = cmark_timings_get(&timings);
+  double total = 0;
+
+  for (i = 0; i < n; i++)
+    total += (double)timings[i].ns;
+  n = cmark_ext_timings_get(&ext_timings);
+  fprintf(stderr, "%-14s %-24s %10s %14s %6s\n", "extension", "callback", "count", "ns",
+          "share");
+  for (i = 0; i < n; i++) {
+    fprintf(stderr, "%-14s %-24s %10lu %14.0f %5.1f%%\n", ext_timings[i].name,
+            cmark_ext_callback_name(ext_timings[i].callback),
+            (unsigned long)ext_timings[i].count, (double)ext_timings[i].ns,
+            total > 0 ? 100 * (double)ext_timings[i].ns / total : 0);
+  }
+}
+
 static void print_extensions(void) {
   cmark_llist *syntax_extensions;
   cmark_llist *tmp;
@@ -104,14 +238,554 @@ static void print_extensions(void) {
   cmark_llist_free(mem, syntax_extensions);
 }
 
+static char *read_whole_file(FILE *fp, size_t *len) {
+  size_t size = 65536, bytes;
+  char *data = (char *)malloc(size);
+
+  *len = 0;
+  if (!data)
+    return NULL;
+  while ((bytes = fread(data + *len, 1, size - *len, fp)) > 0) {
+    *len += bytes;
+    if (*len == size) {
+      char *tmp = (char *)realloc(data, size *= 2);
+      if (!tmp) {
+        free(data);
+        return NULL;
+      }
+      data = tmp;
+    }
+  }
+  if (ferror(fp)) {
+    free(data);
+    return NULL;
+  }
+  return data;
+}
+
+static bool feed_whole_file(cmark_parser *parser, FILE *fp) {
+  size_t len;
+  char *data = read_whole_file(fp, &len);
+
+  if (!data)
+    return false;
+  cmark_parser_feed(parser, data, len);
+  free(data);
+  return true;
+}
+
+static bool emit_ast(cmark_node *document, cmark_mem *mem) {
+  size_t len;
+  unsigned char *data = cmark_ast_save(document, &len, mem);
+  bool ok;
+
+  if (!data) {
+    fprintf(stderr, "Cannot save the AST of this document\n");
+    return false;
+  }
+  ok = fwrite(data, 1, len, stdout) == len;
+  mem->free(data);
+  return ok;
+}
+
+// Maps a file into memory where mmap is available, or else reads it whole.
+// Returns NULL and sets errno on failure.
+static char *map_file(const char *path, size_t *len) {
+#ifdef _WIN32
+  FILE *fp = fopen(path, "rb");
+  char *data;
+
+  if (!fp)
+    return NULL;
+  data = read_whole_file(fp, len);
+  fclose(fp);
+  return data;
+#else
+  struct stat st;
+  void *data;
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0)
+    return NULL;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return NULL;
+  }
+  *len = (size_t)st.st_size;
+  // mmap refuses empty files
+  data = *len ? mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0) : (void *)"";
+  close(fd);
+  return data == MAP_FAILED ? NULL : (char *)data;
+#endif
+}
+
+static void unmap_file(char *data, size_t len) {
+#ifdef _WIN32
+  (void)len;
+  free(data);
+#else
+  if (len)
+    munmap(data, len);
+#endif
+}
+
+// Loads a tree from 'path', which is mapped rather than copied, or from
+// stdin when 'path' is NULL
+static cmark_node *load_ast(const char *path, cmark_mem *mem) {
+  size_t len;
+  char *data = path ? map_file(path, &len) : read_whole_file(stdin, &len);
+  cmark_node *document;
+
+  if (!data) {
+    fprintf(stderr, "Error reading file %s: %s\n", path ? path : "stdin",
+            strerror(errno));
+    return NULL;
+  }
+  document = cmark_ast_load((unsigned char *)data, len, mem);
+  if (!document)
+    fprintf(stderr, "Invalid or incompatible AST in %s\n", path ? path : "stdin");
+  if (path)
+    unmap_file(data, len);
+  else
+    free(data);
+  return document;
+}
+
+static int make_dir(const char *path) {
+#ifdef _WIN32
+  return _mkdir(path);
+#else
+  return mkdir(path, 0777);
+#endif
+}
+
+// Creates the directories in `path` up to the last slash, like mkdir -p.
+static void make_parent_dirs(char *path) {
+  char *p;
+
+  for (p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+    *p = '\0';
+    make_dir(path);
+    *p = '/';
+  }
+}
+
+// The output of `path` keeps its relative path below `out_dir`, with the
+// suffix of the format. Creates the directories on the way, and returns
+// NULL for paths that would end up outside of `out_dir`.
+static char *batch_out_path(const char *out_dir, const char *path,
+                            writer_format writer) {
+  const char *suffix = format_suffixes[writer], *base, *dot, *p;
+  size_t len;
+  char *out;
+
+  while (*path == '/' || (path[0] == '.' && path[1] == '/'))
+    path += *path == '/' ? 1 : 2;
+  for (p = path; (p = strstr(p, "..")) != NULL; p += 2) {
+    if ((p == path || p[-1] == '/' || p[-1] == '\\') &&
+        (p[2] == '\0' || p[2] == '/' || p[2] == '\\'))
+      return NULL;
+  }
+  base = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+  dot = strrchr(base, '.');
+  len = dot && dot != base ? (size_t)(dot - path) : strlen(path);
+
+  out = (char *)malloc(strlen(out_dir) + len + strlen(suffix) + 3);
+  if (!out)
+    return NULL;
+  sprintf(out, "%s/%.*s.%s", out_dir, (int)len, path, suffix);
+  make_parent_dirs(out);
+  return out;
+}
+
+typedef struct {
+  const char *path;
+  size_t bytes;
+  uint64_t ns;
+  const char *error;
+  int error_number;
+} batch_file;
+
+static void batch_fail(batch_file *file, const char *error) {
+  file->error = error;
+  file->error_number = errno;
+}
+
+static void batch_render(batch_file *file, const char *out_dir, cmark_llist *exts,
+                         int options, writer_format writer, int width) {
+  cmark_parser *parser;
+  cmark_node *document;
+  cmark_llist *tmp;
+  char *data, *out_path, *result;
+  size_t len;
+  FILE *fp;
+  uint64_t start = cmark_timer_now();
+
+  errno = 0;
+  if ((out_path = batch_out_path(out_dir, file->path, writer)) == NULL) {
+    batch_fail(file, "No output path for");
+    return;
+  }
+  if ((data = map_file(file->path, &len)) == NULL) {
+    batch_fail(file, "Error reading file");
+    free(out_path);
+    return;
+  }
+  file->bytes = len;
+  // the arena allocator is not thread-safe
+  parser = cmark_parser_new(options);
+  for (tmp = exts; tmp; tmp = tmp->next)
+    cmark_parser_attach_syntax_extension(parser, (cmark_syntax_extension *)tmp->data);
+  cmark_parser_feed(parser, data, len);
+  document = cmark_parser_finish(parser);
+  unmap_file(data, len);
+  result = render_document(document, writer, options, width, parser, 1,
+                           parser->mem);
+
+  if ((fp = fopen(out_path, "wb")) == NULL) {
+    batch_fail(file, "Error writing output of");
+  } else {
+    if (fputs(result, fp) < 0 || (writer == FORMAT_TEXT && fputc('\n', fp) < 0))
+      batch_fail(file, "Error writing output of");
+    if (fclose(fp) != 0 && !file->error)
+      batch_fail(file, "Error writing output of");
+  }
+
+  free(out_path);
+  parser->mem->free(result);
+  cmark_node_free(document);
+  cmark_parser_free(parser);
+  file->ns = cmark_timer_now() - start;
+}
+
+// Renders every file on its own, `jobs` at a time, and prints the time
+// spent on each file to stderr.
+static bool batch(char *argv[], int *files, int numfps, int jobs, const char *out_dir,
+                  cmark_llist *exts, int options, writer_format writer, int width) {
+  batch_file *results = (batch_file *)calloc(numfps, sizeof(*results));
+  uint64_t start = cmark_timer_now(), total = 0, bytes = 0;
+  int i, failed = 0;
+
+  char *dir = (char *)malloc(strlen(out_dir) + 2);
+
+  if (!results || !dir) {
+    free(results);
+    free(dir);
+    return false;
+  }
+  sprintf(dir, "%s/", out_dir);
+  make_parent_dirs(dir);
+  free(dir);
+  if (make_dir(out_dir) != 0 && errno != EEXIST) {
+    fprintf(stderr, "Error creating directory %s: %s\n", out_dir, strerror(errno));
+    free(results);
+    return false;
+  }
+  for (i = 0; i < numfps; i++)
+    results[i].path = argv[files[i]];
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(jobs)
+#endif
+  for (i = 0; i < numfps; i++)
+    batch_render(&results[i], out_dir, exts, options, writer, width);
+
+  fprintf(stderr, "%12s %12s  %s\n", "ms", "bytes", "file");
+  for (i = 0; i < numfps; i++) {
+    if (results[i].error) {
+      fprintf(stderr, "%s %s: %s\n", results[i].error, results[i].path,
+              results[i].error_number ? strerror(results[i].error_number) : "invalid path");
+      failed++;
+      continue;
+    }
+    fprintf(stderr, "%12.3f %12lu  %s\n", (double)results[i].ns / 1e6,
+            (unsigned long)results[i].bytes, results[i].path);
+    total += results[i].ns;
+    bytes += results[i].bytes;
+  }
+  fprintf(stderr, "%d files, %d failed, %.0f bytes, %.3f ms in total, %.3f ms elapsed\n",
+          numfps, failed, (double)bytes, (double)total / 1e6,
+          (double)(cmark_timer_now() - start) / 1e6);
+
+  free(results);
+  return failed == 0;
+}
+
+#define SERVE_MAX_EXTENSIONS 32
+// Longest markdown of a single request, 256MB
+#define SERVE_MAX_LENGTH (1UL << 28)
+
+typedef struct {
+  int options;
+  writer_format writer;
+  int width;
+  int num_exts;
+  cmark_syntax_extension *exts[SERVE_MAX_EXTENSIONS];
+} serve_config;
+
+// The parser of the previous request, kept as long as the next requests ask
+// for the same options and extensions.
+typedef struct {
+  cmark_parser *parser;
+  int options;
+  int num_exts;
+  cmark_syntax_extension *exts[SERVE_MAX_EXTENSIONS];
+} serve_cache;
+
+static bool serve_add_extension(serve_config *config, const char *name) {
+  cmark_syntax_extension *ext;
+  int i;
+
+  if (strcmp(name, "footnotes") == 0) {
+    config->options |= CMARK_OPT_FOOTNOTES;
+    return true;
+  }
+  if ((ext = cmark_find_syntax_extension(name)) == NULL)
+    return false;
+  for (i = 0; i < config->num_exts; i++) {
+    if (config->exts[i] == ext)
+      return true;
+  }
+  if (config->num_exts == SERVE_MAX_EXTENSIONS)
+    return false;
+  config->exts[config->num_exts++] = ext;
+  return true;
+}
+
+// Applies the options of a request header on top of the ones the server was
+// started with. Returns false with a message in `err` if one is invalid.
+static bool serve_parse_header(char *args, serve_config *config, char *err,
+                               size_t err_size) {
+  char *arg, *next, *unparsed;
+  int flag;
+
+  for (arg = strtok(args, " \t\r\n"); arg; arg = strtok(NULL, " \t\r\n")) {
+    if ((flag = find_option_flag(arg)) != 0) {
+      config->options |= flag;
+      continue;
+    }
+    if (strcmp(arg, "-t") && strcmp(arg, "--to") && strcmp(arg, "-e") &&
+        strcmp(arg, "--extension") && strcmp(arg, "--width")) {
+      snprintf(err, err_size, "Unknown option %s", arg);
+      return false;
+    }
+    if ((next = strtok(NULL, " \t\r\n")) == NULL) {
+      snprintf(err, err_size, "No argument provided for %s", arg);
+      return false;
+    }
+    if (strcmp(arg, "--width") == 0) {
+      config->width = (int)strtol(next, &unparsed, 10);
+      if (*unparsed) {
+        snprintf(err, err_size, "failed parsing width '%s'", next);
+        return false;
+      }
+    } else if (strcmp(arg, "-t") == 0 || strcmp(arg, "--to") == 0) {
+      if ((config->writer = find_format(next)) == FORMAT_NONE) {
+        snprintf(err, err_size, "Unknown format %s", next);
+        return false;
+      }
+    } else if (!serve_add_extension(config, next)) {
+      snprintf(err, err_size, "Unknown extension %s", next);
+      return false;
+    }
+  }
+  return true;
+}
+
+static cmark_parser *serve_parser(serve_cache *cache, const serve_config *config) {
+  int i;
+
+  if (cache->parser && cache->options == config->options &&
+      cache->num_exts == config->num_exts &&
+      memcmp(cache->exts, config->exts, config->num_exts * sizeof(config->exts[0])) == 0)
+    return cache->parser;
+
+  if (cache->parser)
+    cmark_parser_free(cache->parser);
+  cache->parser = cmark_parser_new(config->options);
+  for (i = 0; i < config->num_exts; i++)
+    cmark_parser_attach_syntax_extension(cache->parser, config->exts[i]);
+  cache->options = config->options;
+  cache->num_exts = config->num_exts;
+  memcpy(cache->exts, config->exts, sizeof(cache->exts));
+  return cache->parser;
+}
+
+static bool serve_reply(FILE *out, const char *status, const char *data, size_t len) {
+  if (fprintf(out, "%s %lu\n", status, (unsigned long)len) < 0 ||
+      fwrite(data, 1, len, out) != len)
+    return false;
+  return fflush(out) == 0;
+}
+
+// Reads past the markdown of a request which is not served, so that the
+// next request can be found
+static bool serve_skip(FILE *in, unsigned long len) {
+  char buffer[4096];
+  size_t bytes;
+
+  while (len > 0) {
+    bytes = fread(buffer, 1, len < sizeof(buffer) ? len : sizeof(buffer), in);
+    if (bytes == 0)
+      return false;
+    len -= bytes;
+  }
+  return true;
+}
+
+// Serves requests until the end of `in`. Every request is a header line with
+// the length of the markdown in bytes, optionally followed by options like on
+// the command line ("12 -t xml --smart -e table"), and then the markdown
+// itself. Every response is a line "ok LENGTH" or "error LENGTH", followed by
+// the output or the error message. The parser is reused across requests with
+// the same options and extensions.
+static bool serve(FILE *in, FILE *out, const serve_config *base) {
+  char header[4096], err[256];
+  char *body = NULL, *args, *result;
+  size_t size = 0;
+  unsigned long len;
+  serve_cache cache;
+  serve_config config;
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_node *document;
+  bool ok = true;
+
+  memset(&cache, 0, sizeof(cache));
+  while (fgets(header, sizeof(header), in)) {
+    len = strtoul(header, &args, 10);
+    // strtoul() would also take spaces and a sign
+    if (header[0] < '0' || header[0] > '9' || !strchr(args, '\n')) {
+      // without the length the next request cannot be found
+      snprintf(err, sizeof(err), "Invalid request header");
+      serve_reply(out, "error", err, strlen(err));
+      ok = false;
+      break;
+    }
+    err[0] = '\0';
+    if (len > SERVE_MAX_LENGTH) {
+      snprintf(err, sizeof(err), "Request of %lu bytes is longer than the maximum of %lu",
+               len, SERVE_MAX_LENGTH);
+    } else if (len + 1 > size) {
+      char *tmp = (char *)realloc(body, len + 1);
+      if (tmp) {
+        body = tmp;
+        size = len + 1;
+      } else {
+        snprintf(err, sizeof(err), "Out of memory for a request of %lu bytes", len);
+      }
+    }
+    if (err[0]) {
+      if (!serve_reply(out, "error", err, strlen(err)) || !serve_skip(in, len)) {
+        ok = false;
+        break;
+      }
+      continue;
+    }
+    if (fread(body, 1, len, in) != len) {
+      fprintf(stderr, "Request shorter than its length %lu\n", len);
+      ok = false;
+      break;
+    }
+
+    config = *base;
+    if (!serve_parse_header(args, &config, err, sizeof(err))) {
+      if (!serve_reply(out, "error", err, strlen(err))) {
+        ok = false;
+        break;
+      }
+      continue;
+    }
+
+    cmark_parser *parser = serve_parser(&cache, &config);
+    cmark_parser_feed(parser, body, len);
+    document = cmark_parser_finish(parser);
+    result = render_document(document, config.writer, config.options,
+                             config.width, parser, 1, mem);
+    cmark_node_free(document);
+    ok = serve_reply(out, "ok", result, strlen(result));
+    mem->free(result);
+    if (!ok)
+      break;
+  }
+
+  if (cache.parser)
+    cmark_parser_free(cache.parser);
+  free(body);
+  return ok && !ferror(in);
+}
+
+#ifndef _WIN32
+// Serves the connections to a Unix socket at `path` one after the other.
+static bool serve_socket(const char *path, const serve_config *base) {
+  struct sockaddr_un addr;
+  struct stat st;
+  int fd, conn;
+
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    return false;
+  }
+  // a socket left over by an earlier server, but never a regular file
+  if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    unlink(path);
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+      bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+    fprintf(stderr, "Error listening on %s: %s\n", path, strerror(errno));
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+  // a client that goes away must not end the server
+  signal(SIGPIPE, SIG_IGN);
+
+  while ((conn = accept(fd, NULL, NULL)) >= 0 || errno == EINTR) {
+    FILE *in, *out;
+    int conn_out;
+
+    if (conn < 0)
+      continue;
+    if ((conn_out = dup(conn)) < 0) {
+      close(conn);
+      continue;
+    }
+    in = fdopen(conn, "rb");
+    out = fdopen(conn_out, "wb");
+    if (in && out)
+      serve(in, out, base);
+    if (in)
+      fclose(in);
+    else
+      close(conn);
+    if (out)
+      fclose(out);
+    else
+      close(conn_out);
+  }
+  fprintf(stderr, "Error accepting on %s: %s\n", path, strerror(errno));
+  close(fd);
+  return false;
+}
+#endif
+
 int main(int argc, char *argv[]) {
-  int i, numfps = 0;
+  int i, flag, numfps = 0;
   int *files;
   char buffer[4096];
   cmark_parser *parser = NULL;
   size_t bytes;
   cmark_node *document = NULL;
   int width = 0;
+  int num_threads = 1;
+  bool mem_stats = false;
+  int timings = 0;
+  bool emit = false, from_ast = false, serving = false, batch_mode = false;
+  const char *socket_path = NULL, *out_dir = NULL;
+  int jobs = 1;
+  cmark_mem *render_mem = cmark_get_default_mem_allocator();
   char *unparsed;
   writer_format writer = FORMAT_HTML;
   int options = CMARK_OPT_DEFAULT | CMARK_OPT_STRIKETHROUGH_DOUBLE_TILDE;
@@ -134,28 +808,64 @@ int main(int argc, char *argv[]) {
     } else if (strcmp(argv[i], "--list-extensions") == 0) {
       print_extensions();
       goto success;
-    } else if (strcmp(argv[i], "--full-info-string") == 0) {
-      options |= CMARK_OPT_FULL_INFO_STRING;
-    } else if (strcmp(argv[i], "--table-prefer-style-attributes") == 0) {
-      options |= CMARK_OPT_TABLE_PREFER_STYLE_ATTRIBUTES;
-    } else if (strcmp(argv[i], "--strikethrough-double-tilde") == 0) {
-      options |= CMARK_OPT_STRIKETHROUGH_DOUBLE_TILDE;
-    } else if (strcmp(argv[i], "--sourcepos") == 0) {
-      options |= CMARK_OPT_SOURCEPOS;
-    } else if (strcmp(argv[i], "--hardbreaks") == 0) {
-      options |= CMARK_OPT_HARDBREAKS;
-    } else if (strcmp(argv[i], "--nobreaks") == 0) {
-      options |= CMARK_OPT_NOBREAKS;
-    } else if (strcmp(argv[i], "--smart") == 0) {
-      options |= CMARK_OPT_SMART;
-    } else if (strcmp(argv[i], "--github-pre-lang") == 0) {
-      options |= CMARK_OPT_GITHUB_PRE_LANG;
-    } else if (strcmp(argv[i], "--unsafe") == 0) {
-      options |= CMARK_OPT_UNSAFE;
-    } else if (strcmp(argv[i], "--validate-utf8") == 0) {
-      options |= CMARK_OPT_VALIDATE_UTF8;
-    } else if (strcmp(argv[i], "--liberal-html-tag") == 0) {
-      options |= CMARK_OPT_LIBERAL_HTML_TAG;
+    } else if ((flag = find_option_flag(argv[i])) != 0) {
+      options |= flag;
+    } else if (strcmp(argv[i], "--mem-stats") == 0) {
+      mem_stats = true;
+    } else if (strcmp(argv[i], "--timings") == 0) {
+      if (!cmark_timings_available()) {
+        fprintf(stderr, "--timings requires a build with -DCMARK_TIMINGS\n");
+        goto failure;
+      }
+      timings |= CMARK_TIMINGS_PHASES;
+    } else if (strcmp(argv[i], "--ext-timings") == 0) {
+      if (!cmark_timings_available()) {
+        fprintf(stderr, "--ext-timings requires a build with -DCMARK_TIMINGS\n");
+        goto failure;
+      }
+      timings |= CMARK_TIMINGS_PHASES | CMARK_TIMINGS_EXTENSIONS;
+    } else if (strcmp(argv[i], "--emit-ast") == 0) {
+      emit = true;
+    } else if (strcmp(argv[i], "--from-ast") == 0) {
+      from_ast = true;
+    } else if (strcmp(argv[i], "--batch") == 0) {
+      batch_mode = true;
+    } else if (strcmp(argv[i], "--out-dir") == 0) {
+      i += 1;
+      if (i < argc) {
+        out_dir = argv[i];
+      } else {
+        fprintf(stderr, "--out-dir requires an argument\n");
+        goto failure;
+      }
+    } else if ((strcmp(argv[i], "-j") == 0) || (strcmp(argv[i], "--jobs") == 0)) {
+      i += 1;
+      if (i < argc) {
+        jobs = (int)strtol(argv[i], &unparsed, 10);
+        if ((unparsed && strlen(unparsed) > 0) || jobs < 1) {
+          fprintf(stderr, "failed parsing jobs '%s'\n", argv[i]);
+          goto failure;
+        }
+      } else {
+        fprintf(stderr, "%s requires an argument\n", argv[i - 1]);
+        goto failure;
+      }
+    } else if (strcmp(argv[i], "--serve") == 0) {
+      serving = true;
+    } else if (strcmp(argv[i], "--socket") == 0) {
+      i += 1;
+      if (i < argc) {
+#ifdef _WIN32
+        fprintf(stderr, "--socket is not supported on Windows\n");
+        goto failure;
+#else
+        serving = true;
+        socket_path = argv[i];
+#endif
+      } else {
+        fprintf(stderr, "--socket requires an argument\n");
+        goto failure;
+      }
     } else if ((strcmp(argv[i], "--help") == 0) ||
                (strcmp(argv[i], "-h") == 0)) {
       print_usage();
@@ -173,22 +883,23 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "--width requires an argument\n");
         goto failure;
       }
+    } else if (strcmp(argv[i], "--threads") == 0) {
+      i += 1;
+      if (i < argc) {
+        num_threads = (int)strtol(argv[i], &unparsed, 10);
+        if ((unparsed && strlen(unparsed) > 0) || num_threads < 1) {
+          fprintf(stderr, "failed parsing threads '%s'\n", argv[i]);
+          goto failure;
+        }
+      } else {
+        fprintf(stderr, "--threads requires an argument\n");
+        goto failure;
+      }
     } else if ((strcmp(argv[i], "-t") == 0) || (strcmp(argv[i], "--to") == 0)) {
       i += 1;
       if (i < argc) {
-        if (strcmp(argv[i], "man") == 0) {
-          writer = FORMAT_MAN;
-        } else if (strcmp(argv[i], "html") == 0) {
-          writer = FORMAT_HTML;
-        } else if (strcmp(argv[i], "xml") == 0) {
-          writer = FORMAT_XML;
-        } else if (strcmp(argv[i], "commonmark") == 0) {
-          writer = FORMAT_COMMONMARK;
-        } else if (strcmp(argv[i], "plaintext") == 0) {
-          writer = FORMAT_PLAINTEXT;
-        } else if (strcmp(argv[i], "latex") == 0) {
-          writer = FORMAT_LATEX;
-        } else {
+        writer = find_format(argv[i]);
+        if (writer == FORMAT_NONE) {
           fprintf(stderr, "Unknown format %s\n", argv[i]);
           goto failure;
         }
@@ -211,11 +922,36 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  // phases are only timed outside of parallel regions, so the batch
+  // threads would record nothing
+  if (timings && batch_mode && jobs > 1) {
+    fprintf(stderr, "--timings and --ext-timings require --jobs 1 with --batch\n");
+    goto failure;
+  }
+
+  if (timings) {
+    cmark_timings_reset();
+    cmark_timings_enable(timings);
+  }
+
+  if (mem_stats) {
+    // count the default allocator: the arena never frees
+    render_mem = cmark_get_counting_mem_allocator(cmark_get_default_mem_allocator());
+    cmark_mem_stats_reset();
+    parser = cmark_parser_new_with_mem(options, render_mem);
+  } else {
 #if DEBUG
-  parser = cmark_parser_new(options);
+    parser = cmark_parser_new(options);
 #else
-  parser = cmark_parser_new_with_mem(options, cmark_get_arena_mem_allocator());
+    // the arena allocator is not thread-safe, and the table extension
+    // expects every parser to use it once it is in use
+    if (num_threads > 1 || serving || batch_mode)
+      parser = cmark_parser_new(options);
+    else
+      parser = cmark_parser_new_with_mem(options, cmark_get_arena_mem_allocator());
 #endif
+  }
+  cmark_parser_set_num_threads(parser, num_threads);
 
   for (i = 1; i < argc; i++) {
     if ((strcmp(argv[i], "-e") == 0) || (strcmp(argv[i], "--extension") == 0)) {
@@ -237,7 +973,50 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  for (i = 0; i < numfps; i++) {
+  if (batch_mode) {
+    if (!out_dir) {
+      fprintf(stderr, "--batch requires --out-dir\n");
+      goto failure;
+    }
+    if (!batch(argv, files, numfps, jobs, out_dir, parser->syntax_extensions,
+               options, writer, width))
+      goto failure;
+    goto success;
+  }
+
+  if (serving) {
+    serve_config base;
+    cmark_llist *tmp;
+
+    memset(&base, 0, sizeof(base));
+    base.options = options;
+    base.writer = writer;
+    base.width = width;
+    for (tmp = parser->syntax_extensions; tmp; tmp = tmp->next)
+      serve_add_extension(&base, ((cmark_syntax_extension *)tmp->data)->name);
+#ifndef _WIN32
+    if (socket_path) {
+      if (!serve_socket(socket_path, &base))
+        goto failure;
+      goto success;
+    }
+#endif
+    if (!serve(stdin, stdout, &base))
+      goto failure;
+    goto success;
+  }
+
+  if (from_ast) {
+    if (numfps > 1) {
+      fprintf(stderr, "--from-ast takes a single file\n");
+      goto failure;
+    }
+    document = load_ast(numfps ? argv[files[0]] : NULL, parser->mem);
+    if (!document)
+      goto failure;
+  }
+
+  for (i = 0; !from_ast && i < numfps; i++) {
     FILE *fp = fopen(argv[files[i]], "rb");
     if (fp == NULL) {
       fprintf(stderr, "Error opening file %s: %s\n", argv[files[i]],
@@ -245,17 +1024,26 @@ int main(int argc, char *argv[]) {
       goto failure;
     }
 
-    while ((bytes = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
-      cmark_parser_feed(parser, buffer, bytes);
-      if (bytes < sizeof(buffer)) {
-        break;
+    if (num_threads > 1) {
+      // the parser can only split the input if it gets it in one piece
+      if (!feed_whole_file(parser, fp)) {
+        fprintf(stderr, "Error reading file %s\n", argv[files[i]]);
+        fclose(fp);
+        goto failure;
+      }
+    } else {
+      while ((bytes = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        cmark_parser_feed(parser, buffer, bytes);
+        if (bytes < sizeof(buffer)) {
+          break;
+        }
       }
     }
 
     fclose(fp);
   }
 
-  if (numfps == 0) {
+  if (!from_ast && numfps == 0) {
     while ((bytes = fread(buffer, 1, sizeof(buffer), stdin)) > 0) {
       cmark_parser_feed(parser, buffer, bytes);
       if (bytes < sizeof(buffer)) {
@@ -264,9 +1052,14 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  document = cmark_parser_finish(parser);
+  if (!from_ast)
+    document = cmark_parser_finish(parser);
 
-  if (!document || !print_document(document, writer, options, width, parser))
+  if (emit) {
+    if (!document || !emit_ast(document, render_mem))
+      goto failure;
+  } else if (!document || !print_document(document, writer, options, width, parser, num_threads,
+                                    render_mem))
     goto failure;
 
 success:
@@ -281,9 +1074,22 @@ failure:
   if (document)
     cmark_node_free(document);
 #else
+  if (num_threads > 1 || mem_stats || serving || batch_mode) {
+    if (parser)
+      cmark_parser_free(parser);
+    if (document)
+      cmark_node_free(document);
+  }
   cmark_arena_reset();
 #endif
 
+  if (mem_stats)
+    print_mem_stats();
+  if (timings)
+    print_timings();
+  if (timings & CMARK_TIMINGS_EXTENSIONS)
+    print_ext_timings();
+
   cmark_release_plugins();
 
   free(files);
@@ -10,6 +10,7 @@
 #include "utf8.h"
 #include "render.h"
 #include "syntax_extension.h"
+#include "timings.h"
 
 #define OUT(s, wrap, escaping) renderer->out(renderer, node, s, wrap, escaping)
 #define LIT(s) renderer->out(renderer, node, s, false, LITERAL)
@@ -80,7 +81,9 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
   bool allow_wrap = renderer->width > 0 && !(CMARK_OPT_NOBREAKS & options);
 
   if (node->extension && node->extension->man_render_func) {
+    CMARK_EXT_TIMER_START(timer);
     node->extension->man_render_func(node->extension, renderer, node, ev_type, options);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_MAN_RENDER);
     return 1;
   }
 
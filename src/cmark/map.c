@@ -71,6 +71,38 @@ static void sort_map(cmark_map *map) {
   map->size = last + 1;
 }
 
+void cmark_map_sort(cmark_map *map) {
+  if (map != NULL && map->size && !map->sorted)
+    sort_map(map);
+}
+
+void cmark_map_append(cmark_map *map, cmark_map *other) {
+  cmark_map_entry *ref, *last = NULL;
+
+  assert(other->sorted == NULL);
+
+  // sorting dropped duplicates from the count, the next lookup sorts again
+  if (map->sorted) {
+    map->mem->free(map->sorted);
+    map->sorted = NULL;
+    map->size = 0;
+    for (ref = map->refs; ref; ref = ref->next)
+      map->size++;
+  }
+
+  for (ref = other->refs; ref; ref = ref->next) {
+    ref->age += map->size;
+    last = ref;
+  }
+  if (last) {
+    last->next = map->refs;
+    map->refs = other->refs;
+  }
+  map->size += other->size;
+  other->refs = NULL;
+  other->size = 0;
+}
+
 cmark_map_entry *cmark_map_lookup(cmark_map *map, cmark_chunk *label) {
   cmark_map_entry **ref = NULL;
   unsigned char *norm;
@@ -34,6 +34,11 @@ unsigned char *normalize_map_label(cmark_mem *mem, cmark_chunk *ref);
 cmark_map *cmark_map_new(cmark_mem *mem, cmark_map_free_f free);
 void cmark_map_free(cmark_map *map);
 cmark_map_entry *cmark_map_lookup(cmark_map *map, cmark_chunk *label);
+/* Sort the map up front, after which lookups no longer modify it */
+void cmark_map_sort(cmark_map *map);
+/* Move the entries of 'other' to 'map', as if they were added after the
+ * existing entries. 'other' may not have been sorted yet. */
+void cmark_map_append(cmark_map *map, cmark_map *other);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "cmark-gfm.h"
+#include "mem_stats.h"
+
+cmark_mem_site cmark_mem_current_site = CMARK_MEM_SITE_OTHER;
+
+// A single instance: the cmark_mem callbacks take no context to find a
+// base allocator or counters of their own.
+static cmark_mem *base_mem = NULL;
+static cmark_mem_stats stats;
+
+// Every block is prefixed with its size and site, so that realloc and
+// free can update the counters. The union keeps the payload aligned.
+typedef union {
+  struct {
+    size_t size;
+    cmark_mem_site site;
+  } h;
+  long double ld;
+  void *ptr;
+} mem_header;
+
+static void count_alloc(cmark_mem_site site, size_t size) {
+  size_t live;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+  stats.calls[site]++;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+  stats.bytes[site] += size;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+  live = stats.live_bytes += size;
+  if (live > stats.peak_bytes) {
+#ifdef _OPENMP
+#pragma omp critical(cmark_mem_peak)
+#endif
+    if (live > stats.peak_bytes)
+      stats.peak_bytes = live;
+  }
+}
+
+static void count_free(size_t size) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+  stats.live_bytes -= size;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+  stats.frees++;
+}
+
+// The header must fit in front of the block without wrapping its size
+static void check_size(size_t nmem, size_t size) {
+  if (size && nmem > (SIZE_MAX - sizeof(mem_header)) / size) {
+    fprintf(stderr, "[cmark] allocation size overflows, aborting\n");
+    abort();
+  }
+}
+
+static void *counting_calloc(size_t nmem, size_t size) {
+  mem_header *hdr;
+  cmark_mem_site site = cmark_mem_current_site;
+  check_size(nmem, size);
+  hdr = (mem_header *)base_mem->calloc(1, sizeof(mem_header) + nmem * size);
+  if (!hdr)
+    return NULL;
+  hdr->h.size = nmem * size;
+  hdr->h.site = site;
+  count_alloc(site, hdr->h.size);
+  return hdr + 1;
+}
+
+static void *counting_realloc(void *ptr, size_t size) {
+  mem_header *hdr = ptr ? (mem_header *)ptr - 1 : NULL, *tmp;
+  cmark_mem_site site = hdr ? hdr->h.site : cmark_mem_current_site;
+  check_size(1, size);
+  tmp = (mem_header *)base_mem->realloc(hdr, sizeof(mem_header) + size);
+  if (!tmp)
+    return NULL;
+  if (hdr)
+    count_free(tmp->h.size);
+  tmp->h.size = size;
+  tmp->h.site = site;
+  count_alloc(site, size);
+  return tmp + 1;
+}
+
+static void counting_free(void *ptr) {
+  mem_header *hdr;
+  if (!ptr)
+    return;
+  hdr = (mem_header *)ptr - 1;
+  count_free(hdr->h.size);
+  base_mem->free(hdr);
+}
+
+cmark_mem CMARK_COUNTING_MEM_ALLOCATOR = {counting_calloc, counting_realloc, counting_free};
+
+cmark_mem *cmark_get_counting_mem_allocator(cmark_mem *base) {
+  base_mem = base;
+  return &CMARK_COUNTING_MEM_ALLOCATOR;
+}
+
+void cmark_mem_stats_reset(void) {
+  memset(&stats, 0, sizeof(stats));
+}
+
+void cmark_mem_stats_get(cmark_mem_stats *result) {
+  *result = stats;
+}
+
+const char *cmark_mem_site_name(cmark_mem_site site) {
+  switch (site) {
+  case CMARK_MEM_SITE_NODE:
+    return "node";
+  case CMARK_MEM_SITE_STRBUF:
+    return "strbuf";
+  case CMARK_MEM_SITE_CHUNK:
+    return "chunk";
+  case CMARK_MEM_SITE_DELIMITER:
+    return "delimiter";
+  case CMARK_MEM_SITE_EXTENSION:
+    return "extension";
+  default:
+    return "other";
+  }
+}
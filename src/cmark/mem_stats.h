@@ -0,0 +1,40 @@
+#ifndef CMARK_MEM_STATS_H
+#define CMARK_MEM_STATS_H
+
+#include "cmark-gfm.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The allocation site of the next calloc or realloc, for the counting
+// allocator. The cmark_mem callbacks take no context, so it is passed
+// through a (per-thread) global.
+extern cmark_mem_site cmark_mem_current_site;
+#ifdef _OPENMP
+#pragma omp threadprivate(cmark_mem_current_site)
+#endif
+
+static CMARK_INLINE void *cmark_mem_calloc_at(cmark_mem *mem, cmark_mem_site site,
+                                              size_t nmem, size_t size) {
+  void *ptr;
+  cmark_mem_current_site = site;
+  ptr = mem->calloc(nmem, size);
+  cmark_mem_current_site = CMARK_MEM_SITE_OTHER;
+  return ptr;
+}
+
+static CMARK_INLINE void *cmark_mem_realloc_at(cmark_mem *mem, cmark_mem_site site,
+                                               void *ptr, size_t size) {
+  cmark_mem_current_site = site;
+  ptr = mem->realloc(ptr, size);
+  cmark_mem_current_site = CMARK_MEM_SITE_OTHER;
+  return ptr;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
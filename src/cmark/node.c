@@ -3,7 +3,9 @@
 
 #include "config.h"
 #include "node.h"
+#include "parser.h"
 #include "syntax_extension.h"
+#include "timings.h"
 
 #ifdef DEBUG
 #include "cmark_trace.h"
@@ -175,7 +177,10 @@ bool cmark_node_can_contain_type(cmark_node *node, cmark_node_type child_type) {
     }
 
   if (node->extension && node->extension->can_contain_func) {
-    return node->extension->can_contain_func(node->extension, node, child_type) != 0;
+    CMARK_EXT_TIMER_START(timer);
+    bool res = node->extension->can_contain_func(node->extension, node, child_type) != 0;
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_CAN_CONTAIN);
+    return res;
   }
 
   switch (node->type) {
@@ -230,7 +235,7 @@ static bool S_can_contain(cmark_node *node, cmark_node *child) {
 }
 
 cmark_node *cmark_node_new_with_mem_and_ext(cmark_node_type type, cmark_mem *mem, cmark_syntax_extension *extension) {
-  cmark_node *node = (cmark_node *)mem->calloc(1, sizeof(*node));
+  cmark_node *node = (cmark_node *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_NODE, 1, sizeof(*node));
   cmark_strbuf_init(mem, &node->content, 0);
   node->type = (uint16_t)type;
   node->extension = extension;
@@ -253,7 +258,9 @@ cmark_node *cmark_node_new_with_mem_and_ext(cmark_node_type type, cmark_mem *mem
   }
 
   if (node->extension && node->extension->opaque_alloc_func) {
+    CMARK_EXT_TIMER_START(timer);
     node->extension->opaque_alloc_func(node->extension, mem, node);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_OPAQUE_ALLOC);
   }
 
   return node;
@@ -297,6 +304,10 @@ static void free_node_as(cmark_node *node) {
     cmark_chunk_free(NODE_MEM(node), &node->as.custom.on_enter);
     cmark_chunk_free(NODE_MEM(node), &node->as.custom.on_exit);
       break;
+    case CMARK_NODE_DOCUMENT:
+      if (node->as.opaque)
+        cmark_lazy_inlines_free((cmark_parser *)node->as.opaque);
+      break;
     default:
       break;
     }
@@ -311,8 +322,11 @@ static void S_free_nodes(cmark_node *e) {
     if (e->user_data && e->user_data_free_func)
       e->user_data_free_func(NODE_MEM(e), e->user_data);
 
-    if (e->as.opaque && e->extension && e->extension->opaque_free_func)
+    if (e->as.opaque && e->extension && e->extension->opaque_free_func) {
+      CMARK_EXT_TIMER_START(timer);
       e->extension->opaque_free_func(e->extension, NODE_MEM(e), e);
+      CMARK_EXT_TIMER_STOP(timer, e->extension, CMARK_EXT_OPAQUE_FREE);
+    }
 
     free_node_as(e);
 
@@ -333,6 +347,27 @@ void cmark_node_free(cmark_node *node) {
   S_free_nodes(node);
 }
 
+void cmark_node_list_push(cmark_mem *mem, cmark_node_list *list, cmark_node *node) {
+  if (list->len == list->size) {
+    list->size = list->size ? 2 * list->size : 16;
+    list->items = (cmark_node **)mem->realloc(list->items, list->size * sizeof(cmark_node *));
+  }
+  list->items[list->len++] = node;
+}
+
+void cmark_node_list_append(cmark_mem *mem, cmark_node_list *list, cmark_node_list *other) {
+  size_t i;
+  for (i = 0; i < other->len; i++)
+    cmark_node_list_push(mem, list, other->items[i]);
+  other->len = 0;
+}
+
+void cmark_node_list_free(cmark_mem *mem, cmark_node_list *list) {
+  mem->free(list->items);
+  list->items = NULL;
+  list->len = list->size = 0;
+}
+
 cmark_node_type cmark_node_get_type(cmark_node *node) {
   if (node == NULL) {
     return CMARK_NODE_NONE;
@@ -370,7 +405,10 @@ const char *cmark_node_get_type_string(cmark_node *node) {
   }
 
   if (node->extension && node->extension->get_type_string_func) {
-    return node->extension->get_type_string_func(node->extension, node);
+    CMARK_EXT_TIMER_START(timer);
+    const char *res = node->extension->get_type_string_func(node->extension, node);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_GET_TYPE_STRING);
+    return res;
   }
 
   return(decode_node_type(node->type));
@@ -404,6 +442,8 @@ cmark_node *cmark_node_first_child(cmark_node *node) {
   if (node == NULL) {
     return NULL;
   } else {
+    if (node->flags & CMARK_NODE__INLINES_PENDING)
+      cmark_parse_pending_inlines(node);
     return node->first_child;
   }
 }
@@ -412,6 +452,8 @@ cmark_node *cmark_node_last_child(cmark_node *node) {
   if (node == NULL) {
     return NULL;
   } else {
+    if (node->flags & CMARK_NODE__INLINES_PENDING)
+      cmark_parse_pending_inlines(node);
     return node->last_child;
   }
 }
@@ -899,6 +941,7 @@ static void S_node_unlink(cmark_node *node) {
 }
 
 void cmark_node_unlink(cmark_node *node) {
+  cmark_parse_pending_inlines(node);
   S_node_unlink(node);
 
   node->next = NULL;
@@ -915,6 +958,7 @@ int cmark_node_insert_before(cmark_node *node, cmark_node *sibling) {
     return 0;
   }
 
+  cmark_parse_pending_inlines(sibling);
   S_node_unlink(sibling);
 
   cmark_node *old_prev = node->prev;
@@ -948,6 +992,7 @@ int cmark_node_insert_after(cmark_node *node, cmark_node *sibling) {
     return 0;
   }
 
+  cmark_parse_pending_inlines(sibling);
   S_node_unlink(sibling);
 
   cmark_node *old_next = node->next;
@@ -985,6 +1030,7 @@ int cmark_node_prepend_child(cmark_node *node, cmark_node *child) {
     return 0;
   }
 
+  cmark_parse_pending_inlines(child);
   S_node_unlink(child);
 
   cmark_node *old_first_child = node->first_child;
@@ -1009,6 +1055,7 @@ int cmark_node_append_child(cmark_node *node, cmark_node *child) {
     return 0;
   }
 
+  cmark_parse_pending_inlines(child);
   S_node_unlink(child);
 
   cmark_node *old_last_child = node->last_child;
@@ -50,6 +50,9 @@ typedef struct {
 enum cmark_node__internal_flags {
   CMARK_NODE__OPEN = (1 << 0),
   CMARK_NODE__LAST_LINE_BLANK = (1 << 1),
+  CMARK_NODE__INLINES_PENDING = (1 << 2),
+  CMARK_NODE__ENDS_BLANK_CHECKED = (1 << 3),
+  CMARK_NODE__ENDS_BLANK = (1 << 4),
 };
 
 struct cmark_node {
@@ -109,6 +112,17 @@ static CMARK_INLINE bool CMARK_NODE_INLINE_P(cmark_node *node) {
 
 CMARK_GFM_EXPORT bool cmark_node_can_contain_type(cmark_node *node, cmark_node_type child_type);
 
+/* A growable array of nodes, which does not own them. */
+typedef struct {
+  cmark_node **items;
+  size_t len;
+  size_t size;
+} cmark_node_list;
+
+void cmark_node_list_push(cmark_mem *mem, cmark_node_list *list, cmark_node *node);
+void cmark_node_list_append(cmark_mem *mem, cmark_node_list *list, cmark_node_list *other);
+void cmark_node_list_free(cmark_mem *mem, cmark_node_list *list);
+
 #ifdef __cplusplus
 }
 #endif
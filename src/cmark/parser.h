@@ -36,6 +36,8 @@ struct cmark_parser {
   bool blank;
   /* See the documentation for cmark_parser_has_partially_consumed_tab() in cmark.h */
   bool partially_consumed_tab;
+  /* Where the last scan for a thematic break failed on the current line */
+  bufsize_t thematic_break_kill_pos;
   /* Contains the currently processed line */
   cmark_strbuf curline;
   /* See the documentation for cmark_parser_get_last_line_length() in cmark.h */
@@ -48,8 +50,59 @@ struct cmark_parser {
   cmark_llist *syntax_extensions;
   cmark_llist *inline_syntax_extensions;
   cmark_ispunct_func backslash_ispunct;
+  /* See the documentation for cmark_parser_set_num_threads() in cmark.h */
+  int num_threads;
+  /* Number of leaves whose inlines are not parsed yet, see CMARK_OPT_LAZY_INLINES */
+  size_t pending_inlines;
+  /* Reused by the inline parser, allocated on first use */
+  struct cmark_inline_pool *inline_pool;
+  /* Footnote definitions in the order they were closed, see process_footnotes() */
+  cmark_node_list footnote_defs;
+  /* See cmark_parser_set_event_func() in cmark-gfm.h, NULL when building the tree */
+  struct cmark_event_state *events;
+  /* See cmark_parser_set_max_blocks() in cmark-gfm.h, 0 for no limit */
+  int max_blocks;
+  /* Top-level blocks closed so far, and the last one that was counted */
+  int closed_blocks;
+  struct cmark_node *last_counted;
+  /* Set once max_blocks top-level blocks are closed; the rest is ignored */
+  bool stopped;
+  /* See cmark_parser_set_limits() in cmark-gfm.h, and whether any is set */
+  cmark_limits limits;
+  bool has_limits;
+  /* Work counted against the limits, and the cmark_timer_now() at which
+   * max_seconds run out */
+  size_t nodes;
+  size_t ref_bytes;
+  uint64_t deadline;
+  /* Kept after cmark_parser_finish(), until the next document starts */
+  cmark_limit limit_exceeded;
+  /* The inline characters of the core and of the attached extensions, see
+   * cmark_manage_extensions_special_characters(). Kept per parser so that
+   * documents can be parsed on several threads at once. */
+  int8_t special_chars[256];
+  int8_t skip_chars[256];
+  /* How far the table extension has scanned the open paragraph as a header
+   * row, see count_header_cells() in table.c */
+  struct {
+    struct cmark_node *node;
+    int start_line;
+    bufsize_t offset;
+    int n_cells;
+    bool failed;
+  } header_scan;
 };
 
+/* Whether a limit on nodes or time was exceeded, which also stops the
+ * parser. The clock is only read if 'check_time' is set. */
+bool cmark_parser_limit_reached(cmark_parser *parser, bool check_time);
+
+/* With CMARK_OPT_LAZY_INLINES the document holds a copy of the parser without
+ * block state, which owns the reference map. Parses the pending inlines of
+ * node and its descendants. */
+void cmark_parse_pending_inlines(cmark_node *node);
+void cmark_lazy_inlines_free(cmark_parser *lazy);
+
 #ifdef __cplusplus
 }
 #endif
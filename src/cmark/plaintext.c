@@ -1,6 +1,9 @@
 #include "node.h"
 #include "syntax_extension.h"
 #include "render.h"
+#include "timings.h"
+#include "cmark_ctype.h"
+#include "parser.h"
 
 #define OUT(s, wrap, escaping) renderer->out(renderer, node, s, wrap, escaping)
 #define LIT(s) renderer->out(renderer, node, s, false, LITERAL)
@@ -57,7 +60,9 @@ static int S_render_node(cmark_renderer *renderer, cmark_node *node,
   }
 
   if (node->extension && node->extension->plaintext_render_func) {
+    CMARK_EXT_TIMER_START(timer);
     node->extension->plaintext_render_func(node->extension, renderer, node, ev_type, options);
+    CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_PLAINTEXT_RENDER);
     return 1;
   }
 
@@ -233,3 +238,202 @@ char *cmark_render_plaintext_with_mem(cmark_node *root, int options, int width,
   }
   return cmark_render(mem, root, options, width, outc, S_render_node);
 }
+
+// Text extraction without the renderer: separators between blocks and
+// inlines are deferred until more text follows, so there are never
+// leading, trailing or repeated separators.
+typedef enum {
+  SEP_NONE,
+  SEP_SPACE,
+  SEP_LINE,
+  SEP_BLOCK
+} text_separator;
+
+typedef struct {
+  cmark_strbuf *buf;
+  text_separator sep;
+  bool normalize_space;
+  size_t max_len;
+} text_extractor;
+
+// Returns false once the output is full
+static bool S_put_text(text_extractor *te, const unsigned char *data,
+                       bufsize_t len) {
+  bufsize_t i = 0, run;
+
+  while (i < len) {
+    if (te->normalize_space && cmark_isspace(data[i])) {
+      while (i < len && cmark_isspace(data[i]))
+        i++;
+      if (te->sep < SEP_SPACE)
+        te->sep = SEP_SPACE;
+      continue;
+    }
+    run = len - i;
+    if (te->normalize_space) {
+      for (run = 0; i + run < len && !cmark_isspace(data[i + run]); run++)
+        ;
+    }
+    if (te->sep != SEP_NONE && te->buf->size > 0) {
+      if (te->sep == SEP_SPACE)
+        cmark_strbuf_putc(te->buf, ' ');
+      else if (te->sep == SEP_LINE || te->normalize_space)
+        cmark_strbuf_putc(te->buf, '\n');
+      else
+        cmark_strbuf_puts(te->buf, "\n\n");
+    }
+    te->sep = SEP_NONE;
+    cmark_strbuf_put(te->buf, data + i, run);
+    i += run;
+    if (te->max_len && (size_t)te->buf->size >= te->max_len)
+      return false;
+  }
+  return true;
+}
+
+static void S_separate(text_extractor *te, text_separator sep) {
+  if (te->sep < sep)
+    te->sep = sep;
+}
+
+// Table rows are extension blocks inside another extension block, and
+// cells are such blocks holding inlines
+static text_separator S_block_separator(cmark_node *node) {
+  if (!node->extension || !node->parent || !node->parent->extension)
+    return SEP_BLOCK;
+  if (!node->first_child || CMARK_NODE_INLINE_P(node->first_child))
+    return SEP_SPACE;
+  return SEP_LINE;
+}
+
+// Emits a node on entering it; returns false once the output is full
+static bool S_extract_node(text_extractor *te, cmark_node *node) {
+  bufsize_t len;
+
+  switch (node->type) {
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_CODE:
+    return S_put_text(te, node->as.literal.data, node->as.literal.len);
+  case CMARK_NODE_CODE_BLOCK:
+    // the final newline of the literal is a separator here
+    len = node->as.code.literal.len;
+    if (len > 0 && node->as.code.literal.data[len - 1] == '\n')
+      len--;
+    S_separate(te, SEP_BLOCK);
+    return S_put_text(te, node->as.code.literal.data, len);
+  case CMARK_NODE_CUSTOM_INLINE:
+    // extension inlines without children, such as math, keep their
+    // literal in on_exit
+    if (node->extension && !node->first_child)
+      return S_put_text(te, node->as.custom.on_exit.data, node->as.custom.on_exit.len);
+    break;
+  case CMARK_NODE_SOFTBREAK:
+    S_separate(te, te->normalize_space ? SEP_SPACE : SEP_LINE);
+    break;
+  case CMARK_NODE_LINEBREAK:
+    S_separate(te, SEP_LINE);
+    break;
+  default:
+    if (CMARK_NODE_BLOCK_P(node) && node->type != CMARK_NODE_DOCUMENT)
+      S_separate(te, S_block_separator(node));
+    break;
+  }
+  return true;
+}
+
+// Walks the tree by its links rather than with an iterator, which is
+// most of the cost for a pass this light.
+char *cmark_extract_text(cmark_node *root, int normalize_space, size_t max_len,
+                         cmark_mem *mem) {
+  CMARK_TIMER_START(timer);
+  cmark_strbuf buf = CMARK_BUF_INIT(mem);
+  text_extractor te = {&buf, SEP_NONE, normalize_space != 0, max_len};
+  cmark_node *node = root;
+  bufsize_t len;
+
+  while (S_extract_node(&te, node)) {
+    if (node->flags & CMARK_NODE__INLINES_PENDING)
+      cmark_parse_pending_inlines(node);
+    if (node->first_child) {
+      node = node->first_child;
+      continue;
+    }
+    for (;;) {
+      if (node == root)
+        goto done;
+      if (CMARK_NODE_BLOCK_P(node))
+        S_separate(&te, S_block_separator(node));
+      if (node->next)
+        break;
+      node = node->parent;
+    }
+    node = node->next;
+  }
+
+done:
+  if (max_len && (size_t)buf.size > max_len) {
+    len = (bufsize_t)max_len;
+    // do not cut a UTF-8 sequence in half
+    while (len > 0 && (buf.ptr[len] & 0xC0) == 0x80)
+      len--;
+    cmark_strbuf_truncate(&buf, len);
+  }
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_RENDER, NULL);
+  return (char *)cmark_strbuf_detach(&buf);
+}
+
+static cmark_chunk *S_text_literal(cmark_node *node) {
+  switch (node->type) {
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_CODE:
+    return &node->as.literal;
+  case CMARK_NODE_CODE_BLOCK:
+    return &node->as.code.literal;
+  default:
+    return NULL;
+  }
+}
+
+// Takes the characters of a literal off the budget, and cuts it where the
+// budget runs out. Returns true if nothing may follow.
+static bool S_spend_chars(cmark_chunk *literal, size_t *budget) {
+  bufsize_t i;
+
+  for (i = 0; i < literal->len; i++) {
+    if ((literal->data[i] & 0xC0) == 0x80)
+      continue;
+    if (*budget == 0) {
+      literal->len = i;
+      return true;
+    }
+    (*budget)--;
+  }
+  return *budget == 0;
+}
+
+void cmark_node_truncate(cmark_node *root, size_t max_chars) {
+  cmark_node *node = root;
+  cmark_chunk *literal;
+
+  for (;;) {
+    if (node->flags & CMARK_NODE__INLINES_PENDING)
+      cmark_parse_pending_inlines(node);
+    literal = S_text_literal(node);
+    if (literal && S_spend_chars(literal, &max_chars))
+      break;
+    if (node->first_child) {
+      node = node->first_child;
+      continue;
+    }
+    while (node != root && !node->next)
+      node = node->parent;
+    if (node == root)
+      return;
+    node = node->next;
+  }
+
+  for (; node != root; node = node->parent) {
+    while (node->next)
+      cmark_node_free(node->next);
+  }
+}
@@ -6,6 +6,7 @@
 #include "render.h"
 #include "node.h"
 #include "syntax_extension.h"
+#include "timings.h"
 
 #ifdef DEBUG
 #include <cmark_trace.h>
@@ -86,8 +87,13 @@ static void S_out(cmark_renderer *renderer, cmark_node *node,
       return;        // return without rendering rest of string
     }
 
-    if (ext && ext->commonmark_escape_func(ext, node, c))
-      cmark_strbuf_putc(renderer->buffer, '\\');
+    if (ext) {
+      CMARK_EXT_TIMER_START(timer);
+      bool escape = ext->commonmark_escape_func(ext, node, c);
+      CMARK_EXT_TIMER_STOP(timer, ext, CMARK_EXT_COMMONMARK_ESCAPE);
+      if (escape)
+        cmark_strbuf_putc(renderer->buffer, '\\');
+    }
 
     nextc = source[i + len];
     if (c == 32 && wrap) {
@@ -182,6 +188,7 @@ char *cmark_render(cmark_mem *mem, cmark_node *root, int options, int width,
   cmark_event_type ev_type;
   char *result;
   cmark_iter *iter = cmark_iter_new(root);
+  CMARK_TIMER_START(timer);
 
   cmark_renderer renderer = {mem,   &buf, &pref, 0,           width,
                              0,     0,    true,  true,        false,
@@ -209,5 +216,6 @@ char *cmark_render(cmark_mem *mem, cmark_node *root, int options, int width,
   cmark_strbuf_free(renderer.prefix);
   cmark_strbuf_free(renderer.buffer);
 
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_RENDER, NULL);
   return result;
 }
@@ -1,37 +1,42 @@
-/* Generated by re2c 1.0.3 */
+/* Originally generated by re2c 1.0.3 from scanners.re, which is not part of
+ * this tree; the file is now maintained by hand. The generated code was
+ * converted to bounded scanners: each takes (p, end) and reads through
+ * yypeek(), which returns a NUL at 'end' instead of relying on a NUL
+ * sentinel written over the input. Regenerating it from upstream re2c
+ * sources would bring back reads past the end of the buffer, so apply
+ * any change by hand and keep every read going through yypeek(). */
 #include <stdlib.h>
 #include "chunk.h"
 #include "scanners.h"
 
-bufsize_t _scan_at(bufsize_t (*scanner)(const unsigned char *), cmark_chunk *c, bufsize_t offset)
+bufsize_t _scan_at(bufsize_t (*scanner)(const unsigned char *, const unsigned char *),
+                   cmark_chunk *c, bufsize_t offset)
 {
-	bufsize_t res;
-	unsigned char *ptr = (unsigned char *)c->data;
+	const unsigned char *ptr = c->data;
 
-        if (ptr == NULL || offset > c->len) {
-          return 0;
-        } else {
-	  unsigned char lim = ptr[c->len];
+	if (ptr == NULL || offset > c->len)
+	  return 0;
 
-	  ptr[c->len] = '\0';
-	  res = scanner(ptr + offset);
-	  ptr[c->len] = lim;
-        }
-
-	return res;
+	return scanner(ptr + offset, ptr + c->len);
 }
 
-
+// The scanners read their input through yypeek(): at the end of the input
+// it returns a NUL, which none of the patterns accept, so the input is
+// never read past 'end' and does not need to be NUL-terminated.
+static CMARK_INLINE unsigned char yypeek(const unsigned char *p, const unsigned char *end)
+{
+	return p < end ? *p : 0;
+}
 
 // Try to match a scheme including colon.
-bufsize_t _scan_scheme(const unsigned char *p)
+bufsize_t _scan_scheme(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
 {
 	unsigned char yych;
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= '@') goto yy2;
 	if (yych <= 'Z') goto yy4;
 	if (yych <= '`') goto yy2;
@@ -41,7 +46,7 @@ yy2:
 yy3:
 	{ return 0; }
 yy4:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '/') {
 		if (yych <= '+') {
 			if (yych <= '*') goto yy3;
@@ -59,7 +64,7 @@ yy4:
 		}
 	}
 yy5:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych == '+') goto yy7;
@@ -79,7 +84,7 @@ yy6:
 	p = marker;
 	goto yy3;
 yy7:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych == '+') goto yy10;
@@ -103,7 +108,7 @@ yy8:
 	++p;
 	{ return (bufsize_t)(p - start); }
 yy10:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -119,7 +124,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -135,7 +140,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -151,7 +156,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -167,7 +172,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -183,7 +188,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -199,7 +204,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -215,7 +220,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -231,7 +236,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -247,7 +252,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -263,7 +268,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -279,7 +284,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -295,7 +300,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -311,7 +316,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -327,7 +332,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -343,7 +348,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -359,7 +364,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -375,7 +380,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -391,7 +396,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -407,7 +412,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -423,7 +428,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -439,7 +444,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -455,7 +460,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -471,7 +476,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -487,7 +492,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -503,7 +508,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -519,7 +524,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -535,7 +540,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy6;
@@ -551,7 +556,7 @@ yy10:
 			if (yych >= '{') goto yy6;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == ':') goto yy8;
 	goto yy6;
 }
@@ -559,7 +564,7 @@ yy10:
 }
 
 // Try to match URI autolink after first <, returning number of chars matched.
-bufsize_t _scan_autolink_uri(const unsigned char *p)
+bufsize_t _scan_autolink_uri(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -600,7 +605,7 @@ bufsize_t _scan_autolink_uri(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= '@') goto yy41;
 	if (yych <= 'Z') goto yy43;
 	if (yych <= '`') goto yy41;
@@ -610,7 +615,7 @@ yy41:
 yy42:
 	{ return 0; }
 yy43:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '/') {
 		if (yych <= '+') {
 			if (yych <= '*') goto yy42;
@@ -628,7 +633,7 @@ yy43:
 		}
 	}
 yy44:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych == '+') goto yy46;
@@ -648,7 +653,7 @@ yy45:
 	p = marker;
 	goto yy42;
 yy46:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych == '+') goto yy49;
@@ -669,7 +674,7 @@ yy46:
 		}
 	}
 yy47:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy47;
 	}
@@ -695,7 +700,7 @@ yy47:
 		}
 	}
 yy49:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych == '+') goto yy59;
@@ -719,42 +724,42 @@ yy50:
 	++p;
 	{ return (bufsize_t)(p - start); }
 yy52:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy45;
 	if (yych <= 0xBF) goto yy47;
 	goto yy45;
 yy53:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy45;
 	if (yych <= 0xBF) goto yy52;
 	goto yy45;
 yy54:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy45;
 	if (yych <= 0xBF) goto yy52;
 	goto yy45;
 yy55:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy45;
 	if (yych <= 0x9F) goto yy52;
 	goto yy45;
 yy56:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy45;
 	if (yych <= 0xBF) goto yy54;
 	goto yy45;
 yy57:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy45;
 	if (yych <= 0xBF) goto yy54;
 	goto yy45;
 yy58:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy45;
 	if (yych <= 0x8F) goto yy54;
 	goto yy45;
 yy59:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -770,7 +775,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -786,7 +791,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -802,7 +807,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -818,7 +823,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -834,7 +839,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -850,7 +855,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -866,7 +871,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -882,7 +887,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -898,7 +903,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -914,7 +919,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -930,7 +935,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -946,7 +951,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -962,7 +967,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -978,7 +983,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -994,7 +999,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1010,7 +1015,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1026,7 +1031,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1042,7 +1047,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1058,7 +1063,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1074,7 +1079,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1090,7 +1095,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1106,7 +1111,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1122,7 +1127,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1138,7 +1143,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1154,7 +1159,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1170,7 +1175,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych <= ',') {
 			if (yych != '+') goto yy45;
@@ -1186,7 +1191,7 @@ yy59:
 			if (yych >= '{') goto yy45;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == ':') goto yy47;
 	goto yy45;
 }
@@ -1194,7 +1199,7 @@ yy59:
 }
 
 // Try to match email autolink after first <, returning num of chars matched.
-bufsize_t _scan_autolink_email(const unsigned char *p)
+bufsize_t _scan_autolink_email(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -1235,7 +1240,7 @@ bufsize_t _scan_autolink_email(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= '9') {
 		if (yych <= '\'') {
 			if (yych == '!') goto yy91;
@@ -1262,7 +1267,7 @@ yy89:
 yy90:
 	{ return 0; }
 yy91:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= ',') {
 		if (yych <= '"') {
 			if (yych == '!') goto yy93;
@@ -1286,7 +1291,7 @@ yy91:
 		}
 	}
 yy92:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy93:
 	if (yybm[0+yych] & 128) {
 		goto yy92;
@@ -1297,7 +1302,7 @@ yy94:
 	p = marker;
 	goto yy90;
 yy95:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '@') {
 		if (yych <= '/') goto yy94;
 		if (yych >= ':') goto yy94;
@@ -1307,7 +1312,7 @@ yy95:
 		if (yych >= '{') goto yy94;
 	}
 yy96:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1328,7 +1333,7 @@ yy96:
 			goto yy94;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy101;
 		if (yych <= '/') goto yy94;
@@ -1344,7 +1349,7 @@ yy96:
 		}
 	}
 yy98:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1370,7 +1375,7 @@ yy99:
 	++p;
 	{ return (bufsize_t)(p - start); }
 yy101:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy103;
 		if (yych <= '/') goto yy94;
@@ -1386,7 +1391,7 @@ yy101:
 		}
 	}
 yy102:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1408,7 +1413,7 @@ yy102:
 		}
 	}
 yy103:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy105;
 		if (yych <= '/') goto yy94;
@@ -1424,7 +1429,7 @@ yy103:
 		}
 	}
 yy104:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1446,7 +1451,7 @@ yy104:
 		}
 	}
 yy105:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy107;
 		if (yych <= '/') goto yy94;
@@ -1462,7 +1467,7 @@ yy105:
 		}
 	}
 yy106:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1484,7 +1489,7 @@ yy106:
 		}
 	}
 yy107:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy109;
 		if (yych <= '/') goto yy94;
@@ -1500,7 +1505,7 @@ yy107:
 		}
 	}
 yy108:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1522,7 +1527,7 @@ yy108:
 		}
 	}
 yy109:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy111;
 		if (yych <= '/') goto yy94;
@@ -1538,7 +1543,7 @@ yy109:
 		}
 	}
 yy110:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1560,7 +1565,7 @@ yy110:
 		}
 	}
 yy111:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy113;
 		if (yych <= '/') goto yy94;
@@ -1576,7 +1581,7 @@ yy111:
 		}
 	}
 yy112:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1598,7 +1603,7 @@ yy112:
 		}
 	}
 yy113:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy115;
 		if (yych <= '/') goto yy94;
@@ -1614,7 +1619,7 @@ yy113:
 		}
 	}
 yy114:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1636,7 +1641,7 @@ yy114:
 		}
 	}
 yy115:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy117;
 		if (yych <= '/') goto yy94;
@@ -1652,7 +1657,7 @@ yy115:
 		}
 	}
 yy116:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1674,7 +1679,7 @@ yy116:
 		}
 	}
 yy117:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy119;
 		if (yych <= '/') goto yy94;
@@ -1690,7 +1695,7 @@ yy117:
 		}
 	}
 yy118:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1712,7 +1717,7 @@ yy118:
 		}
 	}
 yy119:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy121;
 		if (yych <= '/') goto yy94;
@@ -1728,7 +1733,7 @@ yy119:
 		}
 	}
 yy120:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1750,7 +1755,7 @@ yy120:
 		}
 	}
 yy121:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy123;
 		if (yych <= '/') goto yy94;
@@ -1766,7 +1771,7 @@ yy121:
 		}
 	}
 yy122:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1788,7 +1793,7 @@ yy122:
 		}
 	}
 yy123:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy125;
 		if (yych <= '/') goto yy94;
@@ -1804,7 +1809,7 @@ yy123:
 		}
 	}
 yy124:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1826,7 +1831,7 @@ yy124:
 		}
 	}
 yy125:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy127;
 		if (yych <= '/') goto yy94;
@@ -1842,7 +1847,7 @@ yy125:
 		}
 	}
 yy126:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1864,7 +1869,7 @@ yy126:
 		}
 	}
 yy127:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy129;
 		if (yych <= '/') goto yy94;
@@ -1880,7 +1885,7 @@ yy127:
 		}
 	}
 yy128:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1902,7 +1907,7 @@ yy128:
 		}
 	}
 yy129:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy131;
 		if (yych <= '/') goto yy94;
@@ -1918,7 +1923,7 @@ yy129:
 		}
 	}
 yy130:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1940,7 +1945,7 @@ yy130:
 		}
 	}
 yy131:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy133;
 		if (yych <= '/') goto yy94;
@@ -1956,7 +1961,7 @@ yy131:
 		}
 	}
 yy132:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -1978,7 +1983,7 @@ yy132:
 		}
 	}
 yy133:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy135;
 		if (yych <= '/') goto yy94;
@@ -1994,7 +1999,7 @@ yy133:
 		}
 	}
 yy134:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2016,7 +2021,7 @@ yy134:
 		}
 	}
 yy135:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy137;
 		if (yych <= '/') goto yy94;
@@ -2032,7 +2037,7 @@ yy135:
 		}
 	}
 yy136:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2054,7 +2059,7 @@ yy136:
 		}
 	}
 yy137:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy139;
 		if (yych <= '/') goto yy94;
@@ -2070,7 +2075,7 @@ yy137:
 		}
 	}
 yy138:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2092,7 +2097,7 @@ yy138:
 		}
 	}
 yy139:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy141;
 		if (yych <= '/') goto yy94;
@@ -2108,7 +2113,7 @@ yy139:
 		}
 	}
 yy140:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2130,7 +2135,7 @@ yy140:
 		}
 	}
 yy141:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy143;
 		if (yych <= '/') goto yy94;
@@ -2146,7 +2151,7 @@ yy141:
 		}
 	}
 yy142:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2168,7 +2173,7 @@ yy142:
 		}
 	}
 yy143:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy145;
 		if (yych <= '/') goto yy94;
@@ -2184,7 +2189,7 @@ yy143:
 		}
 	}
 yy144:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2206,7 +2211,7 @@ yy144:
 		}
 	}
 yy145:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy147;
 		if (yych <= '/') goto yy94;
@@ -2222,7 +2227,7 @@ yy145:
 		}
 	}
 yy146:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2244,7 +2249,7 @@ yy146:
 		}
 	}
 yy147:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy149;
 		if (yych <= '/') goto yy94;
@@ -2260,7 +2265,7 @@ yy147:
 		}
 	}
 yy148:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2282,7 +2287,7 @@ yy148:
 		}
 	}
 yy149:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy151;
 		if (yych <= '/') goto yy94;
@@ -2298,7 +2303,7 @@ yy149:
 		}
 	}
 yy150:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2320,7 +2325,7 @@ yy150:
 		}
 	}
 yy151:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy153;
 		if (yych <= '/') goto yy94;
@@ -2336,7 +2341,7 @@ yy151:
 		}
 	}
 yy152:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2358,7 +2363,7 @@ yy152:
 		}
 	}
 yy153:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy155;
 		if (yych <= '/') goto yy94;
@@ -2374,7 +2379,7 @@ yy153:
 		}
 	}
 yy154:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2396,7 +2401,7 @@ yy154:
 		}
 	}
 yy155:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy157;
 		if (yych <= '/') goto yy94;
@@ -2412,7 +2417,7 @@ yy155:
 		}
 	}
 yy156:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2434,7 +2439,7 @@ yy156:
 		}
 	}
 yy157:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy159;
 		if (yych <= '/') goto yy94;
@@ -2450,7 +2455,7 @@ yy157:
 		}
 	}
 yy158:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2472,7 +2477,7 @@ yy158:
 		}
 	}
 yy159:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy161;
 		if (yych <= '/') goto yy94;
@@ -2488,7 +2493,7 @@ yy159:
 		}
 	}
 yy160:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2510,7 +2515,7 @@ yy160:
 		}
 	}
 yy161:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy163;
 		if (yych <= '/') goto yy94;
@@ -2526,7 +2531,7 @@ yy161:
 		}
 	}
 yy162:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2548,7 +2553,7 @@ yy162:
 		}
 	}
 yy163:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy165;
 		if (yych <= '/') goto yy94;
@@ -2564,7 +2569,7 @@ yy163:
 		}
 	}
 yy164:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2586,7 +2591,7 @@ yy164:
 		}
 	}
 yy165:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy167;
 		if (yych <= '/') goto yy94;
@@ -2602,7 +2607,7 @@ yy165:
 		}
 	}
 yy166:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2624,7 +2629,7 @@ yy166:
 		}
 	}
 yy167:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy169;
 		if (yych <= '/') goto yy94;
@@ -2640,7 +2645,7 @@ yy167:
 		}
 	}
 yy168:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2662,7 +2667,7 @@ yy168:
 		}
 	}
 yy169:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy171;
 		if (yych <= '/') goto yy94;
@@ -2678,7 +2683,7 @@ yy169:
 		}
 	}
 yy170:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2700,7 +2705,7 @@ yy170:
 		}
 	}
 yy171:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy173;
 		if (yych <= '/') goto yy94;
@@ -2716,7 +2721,7 @@ yy171:
 		}
 	}
 yy172:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2738,7 +2743,7 @@ yy172:
 		}
 	}
 yy173:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy175;
 		if (yych <= '/') goto yy94;
@@ -2754,7 +2759,7 @@ yy173:
 		}
 	}
 yy174:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2776,7 +2781,7 @@ yy174:
 		}
 	}
 yy175:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy177;
 		if (yych <= '/') goto yy94;
@@ -2792,7 +2797,7 @@ yy175:
 		}
 	}
 yy176:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2814,7 +2819,7 @@ yy176:
 		}
 	}
 yy177:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy179;
 		if (yych <= '/') goto yy94;
@@ -2830,7 +2835,7 @@ yy177:
 		}
 	}
 yy178:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2852,7 +2857,7 @@ yy178:
 		}
 	}
 yy179:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy181;
 		if (yych <= '/') goto yy94;
@@ -2868,7 +2873,7 @@ yy179:
 		}
 	}
 yy180:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2890,7 +2895,7 @@ yy180:
 		}
 	}
 yy181:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy183;
 		if (yych <= '/') goto yy94;
@@ -2906,7 +2911,7 @@ yy181:
 		}
 	}
 yy182:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2928,7 +2933,7 @@ yy182:
 		}
 	}
 yy183:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy185;
 		if (yych <= '/') goto yy94;
@@ -2944,7 +2949,7 @@ yy183:
 		}
 	}
 yy184:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -2966,7 +2971,7 @@ yy184:
 		}
 	}
 yy185:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy187;
 		if (yych <= '/') goto yy94;
@@ -2982,7 +2987,7 @@ yy185:
 		}
 	}
 yy186:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3004,7 +3009,7 @@ yy186:
 		}
 	}
 yy187:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy189;
 		if (yych <= '/') goto yy94;
@@ -3020,7 +3025,7 @@ yy187:
 		}
 	}
 yy188:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3042,7 +3047,7 @@ yy188:
 		}
 	}
 yy189:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy191;
 		if (yych <= '/') goto yy94;
@@ -3058,7 +3063,7 @@ yy189:
 		}
 	}
 yy190:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3080,7 +3085,7 @@ yy190:
 		}
 	}
 yy191:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy193;
 		if (yych <= '/') goto yy94;
@@ -3096,7 +3101,7 @@ yy191:
 		}
 	}
 yy192:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3118,7 +3123,7 @@ yy192:
 		}
 	}
 yy193:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy195;
 		if (yych <= '/') goto yy94;
@@ -3134,7 +3139,7 @@ yy193:
 		}
 	}
 yy194:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3156,7 +3161,7 @@ yy194:
 		}
 	}
 yy195:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy197;
 		if (yych <= '/') goto yy94;
@@ -3172,7 +3177,7 @@ yy195:
 		}
 	}
 yy196:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3194,7 +3199,7 @@ yy196:
 		}
 	}
 yy197:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy199;
 		if (yych <= '/') goto yy94;
@@ -3210,7 +3215,7 @@ yy197:
 		}
 	}
 yy198:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3232,7 +3237,7 @@ yy198:
 		}
 	}
 yy199:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy201;
 		if (yych <= '/') goto yy94;
@@ -3248,7 +3253,7 @@ yy199:
 		}
 	}
 yy200:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3270,7 +3275,7 @@ yy200:
 		}
 	}
 yy201:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy203;
 		if (yych <= '/') goto yy94;
@@ -3286,7 +3291,7 @@ yy201:
 		}
 	}
 yy202:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3308,7 +3313,7 @@ yy202:
 		}
 	}
 yy203:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy205;
 		if (yych <= '/') goto yy94;
@@ -3324,7 +3329,7 @@ yy203:
 		}
 	}
 yy204:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3346,7 +3351,7 @@ yy204:
 		}
 	}
 yy205:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy207;
 		if (yych <= '/') goto yy94;
@@ -3362,7 +3367,7 @@ yy205:
 		}
 	}
 yy206:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3384,7 +3389,7 @@ yy206:
 		}
 	}
 yy207:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy209;
 		if (yych <= '/') goto yy94;
@@ -3400,7 +3405,7 @@ yy207:
 		}
 	}
 yy208:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3422,7 +3427,7 @@ yy208:
 		}
 	}
 yy209:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy211;
 		if (yych <= '/') goto yy94;
@@ -3438,7 +3443,7 @@ yy209:
 		}
 	}
 yy210:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3460,7 +3465,7 @@ yy210:
 		}
 	}
 yy211:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy213;
 		if (yych <= '/') goto yy94;
@@ -3476,7 +3481,7 @@ yy211:
 		}
 	}
 yy212:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3498,7 +3503,7 @@ yy212:
 		}
 	}
 yy213:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy215;
 		if (yych <= '/') goto yy94;
@@ -3514,7 +3519,7 @@ yy213:
 		}
 	}
 yy214:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3536,7 +3541,7 @@ yy214:
 		}
 	}
 yy215:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy217;
 		if (yych <= '/') goto yy94;
@@ -3552,7 +3557,7 @@ yy215:
 		}
 	}
 yy216:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3574,7 +3579,7 @@ yy216:
 		}
 	}
 yy217:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '9') {
 		if (yych == '-') goto yy219;
 		if (yych <= '/') goto yy94;
@@ -3590,7 +3595,7 @@ yy217:
 		}
 	}
 yy218:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= ',') goto yy94;
@@ -3612,7 +3617,7 @@ yy218:
 		}
 	}
 yy219:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '@') {
 		if (yych <= '/') goto yy94;
 		if (yych <= '9') goto yy221;
@@ -3624,7 +3629,7 @@ yy219:
 		goto yy94;
 	}
 yy220:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '=') {
 		if (yych <= '.') {
 			if (yych <= '-') goto yy94;
@@ -3643,7 +3648,7 @@ yy220:
 		}
 	}
 yy221:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '.') goto yy95;
 	if (yych == '>') goto yy99;
 	goto yy94;
@@ -3652,7 +3657,7 @@ yy221:
 }
 
 // Try to match an HTML tag after first <, returning num of chars matched.
-bufsize_t _scan_html_tag(const unsigned char *p)
+bufsize_t _scan_html_tag(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -3727,7 +3732,7 @@ bufsize_t _scan_html_tag(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= '>') {
 		if (yych <= '!') {
 			if (yych >= '!') goto yy226;
@@ -3748,7 +3753,7 @@ yy224:
 yy225:
 	{ return 0; }
 yy226:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[256+yych] & 32) {
 		goto yy232;
 	}
@@ -3757,21 +3762,21 @@ yy226:
 	if (yych <= '[') goto yy234;
 	goto yy225;
 yy227:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '@') goto yy225;
 	if (yych <= 'Z') goto yy235;
 	if (yych <= '`') goto yy225;
 	if (yych <= 'z') goto yy235;
 	goto yy225;
 yy228:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x00) goto yy225;
 	if (yych <= 0x7F) goto yy238;
 	if (yych <= 0xC1) goto yy225;
 	if (yych <= 0xF4) goto yy238;
 	goto yy225;
 yy229:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '.') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy225;
@@ -3795,13 +3800,13 @@ yy229:
 		}
 	}
 yy230:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '-') goto yy254;
 yy231:
 	p = marker;
 	goto yy225;
 yy232:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[256+yych] & 32) {
 		goto yy232;
 	}
@@ -3810,12 +3815,12 @@ yy232:
 	if (yych == ' ') goto yy255;
 	goto yy231;
 yy234:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy257;
 	if (yych == 'c') goto yy257;
 	goto yy231;
 yy235:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[256+yych] & 64) {
 		goto yy235;
 	}
@@ -3829,7 +3834,7 @@ yy235:
 		goto yy231;
 	}
 yy237:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy238:
 	if (yybm[256+yych] & 128) {
 		goto yy237;
@@ -3854,7 +3859,7 @@ yy238:
 			goto yy231;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0xE0) {
 		if (yych <= '>') {
 			if (yych <= 0x00) goto yy231;
@@ -3877,42 +3882,42 @@ yy238:
 		}
 	}
 yy240:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy237;
 	goto yy231;
 yy241:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy240;
 	goto yy231;
 yy242:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy240;
 	goto yy231;
 yy243:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy240;
 	goto yy231;
 yy244:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy242;
 	goto yy231;
 yy245:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy242;
 	goto yy231;
 yy246:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy242;
 	goto yy231;
 yy247:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 1) {
 		goto yy247;
 	}
@@ -3937,7 +3942,7 @@ yy247:
 		}
 	}
 yy249:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy250:
 	if (yybm[0+yych] & 1) {
 		goto yy247;
@@ -3963,18 +3968,18 @@ yy250:
 		}
 	}
 yy251:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych != '>') goto yy231;
 yy252:
 	++p;
 	{ return (bufsize_t)(p - start); }
 yy254:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '-') goto yy264;
 	if (yych == '>') goto yy231;
 	goto yy263;
 yy255:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 2) {
 		goto yy255;
 	}
@@ -4000,12 +4005,12 @@ yy255:
 		}
 	}
 yy257:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy279;
 	if (yych == 'd') goto yy279;
 	goto yy231;
 yy258:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych <= 0x08) goto yy231;
 		if (yych <= '\r') goto yy258;
@@ -4016,7 +4021,7 @@ yy258:
 		goto yy231;
 	}
 yy260:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 4) {
 		goto yy260;
 	}
@@ -4039,7 +4044,7 @@ yy260:
 		}
 	}
 yy262:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy263:
 	if (yybm[0+yych] & 8) {
 		goto yy262;
@@ -4066,87 +4071,87 @@ yy263:
 		}
 	}
 yy264:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '-') goto yy251;
 	if (yych == '>') goto yy231;
 	goto yy263;
 yy265:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy262;
 	goto yy231;
 yy266:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy265;
 	goto yy231;
 yy267:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy265;
 	goto yy231;
 yy268:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy265;
 	goto yy231;
 yy269:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy267;
 	goto yy231;
 yy270:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy267;
 	goto yy231;
 yy271:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy267;
 	goto yy231;
 yy272:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy255;
 	goto yy231;
 yy273:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy272;
 	goto yy231;
 yy274:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy272;
 	goto yy231;
 yy275:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy272;
 	goto yy231;
 yy276:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy274;
 	goto yy231;
 yy277:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy274;
 	goto yy231;
 yy278:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy274;
 	goto yy231;
 yy279:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy285;
 	if (yych == 'a') goto yy285;
 	goto yy231;
 yy280:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '<') {
 		if (yych <= ' ') {
 			if (yych <= 0x08) goto yy231;
@@ -4180,7 +4185,7 @@ yy280:
 		}
 	}
 yy282:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy286;
 	}
@@ -4207,7 +4212,7 @@ yy282:
 		}
 	}
 yy284:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 8) {
 		goto yy262;
 	}
@@ -4233,12 +4238,12 @@ yy284:
 		}
 	}
 yy285:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy299;
 	if (yych == 't') goto yy299;
 	goto yy231;
 yy286:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy286;
 	}
@@ -4265,7 +4270,7 @@ yy286:
 		}
 	}
 yy288:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy288;
 	}
@@ -4291,7 +4296,7 @@ yy288:
 		}
 	}
 yy290:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy290;
 	}
@@ -4317,47 +4322,47 @@ yy290:
 		}
 	}
 yy292:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy286;
 	goto yy231;
 yy293:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy292;
 	goto yy231;
 yy294:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy292;
 	goto yy231;
 yy295:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy292;
 	goto yy231;
 yy296:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy294;
 	goto yy231;
 yy297:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy294;
 	goto yy231;
 yy298:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy294;
 	goto yy231;
 yy299:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy315;
 	if (yych == 'a') goto yy315;
 	goto yy231;
 yy300:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 1) {
 		goto yy247;
 	}
@@ -4365,80 +4370,80 @@ yy300:
 	if (yych == '>') goto yy252;
 	goto yy231;
 yy301:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy288;
 	goto yy231;
 yy302:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy301;
 	goto yy231;
 yy303:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy301;
 	goto yy231;
 yy304:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy301;
 	goto yy231;
 yy305:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy303;
 	goto yy231;
 yy306:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy303;
 	goto yy231;
 yy307:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy303;
 	goto yy231;
 yy308:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy290;
 	goto yy231;
 yy309:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy308;
 	goto yy231;
 yy310:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy308;
 	goto yy231;
 yy311:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy308;
 	goto yy231;
 yy312:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy310;
 	goto yy231;
 yy313:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy310;
 	goto yy231;
 yy314:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy310;
 	goto yy231;
 yy315:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych != '[') goto yy231;
 yy316:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy316;
 	}
@@ -4462,7 +4467,7 @@ yy316:
 			goto yy231;
 		}
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy316;
 	}
@@ -4488,42 +4493,42 @@ yy316:
 		}
 	}
 yy319:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy316;
 	goto yy231;
 yy320:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy231;
 	if (yych <= 0xBF) goto yy319;
 	goto yy231;
 yy321:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy319;
 	goto yy231;
 yy322:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x9F) goto yy319;
 	goto yy231;
 yy323:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy231;
 	if (yych <= 0xBF) goto yy321;
 	goto yy231;
 yy324:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0xBF) goto yy321;
 	goto yy231;
 yy325:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy231;
 	if (yych <= 0x8F) goto yy321;
 	goto yy231;
 yy326:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0xE0) {
 		if (yych <= '>') {
 			if (yych <= 0x00) goto yy231;
@@ -4551,7 +4556,7 @@ yy326:
 }
 
 // Try to (liberally) match an HTML tag after first <, returning num of chars matched.
-bufsize_t _scan_liberal_html_tag(const unsigned char *p)
+bufsize_t _scan_liberal_html_tag(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -4593,7 +4598,7 @@ bufsize_t _scan_liberal_html_tag(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= 0xE0) {
 		if (yych <= '\n') {
 			if (yych <= 0x00) goto yy329;
@@ -4620,7 +4625,7 @@ yy330:
 	{ return 0; }
 yy331:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '\n') {
 		if (yych <= 0x00) goto yy330;
 		if (yych <= '\t') goto yy340;
@@ -4633,48 +4638,48 @@ yy331:
 	}
 yy332:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy330;
 	if (yych <= 0xBF) goto yy339;
 	goto yy330;
 yy333:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x9F) goto yy330;
 	if (yych <= 0xBF) goto yy345;
 	goto yy330;
 yy334:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy330;
 	if (yych <= 0xBF) goto yy345;
 	goto yy330;
 yy335:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy330;
 	if (yych <= 0x9F) goto yy345;
 	goto yy330;
 yy336:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x8F) goto yy330;
 	if (yych <= 0xBF) goto yy347;
 	goto yy330;
 yy337:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy330;
 	if (yych <= 0xBF) goto yy347;
 	goto yy330;
 yy338:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy330;
 	if (yych <= 0x8F) goto yy347;
 	goto yy330;
 yy339:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy340:
 	if (yybm[0+yych] & 64) {
 		goto yy339;
@@ -4707,7 +4712,7 @@ yy341:
 	}
 yy342:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy339;
 	}
@@ -4733,37 +4738,37 @@ yy342:
 yy344:
 	{ return (bufsize_t)(p - start); }
 yy345:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy341;
 	if (yych <= 0xBF) goto yy339;
 	goto yy341;
 yy346:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy341;
 	if (yych <= 0xBF) goto yy345;
 	goto yy341;
 yy347:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy341;
 	if (yych <= 0xBF) goto yy345;
 	goto yy341;
 yy348:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy341;
 	if (yych <= 0x9F) goto yy345;
 	goto yy341;
 yy349:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy341;
 	if (yych <= 0xBF) goto yy347;
 	goto yy341;
 yy350:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy341;
 	if (yych <= 0xBF) goto yy347;
 	goto yy341;
 yy351:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy341;
 	if (yych <= 0x8F) goto yy347;
 	goto yy341;
@@ -4774,19 +4779,19 @@ yy351:
 // Try to match an HTML block tag start line, returning
 // an integer code for the type of block (1-6, matching the spec).
 // #7 is handled by a separate function, below.
-bufsize_t _scan_html_block_start(const unsigned char *p)
+bufsize_t _scan_html_block_start(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
 
 {
 	unsigned char yych;
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '<') goto yy356;
 	++p;
 yy355:
 	{ return 0; }
 yy356:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	switch (yych) {
 	case '!':	goto yy357;
 	case '/':	goto yy359;
@@ -4824,7 +4829,7 @@ yy356:
 	default:	goto yy355;
 	}
 yy357:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '@') {
 		if (yych == '-') goto yy377;
 	} else {
@@ -4835,7 +4840,7 @@ yy358:
 	p = marker;
 	goto yy355;
 yy359:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	switch (yych) {
 	case 'A':
 	case 'a':	goto yy362;
@@ -4873,7 +4878,7 @@ yy360:
 	++p;
 	{ return 3; }
 yy362:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'S') {
 		if (yych <= 'D') {
 			if (yych <= 'C') goto yy358;
@@ -4894,7 +4899,7 @@ yy362:
 		}
 	}
 yy363:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'O') {
 		if (yych <= 'K') {
 			if (yych == 'A') goto yy386;
@@ -4915,7 +4920,7 @@ yy363:
 		}
 	}
 yy364:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'O') {
 		if (yych <= 'D') {
 			if (yych == 'A') goto yy389;
@@ -4936,7 +4941,7 @@ yy364:
 		}
 	}
 yy365:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	switch (yych) {
 	case 'D':
 	case 'L':
@@ -4951,7 +4956,7 @@ yy365:
 	default:	goto yy358;
 	}
 yy366:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'R') {
 		if (yych <= 'N') {
 			if (yych == 'I') goto yy395;
@@ -4972,7 +4977,7 @@ yy366:
 		}
 	}
 yy367:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'S') {
 		if (yych <= 'D') {
 			if (yych <= '0') goto yy358;
@@ -4995,12 +5000,12 @@ yy367:
 		}
 	}
 yy368:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'F') goto yy400;
 	if (yych == 'f') goto yy400;
 	goto yy358;
 yy369:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'I') {
 		if (yych == 'E') goto yy401;
 		if (yych <= 'H') goto yy358;
@@ -5015,7 +5020,7 @@ yy369:
 		}
 	}
 yy370:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'E') {
 		if (yych == 'A') goto yy403;
 		if (yych <= 'D') goto yy358;
@@ -5030,7 +5035,7 @@ yy370:
 		}
 	}
 yy371:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'O') {
 		if (yych == 'A') goto yy405;
 		if (yych <= 'N') goto yy358;
@@ -5045,7 +5050,7 @@ yy371:
 		}
 	}
 yy372:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'P') {
 		if (yych == 'L') goto yy392;
 		if (yych <= 'O') goto yy358;
@@ -5060,7 +5065,7 @@ yy372:
 		}
 	}
 yy373:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '>') {
 		if (yych <= ' ') {
 			if (yych <= 0x08) goto yy358;
@@ -5088,7 +5093,7 @@ yy373:
 		}
 	}
 yy374:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	switch (yych) {
 	case 'C':
 	case 'c':	goto yy413;
@@ -5103,7 +5108,7 @@ yy374:
 	default:	goto yy358;
 	}
 yy375:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	switch (yych) {
 	case 'A':
 	case 'a':	goto yy418;
@@ -5122,24 +5127,24 @@ yy375:
 	default:	goto yy358;
 	}
 yy376:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy392;
 	if (yych == 'l') goto yy392;
 	goto yy358;
 yy377:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '-') goto yy424;
 	goto yy358;
 yy378:
 	++p;
 	{ return 4; }
 yy380:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy426;
 	if (yych == 'c') goto yy426;
 	goto yy358;
 yy381:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5161,7 +5166,7 @@ yy381:
 		}
 	}
 yy382:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'U') {
 		if (yych <= 'N') {
 			if (yych == 'E') goto yy414;
@@ -5182,52 +5187,52 @@ yy382:
 		}
 	}
 yy383:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy427;
 	if (yych == 'd') goto yy427;
 	goto yy358;
 yy384:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy428;
 	if (yych == 't') goto yy428;
 	goto yy358;
 yy385:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy429;
 	if (yych == 'i') goto yy429;
 	goto yy358;
 yy386:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'S') goto yy430;
 	if (yych == 's') goto yy430;
 	goto yy358;
 yy387:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy431;
 	if (yych == 'o') goto yy431;
 	goto yy358;
 yy388:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy432;
 	if (yych == 'd') goto yy432;
 	goto yy358;
 yy389:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'P') goto yy433;
 	if (yych == 'p') goto yy433;
 	goto yy358;
 yy390:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'N') goto yy434;
 	if (yych == 'n') goto yy434;
 	goto yy358;
 yy391:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy435;
 	if (yych == 'l') goto yy435;
 	goto yy358;
 yy392:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ' ') {
 		if (yych <= 0x08) goto yy358;
 		if (yych <= '\r') goto yy408;
@@ -5243,12 +5248,12 @@ yy392:
 		}
 	}
 yy393:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy436;
 	if (yych == 't') goto yy436;
 	goto yy358;
 yy394:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'V') {
 		if (yych <= 'Q') {
 			if (yych == 'A') goto yy437;
@@ -5269,7 +5274,7 @@ yy394:
 		}
 	}
 yy395:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'G') {
 		if (yych == 'E') goto yy438;
 		if (yych <= 'F') goto yy358;
@@ -5284,7 +5289,7 @@ yy395:
 		}
 	}
 yy396:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'R') {
 		if (yych == 'O') goto yy434;
 		if (yych <= 'Q') goto yy358;
@@ -5299,32 +5304,32 @@ yy396:
 		}
 	}
 yy397:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy441;
 	if (yych == 'a') goto yy441;
 	goto yy358;
 yy398:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy442;
 	if (yych == 'a') goto yy442;
 	goto yy358;
 yy399:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy376;
 	if (yych == 'm') goto yy376;
 	goto yy358;
 yy400:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy443;
 	if (yych == 'r') goto yy443;
 	goto yy358;
 yy401:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'G') goto yy444;
 	if (yych == 'g') goto yy444;
 	goto yy358;
 yy402:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5346,27 +5351,27 @@ yy402:
 		}
 	}
 yy403:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy446;
 	if (yych == 'i') goto yy446;
 	goto yy358;
 yy404:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'N') goto yy447;
 	if (yych == 'n') goto yy447;
 	goto yy358;
 yy405:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'V') goto yy392;
 	if (yych == 'v') goto yy392;
 	goto yy358;
 yy406:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'F') goto yy448;
 	if (yych == 'f') goto yy448;
 	goto yy358;
 yy407:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy449;
 	if (yych == 't') goto yy449;
 	goto yy358;
@@ -5374,61 +5379,61 @@ yy408:
 	++p;
 	{ return 6; }
 yy410:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '>') goto yy408;
 	goto yy358;
 yy411:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy450;
 	if (yych == 'r') goto yy450;
 	goto yy358;
 yy412:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy451;
 	if (yych == 'e') goto yy451;
 	goto yy358;
 yy413:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy452;
 	if (yych == 'r') goto yy452;
 	goto yy358;
 yy414:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy433;
 	if (yych == 'c') goto yy433;
 	goto yy358;
 yy415:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'U') goto yy453;
 	if (yych == 'u') goto yy453;
 	goto yy358;
 yy416:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'Y') goto yy454;
 	if (yych == 'y') goto yy454;
 	goto yy358;
 yy417:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy455;
 	if (yych == 'm') goto yy455;
 	goto yy358;
 yy418:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'B') goto yy456;
 	if (yych == 'b') goto yy456;
 	goto yy358;
 yy419:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy388;
 	if (yych == 'o') goto yy388;
 	goto yy358;
 yy420:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy457;
 	if (yych == 'o') goto yy457;
 	goto yy358;
 yy421:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5450,12 +5455,12 @@ yy421:
 		}
 	}
 yy422:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy456;
 	if (yych == 't') goto yy456;
 	goto yy358;
 yy423:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5480,52 +5485,52 @@ yy424:
 	++p;
 	{ return 2; }
 yy426:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy460;
 	if (yych == 'd') goto yy460;
 	goto yy358;
 yy427:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy461;
 	if (yych == 'r') goto yy461;
 	goto yy358;
 yy428:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy462;
 	if (yych == 'i') goto yy462;
 	goto yy358;
 yy429:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy463;
 	if (yych == 'd') goto yy463;
 	goto yy358;
 yy430:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy464;
 	if (yych == 'e') goto yy464;
 	goto yy358;
 yy431:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy465;
 	if (yych == 'c') goto yy465;
 	goto yy358;
 yy432:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'Y') goto yy392;
 	if (yych == 'y') goto yy392;
 	goto yy358;
 yy433:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy466;
 	if (yych == 't') goto yy466;
 	goto yy358;
 yy434:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy467;
 	if (yych == 't') goto yy467;
 	goto yy358;
 yy435:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5547,22 +5552,22 @@ yy435:
 		}
 	}
 yy436:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy469;
 	if (yych == 'a') goto yy469;
 	goto yy358;
 yy437:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy470;
 	if (yych == 'l') goto yy470;
 	goto yy358;
 yy438:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy471;
 	if (yych == 'l') goto yy471;
 	goto yy358;
 yy439:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'U') {
 		if (yych == 'C') goto yy472;
 		if (yych <= 'T') goto yy358;
@@ -5577,52 +5582,52 @@ yy439:
 		}
 	}
 yy440:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy392;
 	if (yych == 'm') goto yy392;
 	goto yy358;
 yy441:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy474;
 	if (yych == 'm') goto yy474;
 	goto yy358;
 yy442:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy475;
 	if (yych == 'd') goto yy475;
 	goto yy358;
 yy443:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy476;
 	if (yych == 'a') goto yy476;
 	goto yy358;
 yy444:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy477;
 	if (yych == 'e') goto yy477;
 	goto yy358;
 yy445:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'K') goto yy392;
 	if (yych == 'k') goto yy392;
 	goto yy358;
 yy446:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'N') goto yy392;
 	if (yych == 'n') goto yy392;
 	goto yy358;
 yy447:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'U') goto yy478;
 	if (yych == 'u') goto yy478;
 	goto yy358;
 yy448:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy479;
 	if (yych == 'r') goto yy479;
 	goto yy358;
 yy449:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'I') {
 		if (yych == 'G') goto yy468;
 		if (yych <= 'H') goto yy358;
@@ -5637,12 +5642,12 @@ yy449:
 		}
 	}
 yy450:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy440;
 	if (yych == 'a') goto yy440;
 	goto yy358;
 yy451:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych <= 0x08) goto yy358;
 		if (yych <= '\r') goto yy481;
@@ -5653,67 +5658,67 @@ yy451:
 		goto yy358;
 	}
 yy452:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy483;
 	if (yych == 'i') goto yy483;
 	goto yy358;
 yy453:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy484;
 	if (yych == 'r') goto yy484;
 	goto yy358;
 yy454:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy412;
 	if (yych == 'l') goto yy412;
 	goto yy358;
 yy455:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy485;
 	if (yych == 'm') goto yy485;
 	goto yy358;
 yy456:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy463;
 	if (yych == 'l') goto yy463;
 	goto yy358;
 yy457:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy486;
 	if (yych == 'o') goto yy486;
 	goto yy358;
 yy458:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy487;
 	if (yych == 'a') goto yy487;
 	goto yy358;
 yy459:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy445;
 	if (yych == 'c') goto yy445;
 	goto yy358;
 yy460:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy488;
 	if (yych == 'a') goto yy488;
 	goto yy358;
 yy461:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy489;
 	if (yych == 'e') goto yy489;
 	goto yy358;
 yy462:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy456;
 	if (yych == 'c') goto yy456;
 	goto yy358;
 yy463:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy392;
 	if (yych == 'e') goto yy392;
 	goto yy358;
 yy464:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5735,57 +5740,57 @@ yy464:
 		}
 	}
 yy465:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'K') goto yy491;
 	if (yych == 'k') goto yy491;
 	goto yy358;
 yy466:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy480;
 	if (yych == 'i') goto yy480;
 	goto yy358;
 yy467:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy492;
 	if (yych == 'e') goto yy492;
 	goto yy358;
 yy468:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy493;
 	if (yych == 'r') goto yy493;
 	goto yy358;
 yy469:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy494;
 	if (yych == 'i') goto yy494;
 	goto yy358;
 yy470:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy495;
 	if (yych == 'o') goto yy495;
 	goto yy358;
 yy471:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy496;
 	if (yych == 'd') goto yy496;
 	goto yy358;
 yy472:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy389;
 	if (yych == 'a') goto yy389;
 	goto yy358;
 yy473:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy463;
 	if (yych == 'r') goto yy463;
 	goto yy358;
 yy474:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy497;
 	if (yych == 'e') goto yy497;
 	goto yy358;
 yy475:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5807,17 +5812,17 @@ yy475:
 		}
 	}
 yy476:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy463;
 	if (yych == 'm') goto yy463;
 	goto yy358;
 yy477:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'N') goto yy487;
 	if (yych == 'n') goto yy487;
 	goto yy358;
 yy478:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5839,12 +5844,12 @@ yy478:
 		}
 	}
 yy479:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy499;
 	if (yych == 'a') goto yy499;
 	goto yy358;
 yy480:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy446;
 	if (yych == 'o') goto yy446;
 	goto yy358;
@@ -5852,77 +5857,77 @@ yy481:
 	++p;
 	{ return 1; }
 yy483:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'P') goto yy500;
 	if (yych == 'p') goto yy500;
 	goto yy358;
 yy484:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy463;
 	if (yych == 'c') goto yy463;
 	goto yy358;
 yy485:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy501;
 	if (yych == 'a') goto yy501;
 	goto yy358;
 yy486:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy392;
 	if (yych == 't') goto yy392;
 	goto yy358;
 yy487:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'D') goto yy392;
 	if (yych == 'd') goto yy392;
 	goto yy358;
 yy488:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy502;
 	if (yych == 't') goto yy502;
 	goto yy358;
 yy489:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'S') goto yy503;
 	if (yych == 's') goto yy503;
 	goto yy358;
 yy490:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy504;
 	if (yych == 'o') goto yy504;
 	goto yy358;
 yy491:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'Q') goto yy505;
 	if (yych == 'q') goto yy505;
 	goto yy358;
 yy492:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy392;
 	if (yych == 'r') goto yy392;
 	goto yy358;
 yy493:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy506;
 	if (yych == 'o') goto yy506;
 	goto yy358;
 yy494:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy503;
 	if (yych == 'l') goto yy503;
 	goto yy358;
 yy495:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'G') goto yy392;
 	if (yych == 'g') goto yy392;
 	goto yy358;
 yy496:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'S') goto yy507;
 	if (yych == 's') goto yy507;
 	goto yy358;
 yy497:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy358;
@@ -5944,76 +5949,76 @@ yy497:
 		}
 	}
 yy498:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy508;
 	if (yych == 't') goto yy508;
 	goto yy358;
 yy499:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy509;
 	if (yych == 'm') goto yy509;
 	goto yy358;
 yy500:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy451;
 	if (yych == 't') goto yy451;
 	goto yy358;
 yy501:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy432;
 	if (yych == 'r') goto yy432;
 	goto yy358;
 yy502:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy510;
 	if (yych == 'a') goto yy510;
 	goto yy358;
 yy503:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'S') goto yy392;
 	if (yych == 's') goto yy392;
 	goto yy358;
 yy504:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'N') goto yy486;
 	if (yych == 'n') goto yy486;
 	goto yy358;
 yy505:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'U') goto yy511;
 	if (yych == 'u') goto yy511;
 	goto yy358;
 yy506:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'U') goto yy512;
 	if (yych == 'u') goto yy512;
 	goto yy358;
 yy507:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy486;
 	if (yych == 'e') goto yy486;
 	goto yy358;
 yy508:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy440;
 	if (yych == 'e') goto yy440;
 	goto yy358;
 yy509:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy503;
 	if (yych == 'e') goto yy503;
 	goto yy358;
 yy510:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == '[') goto yy513;
 	goto yy358;
 yy511:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'O') goto yy515;
 	if (yych == 'o') goto yy515;
 	goto yy358;
 yy512:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'P') goto yy392;
 	if (yych == 'p') goto yy392;
 	goto yy358;
@@ -6021,7 +6026,7 @@ yy513:
 	++p;
 	{ return 5; }
 yy515:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy463;
 	if (yych == 't') goto yy463;
 	goto yy358;
@@ -6031,7 +6036,7 @@ yy515:
 
 // Try to match an HTML block tag start line of type 7, returning
 // 7 if successful, 0 if not.
-bufsize_t _scan_html_block_start_7(const unsigned char *p)
+bufsize_t _scan_html_block_start_7(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
 
@@ -6072,14 +6077,14 @@ bufsize_t _scan_html_block_start_7(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '<') goto yy520;
 	++p;
 yy519:
 	{ return 0; }
 yy520:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '@') {
 		if (yych != '/') goto yy519;
 	} else {
@@ -6088,7 +6093,7 @@ yy520:
 		if (yych <= 'z') goto yy523;
 		goto yy519;
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '@') goto yy522;
 	if (yych <= 'Z') goto yy525;
 	if (yych <= '`') goto yy522;
@@ -6101,7 +6106,7 @@ yy522:
 		goto yy538;
 	}
 yy523:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 2) {
 		goto yy527;
 	}
@@ -6126,7 +6131,7 @@ yy523:
 		}
 	}
 yy525:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') {
 		if (yych <= 0x1F) {
 			if (yych <= 0x08) goto yy522;
@@ -6150,7 +6155,7 @@ yy525:
 		}
 	}
 yy527:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 2) {
 		goto yy527;
 	}
@@ -6174,10 +6179,10 @@ yy527:
 		}
 	}
 yy529:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych != '>') goto yy522;
 yy530:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 4) {
 		goto yy530;
 	}
@@ -6187,7 +6192,7 @@ yy530:
 	if (yych <= '\r') goto yy539;
 	goto yy522;
 yy532:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych <= 0x08) goto yy522;
 		if (yych <= '\r') goto yy532;
@@ -6198,7 +6203,7 @@ yy532:
 		goto yy522;
 	}
 yy534:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 8) {
 		goto yy534;
 	}
@@ -6222,7 +6227,7 @@ yy534:
 	}
 yy536:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 4) {
 		goto yy530;
 	}
@@ -6236,7 +6241,7 @@ yy539:
 	++p;
 	goto yy538;
 yy540:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '<') {
 		if (yych <= ' ') {
 			if (yych <= 0x08) goto yy522;
@@ -6270,7 +6275,7 @@ yy540:
 		}
 	}
 yy542:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy544;
 	}
@@ -6297,7 +6302,7 @@ yy542:
 		}
 	}
 yy544:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy544;
 	}
@@ -6324,7 +6329,7 @@ yy544:
 		}
 	}
 yy546:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy546;
 	}
@@ -6350,7 +6355,7 @@ yy546:
 		}
 	}
 yy548:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy548;
 	}
@@ -6376,42 +6381,42 @@ yy548:
 		}
 	}
 yy550:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy544;
 	goto yy522;
 yy551:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy522;
 	if (yych <= 0xBF) goto yy550;
 	goto yy522;
 yy552:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy550;
 	goto yy522;
 yy553:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0x9F) goto yy550;
 	goto yy522;
 yy554:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy522;
 	if (yych <= 0xBF) goto yy552;
 	goto yy522;
 yy555:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy552;
 	goto yy522;
 yy556:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0x8F) goto yy552;
 	goto yy522;
 yy557:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 2) {
 		goto yy527;
 	}
@@ -6419,72 +6424,72 @@ yy557:
 	if (yych == '>') goto yy530;
 	goto yy522;
 yy558:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy546;
 	goto yy522;
 yy559:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy522;
 	if (yych <= 0xBF) goto yy558;
 	goto yy522;
 yy560:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy558;
 	goto yy522;
 yy561:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0x9F) goto yy558;
 	goto yy522;
 yy562:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy522;
 	if (yych <= 0xBF) goto yy560;
 	goto yy522;
 yy563:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy560;
 	goto yy522;
 yy564:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0x8F) goto yy560;
 	goto yy522;
 yy565:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy548;
 	goto yy522;
 yy566:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy522;
 	if (yych <= 0xBF) goto yy565;
 	goto yy522;
 yy567:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy565;
 	goto yy522;
 yy568:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0x9F) goto yy565;
 	goto yy522;
 yy569:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy522;
 	if (yych <= 0xBF) goto yy567;
 	goto yy522;
 yy570:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0xBF) goto yy567;
 	goto yy522;
 yy571:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy522;
 	if (yych <= 0x8F) goto yy567;
 	goto yy522;
@@ -6493,7 +6498,7 @@ yy571:
 }
 
 // Try to match an HTML block end line of type 1
-bufsize_t _scan_html_block_end_1(const unsigned char *p)
+bufsize_t _scan_html_block_end_1(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -6535,7 +6540,7 @@ bufsize_t _scan_html_block_end_1(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= 0xDF) {
 		if (yych <= ';') {
 			if (yych <= 0x00) goto yy574;
@@ -6562,7 +6567,7 @@ yy575:
 	{ return 0; }
 yy576:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '\n') {
 		if (yych <= 0x00) goto yy575;
 		if (yych <= '\t') goto yy586;
@@ -6575,7 +6580,7 @@ yy576:
 	}
 yy577:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '.') {
 		if (yych <= 0x00) goto yy575;
 		if (yych == '\n') goto yy575;
@@ -6592,48 +6597,48 @@ yy577:
 	}
 yy578:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy575;
 	if (yych <= 0xBF) goto yy585;
 	goto yy575;
 yy579:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x9F) goto yy575;
 	if (yych <= 0xBF) goto yy590;
 	goto yy575;
 yy580:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy575;
 	if (yych <= 0xBF) goto yy590;
 	goto yy575;
 yy581:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy575;
 	if (yych <= 0x9F) goto yy590;
 	goto yy575;
 yy582:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x8F) goto yy575;
 	if (yych <= 0xBF) goto yy592;
 	goto yy575;
 yy583:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy575;
 	if (yych <= 0xBF) goto yy592;
 	goto yy575;
 yy584:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy575;
 	if (yych <= 0x8F) goto yy592;
 	goto yy575;
 yy585:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy586:
 	if (yybm[0+yych] & 64) {
 		goto yy585;
@@ -6665,7 +6670,7 @@ yy587:
 		goto yy607;
 	}
 yy588:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6692,42 +6697,42 @@ yy588:
 		}
 	}
 yy590:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy587;
 	if (yych <= 0xBF) goto yy585;
 	goto yy587;
 yy591:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy587;
 	if (yych <= 0xBF) goto yy590;
 	goto yy587;
 yy592:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy587;
 	if (yych <= 0xBF) goto yy590;
 	goto yy587;
 yy593:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy587;
 	if (yych <= 0x9F) goto yy590;
 	goto yy587;
 yy594:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy587;
 	if (yych <= 0xBF) goto yy592;
 	goto yy587;
 yy595:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy587;
 	if (yych <= 0xBF) goto yy592;
 	goto yy587;
 yy596:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy587;
 	if (yych <= 0x8F) goto yy592;
 	goto yy587;
 yy597:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6773,7 +6778,7 @@ yy597:
 		}
 	}
 yy598:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6810,7 +6815,7 @@ yy598:
 		}
 	}
 yy599:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6857,7 +6862,7 @@ yy599:
 		}
 	}
 yy600:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6894,7 +6899,7 @@ yy600:
 		}
 	}
 yy601:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6931,7 +6936,7 @@ yy601:
 		}
 	}
 yy602:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6968,7 +6973,7 @@ yy602:
 		}
 	}
 yy603:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -6996,7 +7001,7 @@ yy603:
 		}
 	}
 yy604:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -7033,7 +7038,7 @@ yy604:
 		}
 	}
 yy605:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -7071,7 +7076,7 @@ yy605:
 	}
 yy606:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy585;
 	}
@@ -7097,7 +7102,7 @@ yy606:
 yy607:
 	{ return (bufsize_t)(p - start); }
 yy608:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -7133,7 +7138,7 @@ yy608:
 		}
 	}
 yy609:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy588;
 	}
@@ -7174,7 +7179,7 @@ yy609:
 }
 
 // Try to match an HTML block end line of type 2
-bufsize_t _scan_html_block_end_2(const unsigned char *p)
+bufsize_t _scan_html_block_end_2(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -7216,7 +7221,7 @@ bufsize_t _scan_html_block_end_2(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= 0xDF) {
 		if (yych <= ',') {
 			if (yych <= 0x00) goto yy612;
@@ -7243,7 +7248,7 @@ yy613:
 	{ return 0; }
 yy614:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '\n') {
 		if (yych <= 0x00) goto yy613;
 		if (yych <= '\t') goto yy624;
@@ -7256,7 +7261,7 @@ yy614:
 	}
 yy615:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy634;
 	}
@@ -7272,48 +7277,48 @@ yy615:
 	}
 yy616:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy613;
 	if (yych <= 0xBF) goto yy623;
 	goto yy613;
 yy617:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x9F) goto yy613;
 	if (yych <= 0xBF) goto yy627;
 	goto yy613;
 yy618:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy613;
 	if (yych <= 0xBF) goto yy627;
 	goto yy613;
 yy619:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy613;
 	if (yych <= 0x9F) goto yy627;
 	goto yy613;
 yy620:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x8F) goto yy613;
 	if (yych <= 0xBF) goto yy629;
 	goto yy613;
 yy621:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy613;
 	if (yych <= 0xBF) goto yy629;
 	goto yy613;
 yy622:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy613;
 	if (yych <= 0x8F) goto yy629;
 	goto yy613;
 yy623:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy624:
 	if (yybm[0+yych] & 64) {
 		goto yy623;
@@ -7345,7 +7350,7 @@ yy625:
 		goto yy637;
 	}
 yy626:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy623;
 	}
@@ -7371,42 +7376,42 @@ yy626:
 		}
 	}
 yy627:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy625;
 	if (yych <= 0xBF) goto yy623;
 	goto yy625;
 yy628:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy625;
 	if (yych <= 0xBF) goto yy627;
 	goto yy625;
 yy629:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy625;
 	if (yych <= 0xBF) goto yy627;
 	goto yy625;
 yy630:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy625;
 	if (yych <= 0x9F) goto yy627;
 	goto yy625;
 yy631:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy625;
 	if (yych <= 0xBF) goto yy629;
 	goto yy625;
 yy632:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy625;
 	if (yych <= 0xBF) goto yy629;
 	goto yy625;
 yy633:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy625;
 	if (yych <= 0x8F) goto yy629;
 	goto yy625;
 yy634:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy634;
 	}
@@ -7435,7 +7440,7 @@ yy634:
 	}
 yy636:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy623;
 	}
@@ -7465,7 +7470,7 @@ yy637:
 }
 
 // Try to match an HTML block end line of type 3
-bufsize_t _scan_html_block_end_3(const unsigned char *p)
+bufsize_t _scan_html_block_end_3(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -7507,7 +7512,7 @@ bufsize_t _scan_html_block_end_3(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= 0xDF) {
 		if (yych <= '>') {
 			if (yych <= 0x00) goto yy640;
@@ -7534,7 +7539,7 @@ yy641:
 	{ return 0; }
 yy642:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '\n') {
 		if (yych <= 0x00) goto yy641;
 		if (yych <= '\t') goto yy652;
@@ -7547,7 +7552,7 @@ yy642:
 	}
 yy643:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '=') {
 		if (yych <= 0x00) goto yy641;
 		if (yych == '\n') goto yy641;
@@ -7564,48 +7569,48 @@ yy643:
 	}
 yy644:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy641;
 	if (yych <= 0xBF) goto yy651;
 	goto yy641;
 yy645:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x9F) goto yy641;
 	if (yych <= 0xBF) goto yy656;
 	goto yy641;
 yy646:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy641;
 	if (yych <= 0xBF) goto yy656;
 	goto yy641;
 yy647:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy641;
 	if (yych <= 0x9F) goto yy656;
 	goto yy641;
 yy648:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x8F) goto yy641;
 	if (yych <= 0xBF) goto yy658;
 	goto yy641;
 yy649:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy641;
 	if (yych <= 0xBF) goto yy658;
 	goto yy641;
 yy650:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy641;
 	if (yych <= 0x8F) goto yy658;
 	goto yy641;
 yy651:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy652:
 	if (yybm[0+yych] & 64) {
 		goto yy651;
@@ -7637,7 +7642,7 @@ yy653:
 		goto yy664;
 	}
 yy654:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy654;
 	}
@@ -7664,43 +7669,43 @@ yy654:
 		}
 	}
 yy656:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy653;
 	if (yych <= 0xBF) goto yy651;
 	goto yy653;
 yy657:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy653;
 	if (yych <= 0xBF) goto yy656;
 	goto yy653;
 yy658:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy653;
 	if (yych <= 0xBF) goto yy656;
 	goto yy653;
 yy659:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy653;
 	if (yych <= 0x9F) goto yy656;
 	goto yy653;
 yy660:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy653;
 	if (yych <= 0xBF) goto yy658;
 	goto yy653;
 yy661:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy653;
 	if (yych <= 0xBF) goto yy658;
 	goto yy653;
 yy662:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy653;
 	if (yych <= 0x8F) goto yy658;
 	goto yy653;
 yy663:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy651;
 	}
@@ -7730,7 +7735,7 @@ yy664:
 }
 
 // Try to match an HTML block end line of type 4
-bufsize_t _scan_html_block_end_4(const unsigned char *p)
+bufsize_t _scan_html_block_end_4(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -7772,7 +7777,7 @@ bufsize_t _scan_html_block_end_4(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy670;
 	}
@@ -7802,7 +7807,7 @@ yy668:
 	{ return 0; }
 yy669:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '\n') {
 		if (yych <= 0x00) goto yy668;
 		if (yych <= '\t') goto yy681;
@@ -7815,7 +7820,7 @@ yy669:
 	}
 yy670:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy680;
 	}
@@ -7842,48 +7847,48 @@ yy672:
 	{ return (bufsize_t)(p - start); }
 yy673:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy668;
 	if (yych <= 0xBF) goto yy680;
 	goto yy668;
 yy674:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x9F) goto yy668;
 	if (yych <= 0xBF) goto yy683;
 	goto yy668;
 yy675:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy668;
 	if (yych <= 0xBF) goto yy683;
 	goto yy668;
 yy676:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy668;
 	if (yych <= 0x9F) goto yy683;
 	goto yy668;
 yy677:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x8F) goto yy668;
 	if (yych <= 0xBF) goto yy685;
 	goto yy668;
 yy678:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy668;
 	if (yych <= 0xBF) goto yy685;
 	goto yy668;
 yy679:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy668;
 	if (yych <= 0x8F) goto yy685;
 	goto yy668;
 yy680:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy681:
 	if (yybm[0+yych] & 128) {
 		goto yy680;
@@ -7915,37 +7920,37 @@ yy682:
 		goto yy672;
 	}
 yy683:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy682;
 	if (yych <= 0xBF) goto yy680;
 	goto yy682;
 yy684:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy682;
 	if (yych <= 0xBF) goto yy683;
 	goto yy682;
 yy685:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy682;
 	if (yych <= 0xBF) goto yy683;
 	goto yy682;
 yy686:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy682;
 	if (yych <= 0x9F) goto yy683;
 	goto yy682;
 yy687:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy682;
 	if (yych <= 0xBF) goto yy685;
 	goto yy682;
 yy688:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy682;
 	if (yych <= 0xBF) goto yy685;
 	goto yy682;
 yy689:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy682;
 	if (yych <= 0x8F) goto yy685;
 	goto yy682;
@@ -7954,7 +7959,7 @@ yy689:
 }
 
 // Try to match an HTML block end line of type 5
-bufsize_t _scan_html_block_end_5(const unsigned char *p)
+bufsize_t _scan_html_block_end_5(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -7996,7 +8001,7 @@ bufsize_t _scan_html_block_end_5(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= 0xDF) {
 		if (yych <= '\\') {
 			if (yych <= 0x00) goto yy692;
@@ -8023,7 +8028,7 @@ yy693:
 	{ return 0; }
 yy694:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '\n') {
 		if (yych <= 0x00) goto yy693;
 		if (yych <= '\t') goto yy704;
@@ -8036,7 +8041,7 @@ yy694:
 	}
 yy695:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy714;
 	}
@@ -8052,48 +8057,48 @@ yy695:
 	}
 yy696:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy693;
 	if (yych <= 0xBF) goto yy703;
 	goto yy693;
 yy697:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x9F) goto yy693;
 	if (yych <= 0xBF) goto yy707;
 	goto yy693;
 yy698:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy693;
 	if (yych <= 0xBF) goto yy707;
 	goto yy693;
 yy699:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy693;
 	if (yych <= 0x9F) goto yy707;
 	goto yy693;
 yy700:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x8F) goto yy693;
 	if (yych <= 0xBF) goto yy709;
 	goto yy693;
 yy701:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy693;
 	if (yych <= 0xBF) goto yy709;
 	goto yy693;
 yy702:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x7F) goto yy693;
 	if (yych <= 0x8F) goto yy709;
 	goto yy693;
 yy703:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy704:
 	if (yybm[0+yych] & 64) {
 		goto yy703;
@@ -8125,7 +8130,7 @@ yy705:
 		goto yy717;
 	}
 yy706:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy703;
 	}
@@ -8151,42 +8156,42 @@ yy706:
 		}
 	}
 yy707:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy705;
 	if (yych <= 0xBF) goto yy703;
 	goto yy705;
 yy708:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy705;
 	if (yych <= 0xBF) goto yy707;
 	goto yy705;
 yy709:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy705;
 	if (yych <= 0xBF) goto yy707;
 	goto yy705;
 yy710:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy705;
 	if (yych <= 0x9F) goto yy707;
 	goto yy705;
 yy711:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy705;
 	if (yych <= 0xBF) goto yy709;
 	goto yy705;
 yy712:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy705;
 	if (yych <= 0xBF) goto yy709;
 	goto yy705;
 yy713:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy705;
 	if (yych <= 0x8F) goto yy709;
 	goto yy705;
 yy714:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy714;
 	}
@@ -8215,7 +8220,7 @@ yy714:
 	}
 yy716:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy703;
 	}
@@ -8247,7 +8252,7 @@ yy717:
 // Try to match a link title (in single quotes, in double quotes, or
 // in parentheses), returning number of chars matched.  Allow one
 // level of internal nesting (quotes within quotes).
-bufsize_t _scan_link_title(const unsigned char *p)
+bufsize_t _scan_link_title(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -8289,7 +8294,7 @@ bufsize_t _scan_link_title(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= '&') {
 		if (yych == '"') goto yy722;
 	} else {
@@ -8301,7 +8306,7 @@ yy721:
 	{ return 0; }
 yy722:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x00) goto yy721;
 	if (yych <= 0x7F) goto yy726;
 	if (yych <= 0xC1) goto yy721;
@@ -8309,7 +8314,7 @@ yy722:
 	goto yy721;
 yy723:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x00) goto yy721;
 	if (yych <= 0x7F) goto yy740;
 	if (yych <= 0xC1) goto yy721;
@@ -8317,14 +8322,14 @@ yy723:
 	goto yy721;
 yy724:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x00) goto yy721;
 	if (yych <= 0x7F) goto yy753;
 	if (yych <= 0xC1) goto yy721;
 	if (yych <= 0xF4) goto yy753;
 	goto yy721;
 yy725:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy726:
 	if (yybm[0+yych] & 16) {
 		goto yy725;
@@ -8369,7 +8374,7 @@ yy728:
 yy729:
 	{ return (bufsize_t)(p - start); }
 yy730:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy725;
 	}
@@ -8394,42 +8399,42 @@ yy730:
 		}
 	}
 yy732:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy725;
 	goto yy727;
 yy733:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy727;
 	if (yych <= 0xBF) goto yy732;
 	goto yy727;
 yy734:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy732;
 	goto yy727;
 yy735:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0x9F) goto yy732;
 	goto yy727;
 yy736:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy727;
 	if (yych <= 0xBF) goto yy734;
 	goto yy727;
 yy737:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy734;
 	goto yy727;
 yy738:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0x8F) goto yy734;
 	goto yy727;
 yy739:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy740:
 	if (yybm[0+yych] & 64) {
 		goto yy739;
@@ -8459,7 +8464,7 @@ yy741:
 yy742:
 	{ return (bufsize_t)(p - start); }
 yy743:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy739;
 	}
@@ -8484,42 +8489,42 @@ yy743:
 		}
 	}
 yy745:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy739;
 	goto yy727;
 yy746:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy727;
 	if (yych <= 0xBF) goto yy745;
 	goto yy727;
 yy747:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy745;
 	goto yy727;
 yy748:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0x9F) goto yy745;
 	goto yy727;
 yy749:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy727;
 	if (yych <= 0xBF) goto yy747;
 	goto yy727;
 yy750:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy747;
 	goto yy727;
 yy751:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0x8F) goto yy747;
 	goto yy727;
 yy752:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy753:
 	if (yybm[0+yych] & 128) {
 		goto yy752;
@@ -8549,7 +8554,7 @@ yy754:
 yy755:
 	{ return (bufsize_t)(p - start); }
 yy756:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy752;
 	}
@@ -8574,43 +8579,43 @@ yy756:
 		}
 	}
 yy758:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy752;
 	goto yy727;
 yy759:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy727;
 	if (yych <= 0xBF) goto yy758;
 	goto yy727;
 yy760:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy758;
 	goto yy727;
 yy761:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0x9F) goto yy758;
 	goto yy727;
 yy762:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy727;
 	if (yych <= 0xBF) goto yy760;
 	goto yy727;
 yy763:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0xBF) goto yy760;
 	goto yy727;
 yy764:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy727;
 	if (yych <= 0x8F) goto yy760;
 	goto yy727;
 yy765:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy725;
 	}
@@ -8637,7 +8642,7 @@ yy765:
 	}
 yy766:
 	yyaccept = 2;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy739;
 	}
@@ -8664,7 +8669,7 @@ yy766:
 	}
 yy767:
 	yyaccept = 3;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy752;
 	}
@@ -8694,7 +8699,7 @@ yy767:
 }
 
 // Match space characters, including newlines.
-bufsize_t _scan_spacechars(const unsigned char *p)
+bufsize_t _scan_spacechars(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *start = p; \
 
@@ -8734,14 +8739,14 @@ bufsize_t _scan_spacechars(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy772;
 	}
 	++p;
 	{ return 0; }
 yy772:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy772;
 	}
@@ -8751,7 +8756,7 @@ yy772:
 }
 
 // Match ATX heading start.
-bufsize_t _scan_atx_heading_start(const unsigned char *p)
+bufsize_t _scan_atx_heading_start(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -8792,13 +8797,13 @@ bufsize_t _scan_atx_heading_start(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '#') goto yy779;
 	++p;
 yy778:
 	{ return 0; }
 yy779:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8812,7 +8817,7 @@ yy779:
 		goto yy778;
 	}
 yy780:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8822,7 +8827,7 @@ yy783:
 	++p;
 	goto yy782;
 yy784:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8837,7 +8842,7 @@ yy785:
 	p = marker;
 	goto yy778;
 yy786:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8849,7 +8854,7 @@ yy786:
 		if (yych <= '\r') goto yy783;
 		if (yych != '#') goto yy785;
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8861,7 +8866,7 @@ yy786:
 		if (yych <= '\r') goto yy783;
 		if (yych != '#') goto yy785;
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8873,7 +8878,7 @@ yy786:
 		if (yych <= '\r') goto yy783;
 		if (yych != '#') goto yy785;
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy780;
 	}
@@ -8887,7 +8892,7 @@ yy786:
 
 // Match setext heading line.  Return 1 for level-1 heading,
 // 2 for level-2, 0 for no match.
-bufsize_t _scan_setext_heading_line(const unsigned char *p)
+bufsize_t _scan_setext_heading_line(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
 
@@ -8927,14 +8932,14 @@ bufsize_t _scan_setext_heading_line(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '-') goto yy794;
 	if (yych == '=') goto yy795;
 	++p;
 yy793:
 	{ return 0; }
 yy794:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy801;
 	}
@@ -8948,7 +8953,7 @@ yy794:
 		goto yy793;
 	}
 yy795:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy807;
 	}
@@ -8962,7 +8967,7 @@ yy795:
 		goto yy793;
 	}
 yy796:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy797:
 	if (yybm[0+yych] & 32) {
 		goto yy796;
@@ -8977,7 +8982,7 @@ yy799:
 	++p;
 	{ return 2; }
 yy801:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy796;
 	}
@@ -8991,7 +8996,7 @@ yy801:
 		goto yy798;
 	}
 yy803:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy804:
 	if (yych <= '\f') {
 		if (yych <= 0x08) goto yy798;
@@ -9006,7 +9011,7 @@ yy805:
 	++p;
 	{ return 1; }
 yy807:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy807;
 	}
@@ -9027,7 +9032,7 @@ yy807:
 // Scan a thematic break line: "...three or more hyphens, asterisks,
 // or underscores on a line by themselves. If you wish, you may use
 // spaces between the hyphens or asterisks."
-bufsize_t _scan_thematic_break(const unsigned char *p)
+bufsize_t _scan_thematic_break(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -9068,7 +9073,7 @@ bufsize_t _scan_thematic_break(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= ',') {
 		if (yych == '*') goto yy813;
 	} else {
@@ -9079,14 +9084,14 @@ bufsize_t _scan_thematic_break(const unsigned char *p)
 yy812:
 	{ return 0; }
 yy813:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy816;
 	}
 	if (yych == '*') goto yy819;
 	goto yy812;
 yy814:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy821;
 		goto yy812;
@@ -9096,7 +9101,7 @@ yy814:
 		goto yy812;
 	}
 yy815:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy825;
 		goto yy812;
@@ -9106,7 +9111,7 @@ yy815:
 		goto yy812;
 	}
 yy816:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy816;
 	}
@@ -9115,7 +9120,7 @@ yy818:
 	p = marker;
 	goto yy812;
 yy819:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy819;
 		goto yy818;
@@ -9125,7 +9130,7 @@ yy819:
 		goto yy818;
 	}
 yy821:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy821;
 		goto yy818;
@@ -9134,7 +9139,7 @@ yy821:
 		if (yych != '-') goto yy818;
 	}
 yy823:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy823;
 		goto yy818;
@@ -9144,7 +9149,7 @@ yy823:
 		goto yy818;
 	}
 yy825:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy825;
 		goto yy818;
@@ -9153,7 +9158,7 @@ yy825:
 		if (yych != '_') goto yy818;
 	}
 yy827:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x1F) {
 		if (yych == '\t') goto yy827;
 		goto yy818;
@@ -9163,7 +9168,7 @@ yy827:
 		goto yy818;
 	}
 yy829:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy829;
 	}
@@ -9172,7 +9177,7 @@ yy829:
 	if (yych == '\r') goto yy835;
 	goto yy818;
 yy831:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy831;
 	}
@@ -9181,7 +9186,7 @@ yy831:
 	if (yych == '\r') goto yy837;
 	goto yy818;
 yy833:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy833;
 	}
@@ -9203,7 +9208,7 @@ yy839:
 }
 
 // Scan an opening code fence.
-bufsize_t _scan_open_code_fence(const unsigned char *p)
+bufsize_t _scan_open_code_fence(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -9244,22 +9249,22 @@ bufsize_t _scan_open_code_fence(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '`') goto yy845;
 	if (yych == '~') goto yy846;
 	++p;
 yy844:
 	{ return 0; }
 yy845:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == '`') goto yy847;
 	goto yy844;
 yy846:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == '~') goto yy849;
 	goto yy844;
 yy847:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy850;
 	}
@@ -9267,13 +9272,13 @@ yy848:
 	p = marker;
 	goto yy844;
 yy849:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy852;
 	}
 	goto yy848;
 yy850:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 16) {
 		goto yy850;
 	}
@@ -9328,7 +9333,7 @@ yy850:
 		}
 	}
 yy852:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy852;
 	}
@@ -9383,7 +9388,7 @@ yy852:
 		}
 	}
 yy854:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy854;
 	}
@@ -9412,42 +9417,42 @@ yy856:
 	p = marker;
 	{ return (bufsize_t)(p - start); }
 yy858:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0xBF) goto yy854;
 	goto yy848;
 yy859:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy848;
 	if (yych <= 0xBF) goto yy858;
 	goto yy848;
 yy860:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0xBF) goto yy858;
 	goto yy848;
 yy861:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0x9F) goto yy858;
 	goto yy848;
 yy862:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy848;
 	if (yych <= 0xBF) goto yy860;
 	goto yy848;
 yy863:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0xBF) goto yy860;
 	goto yy848;
 yy864:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0x8F) goto yy860;
 	goto yy848;
 yy865:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy865;
 	}
@@ -9476,37 +9481,37 @@ yy867:
 	p = marker;
 	{ return (bufsize_t)(p - start); }
 yy869:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0xBF) goto yy865;
 	goto yy848;
 yy870:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy848;
 	if (yych <= 0xBF) goto yy869;
 	goto yy848;
 yy871:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0xBF) goto yy869;
 	goto yy848;
 yy872:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0x9F) goto yy869;
 	goto yy848;
 yy873:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy848;
 	if (yych <= 0xBF) goto yy871;
 	goto yy848;
 yy874:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0xBF) goto yy871;
 	goto yy848;
 yy875:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy848;
 	if (yych <= 0x8F) goto yy871;
 	goto yy848;
@@ -9515,7 +9520,7 @@ yy875:
 }
 
 // Scan a closing code fence with length at least len.
-bufsize_t _scan_close_code_fence(const unsigned char *p)
+bufsize_t _scan_close_code_fence(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -9556,22 +9561,22 @@ bufsize_t _scan_close_code_fence(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '`') goto yy880;
 	if (yych == '~') goto yy881;
 	++p;
 yy879:
 	{ return 0; }
 yy880:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == '`') goto yy882;
 	goto yy879;
 yy881:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == '~') goto yy884;
 	goto yy879;
 yy882:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy885;
 	}
@@ -9579,13 +9584,13 @@ yy883:
 	p = marker;
 	goto yy879;
 yy884:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy887;
 	}
 	goto yy883;
 yy885:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 32) {
 		goto yy885;
 	}
@@ -9612,7 +9617,7 @@ yy885:
 		goto yy883;
 	}
 yy887:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 64) {
 		goto yy887;
 	}
@@ -9639,7 +9644,7 @@ yy887:
 		goto yy883;
 	}
 yy889:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy889;
 	}
@@ -9651,7 +9656,7 @@ yy891:
 	p = marker;
 	{ return (bufsize_t)(p - start); }
 yy893:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '\f') {
 		if (yych <= 0x08) goto yy883;
 		if (yych <= '\t') goto yy893;
@@ -9671,20 +9676,20 @@ yy895:
 
 // Scans an entity.
 // Returns number of chars matched.
-bufsize_t _scan_entity(const unsigned char *p)
+bufsize_t _scan_entity(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
 {
 	unsigned char yych;
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '&') goto yy901;
 	++p;
 yy900:
 	{ return 0; }
 yy901:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych <= '@') {
 		if (yych != '#') goto yy900;
 	} else {
@@ -9693,7 +9698,7 @@ yy901:
 		if (yych <= 'z') goto yy904;
 		goto yy900;
 	}
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'W') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy905;
@@ -9705,7 +9710,7 @@ yy903:
 	p = marker;
 	goto yy900;
 yy904:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '@') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy907;
@@ -9717,13 +9722,13 @@ yy904:
 		goto yy903;
 	}
 yy905:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') goto yy903;
 	if (yych <= '9') goto yy908;
 	if (yych == ';') goto yy909;
 	goto yy903;
 yy906:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '@') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy911;
@@ -9735,7 +9740,7 @@ yy906:
 		goto yy903;
 	}
 yy907:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy912;
@@ -9752,7 +9757,7 @@ yy907:
 		}
 	}
 yy908:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') goto yy903;
 	if (yych <= '9') goto yy913;
 	if (yych != ';') goto yy903;
@@ -9760,7 +9765,7 @@ yy909:
 	++p;
 	{ return (bufsize_t)(p - start); }
 yy911:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy914;
@@ -9777,7 +9782,7 @@ yy911:
 		}
 	}
 yy912:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy915;
@@ -9794,13 +9799,13 @@ yy912:
 		}
 	}
 yy913:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') goto yy903;
 	if (yych <= '9') goto yy916;
 	if (yych == ';') goto yy909;
 	goto yy903;
 yy914:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy917;
@@ -9817,7 +9822,7 @@ yy914:
 		}
 	}
 yy915:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy918;
@@ -9834,13 +9839,13 @@ yy915:
 		}
 	}
 yy916:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') goto yy903;
 	if (yych <= '9') goto yy919;
 	if (yych == ';') goto yy909;
 	goto yy903;
 yy917:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy920;
@@ -9857,7 +9862,7 @@ yy917:
 		}
 	}
 yy918:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy921;
@@ -9874,13 +9879,13 @@ yy918:
 		}
 	}
 yy919:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') goto yy903;
 	if (yych <= '9') goto yy922;
 	if (yych == ';') goto yy909;
 	goto yy903;
 yy920:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy923;
@@ -9897,7 +9902,7 @@ yy920:
 		}
 	}
 yy921:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy924;
@@ -9914,13 +9919,13 @@ yy921:
 		}
 	}
 yy922:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= '/') goto yy903;
 	if (yych <= '9') goto yy925;
 	if (yych == ';') goto yy909;
 	goto yy903;
 yy923:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy925;
@@ -9937,7 +9942,7 @@ yy923:
 		}
 	}
 yy924:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy926;
@@ -9954,11 +9959,11 @@ yy924:
 		}
 	}
 yy925:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == ';') goto yy909;
 	goto yy903;
 yy926:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy927;
@@ -9973,7 +9978,7 @@ yy926:
 		}
 	}
 yy927:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy928;
@@ -9988,7 +9993,7 @@ yy927:
 		}
 	}
 yy928:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy929;
@@ -10003,7 +10008,7 @@ yy928:
 		}
 	}
 yy929:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy930;
@@ -10018,7 +10023,7 @@ yy929:
 		}
 	}
 yy930:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy931;
@@ -10033,7 +10038,7 @@ yy930:
 		}
 	}
 yy931:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy932;
@@ -10048,7 +10053,7 @@ yy931:
 		}
 	}
 yy932:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy933;
@@ -10063,7 +10068,7 @@ yy932:
 		}
 	}
 yy933:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy934;
@@ -10078,7 +10083,7 @@ yy933:
 		}
 	}
 yy934:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy935;
@@ -10093,7 +10098,7 @@ yy934:
 		}
 	}
 yy935:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy936;
@@ -10108,7 +10113,7 @@ yy935:
 		}
 	}
 yy936:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy937;
@@ -10123,7 +10128,7 @@ yy936:
 		}
 	}
 yy937:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy938;
@@ -10138,7 +10143,7 @@ yy937:
 		}
 	}
 yy938:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy939;
@@ -10153,7 +10158,7 @@ yy938:
 		}
 	}
 yy939:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy940;
@@ -10168,7 +10173,7 @@ yy939:
 		}
 	}
 yy940:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy941;
@@ -10183,7 +10188,7 @@ yy940:
 		}
 	}
 yy941:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy942;
@@ -10198,7 +10203,7 @@ yy941:
 		}
 	}
 yy942:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy943;
@@ -10213,7 +10218,7 @@ yy942:
 		}
 	}
 yy943:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy944;
@@ -10228,7 +10233,7 @@ yy943:
 		}
 	}
 yy944:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy945;
@@ -10243,7 +10248,7 @@ yy944:
 		}
 	}
 yy945:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy946;
@@ -10258,7 +10263,7 @@ yy945:
 		}
 	}
 yy946:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy947;
@@ -10273,7 +10278,7 @@ yy946:
 		}
 	}
 yy947:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy948;
@@ -10288,7 +10293,7 @@ yy947:
 		}
 	}
 yy948:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy949;
@@ -10303,7 +10308,7 @@ yy948:
 		}
 	}
 yy949:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= ';') {
 		if (yych <= '/') goto yy903;
 		if (yych <= '9') goto yy925;
@@ -10325,7 +10330,7 @@ yy949:
 
 // Returns positive value if a URL begins in a way that is potentially
 // dangerous, with javascript:, vbscript:, file:, or data:, otherwise 0.
-bufsize_t _scan_dangerous_url(const unsigned char *p)
+bufsize_t _scan_dangerous_url(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -10333,7 +10338,7 @@ bufsize_t _scan_dangerous_url(const unsigned char *p)
 {
 	unsigned char yych;
 	unsigned int yyaccept = 0;
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych <= 'V') {
 		if (yych <= 'F') {
 			if (yych == 'D') goto yy954;
@@ -10359,30 +10364,30 @@ yy953:
 	{ return 0; }
 yy954:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == 'A') goto yy958;
 	if (yych == 'a') goto yy958;
 	goto yy953;
 yy955:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == 'I') goto yy960;
 	if (yych == 'i') goto yy960;
 	goto yy953;
 yy956:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == 'A') goto yy961;
 	if (yych == 'a') goto yy961;
 	goto yy953;
 yy957:
 	yyaccept = 0;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == 'B') goto yy962;
 	if (yych == 'b') goto yy962;
 	goto yy953;
 yy958:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy963;
 	if (yych == 't') goto yy963;
 yy959:
@@ -10393,56 +10398,56 @@ yy959:
 		goto yy971;
 	}
 yy960:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'L') goto yy964;
 	if (yych == 'l') goto yy964;
 	goto yy959;
 yy961:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'V') goto yy965;
 	if (yych == 'v') goto yy965;
 	goto yy959;
 yy962:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'S') goto yy966;
 	if (yych == 's') goto yy966;
 	goto yy959;
 yy963:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy967;
 	if (yych == 'a') goto yy967;
 	goto yy959;
 yy964:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy968;
 	if (yych == 'e') goto yy968;
 	goto yy959;
 yy965:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy962;
 	if (yych == 'a') goto yy962;
 	goto yy959;
 yy966:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'C') goto yy969;
 	if (yych == 'c') goto yy969;
 	goto yy959;
 yy967:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == ':') goto yy970;
 	goto yy959;
 yy968:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == ':') goto yy972;
 	goto yy959;
 yy969:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'R') goto yy973;
 	if (yych == 'r') goto yy973;
 	goto yy959;
 yy970:
 	yyaccept = 1;
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych == 'I') goto yy974;
 	if (yych == 'i') goto yy974;
 yy971:
@@ -10451,42 +10456,42 @@ yy972:
 	++p;
 	goto yy971;
 yy973:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy975;
 	if (yych == 'i') goto yy975;
 	goto yy959;
 yy974:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'M') goto yy976;
 	if (yych == 'm') goto yy976;
 	goto yy959;
 yy975:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'P') goto yy977;
 	if (yych == 'p') goto yy977;
 	goto yy959;
 yy976:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'A') goto yy978;
 	if (yych == 'a') goto yy978;
 	goto yy959;
 yy977:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'T') goto yy968;
 	if (yych == 't') goto yy968;
 	goto yy959;
 yy978:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'G') goto yy979;
 	if (yych != 'g') goto yy959;
 yy979:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy980;
 	if (yych != 'e') goto yy959;
 yy980:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych != '/') goto yy959;
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 'W') {
 		if (yych <= 'J') {
 			if (yych == 'G') goto yy982;
@@ -10513,41 +10518,41 @@ yy980:
 		}
 	}
 yy982:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'I') goto yy986;
 	if (yych == 'i') goto yy986;
 	goto yy959;
 yy983:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'P') goto yy987;
 	if (yych == 'p') goto yy987;
 	goto yy959;
 yy984:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'N') goto yy988;
 	if (yych == 'n') goto yy988;
 	goto yy959;
 yy985:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy989;
 	if (yych == 'e') goto yy989;
 	goto yy959;
 yy986:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'F') goto yy990;
 	if (yych == 'f') goto yy990;
 	goto yy959;
 yy987:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'E') goto yy988;
 	if (yych != 'e') goto yy959;
 yy988:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'G') goto yy990;
 	if (yych == 'g') goto yy990;
 	goto yy959;
 yy989:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'B') goto yy992;
 	if (yych == 'b') goto yy992;
 	goto yy959;
@@ -10555,7 +10560,7 @@ yy990:
 	++p;
 	{ return 0; }
 yy992:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych == 'P') goto yy990;
 	if (yych == 'p') goto yy990;
 	goto yy959;
@@ -10564,7 +10569,7 @@ yy992:
 }
 
 // Scans a footnote definition opening.
-bufsize_t _scan_footnote_definition(const unsigned char *p)
+bufsize_t _scan_footnote_definition(const unsigned char *p, const unsigned char *end)
 {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
@@ -10605,21 +10610,21 @@ bufsize_t _scan_footnote_definition(const unsigned char *p)
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 		  0,   0,   0,   0,   0,   0,   0,   0, 
 	};
-	yych = *p;
+	yych = yypeek(p, end);
 	if (yych == '[') goto yy997;
 	++p;
 yy996:
 	{ return 0; }
 yy997:
-	yych = *(marker = ++p);
+	yych = yypeek(marker = ++p, end);
 	if (yych != '^') goto yy996;
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych != ']') goto yy1001;
 yy999:
 	p = marker;
 	goto yy996;
 yy1000:
-	yych = *++p;
+	yych = yypeek(++p, end);
 yy1001:
 	if (yybm[0+yych] & 64) {
 		goto yy1000;
@@ -10646,45 +10651,45 @@ yy1001:
 		}
 	}
 yy1002:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy999;
 	if (yych <= 0xBF) goto yy1000;
 	goto yy999;
 yy1003:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x9F) goto yy999;
 	if (yych <= 0xBF) goto yy1002;
 	goto yy999;
 yy1004:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy999;
 	if (yych <= 0xBF) goto yy1002;
 	goto yy999;
 yy1005:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy999;
 	if (yych <= 0x9F) goto yy1002;
 	goto yy999;
 yy1006:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x8F) goto yy999;
 	if (yych <= 0xBF) goto yy1004;
 	goto yy999;
 yy1007:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy999;
 	if (yych <= 0xBF) goto yy1004;
 	goto yy999;
 yy1008:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych <= 0x7F) goto yy999;
 	if (yych <= 0x8F) goto yy1004;
 	goto yy999;
 yy1009:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yych != ':') goto yy999;
 yy1010:
-	yych = *++p;
+	yych = yypeek(++p, end);
 	if (yybm[0+yych] & 128) {
 		goto yy1010;
 	}
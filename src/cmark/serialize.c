@@ -0,0 +1,652 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "node.h"
+#include "parser.h"
+#include "syntax_extension.h"
+#include "buffer.h"
+#include "chunk.h"
+#include "mem_stats.h"
+
+// Binary form of a tree, see cmark_ast_save() and cmark_ast_load().
+//
+//   header   "CMAST", the format version, and a checksum of the rest
+//   exts     count, then the name of every extension used by the tree
+//   types    count, then every node type added by an extension: its
+//            extension and type string
+//   nodes    in document order: type, extension, position, number of
+//            children, the data of the type, and the data the extension
+//            keeps for the node
+//
+// Numbers are unsigned LEB128 varints, signed ones zigzag encoded first.
+// Strings are a length followed by the bytes. Node types added by
+// extensions are numbered at run time, so they are written as an index
+// into the type table and looked up again by type string when loading.
+// The type code of a node is shifted left by one, with the low bit set
+// when it is followed by the index of its extension, so most nodes start
+// with a single byte.
+
+#define AST_MAGIC "CMAST"
+#define AST_MAGIC_LEN 5
+#define AST_VERSION 1
+
+// Extensions and extension node types of a single tree
+#define AST_MAX_EXTENSIONS 64
+#define AST_MAX_TYPES 256
+
+// Type codes: core block types, core inline types, then the type table
+#define AST_INLINE_TYPE 0x10
+#define AST_EXT_TYPE 0x20
+
+typedef struct {
+  cmark_strbuf *body;
+  cmark_syntax_extension *exts[AST_MAX_EXTENSIONS];
+  int nexts;
+  uint16_t types[AST_MAX_TYPES];
+  int type_exts[AST_MAX_TYPES];
+  const char *type_names[AST_MAX_TYPES];
+  int ntypes;
+} ast_writer;
+
+static bool S_is_core_type(uint16_t type) {
+  return (type >= CMARK_NODE_DOCUMENT && type <= CMARK_NODE_FOOTNOTE_DEFINITION) ||
+         (type >= CMARK_NODE_TEXT && type <= CMARK_NODE_FOOTNOTE_REFERENCE);
+}
+
+// FNV-1a, to reject files that were truncated or damaged on disk
+static uint32_t S_checksum(const unsigned char *data, size_t len) {
+  uint32_t h = 2166136261u;
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    h = (h ^ data[i]) * 16777619u;
+  return h;
+}
+
+static void S_put_varint(cmark_strbuf *buf, uint64_t n) {
+  unsigned char bytes[10];
+  int len = 0;
+
+  do {
+    bytes[len] = (unsigned char)(n & 0x7f);
+    n >>= 7;
+    if (n)
+      bytes[len] |= 0x80;
+    len++;
+  } while (n);
+  cmark_strbuf_put(buf, bytes, len);
+}
+
+static void S_put_int(cmark_strbuf *buf, int64_t n) {
+  S_put_varint(buf, ((uint64_t)n << 1) ^ (uint64_t)(n >> 63));
+}
+
+static void S_put_bytes(cmark_strbuf *buf, const unsigned char *data, size_t len) {
+  S_put_varint(buf, len);
+  if (len)
+    cmark_strbuf_put(buf, data, (bufsize_t)len);
+}
+
+static void S_put_chunk(cmark_strbuf *buf, cmark_chunk *c) {
+  S_put_bytes(buf, c->data, c->len);
+}
+
+// The type string of a node of 'type' without any data, which is the same
+// when saving and loading, also for types that have several type strings
+// depending on the node, such as table rows and headers
+static const char *S_type_string(cmark_syntax_extension *ext, uint16_t type) {
+  void *opaque[16] = {0};
+  cmark_node probe;
+
+  memset(&probe, 0, sizeof(probe));
+  probe.type = type;
+  probe.extension = ext;
+  probe.as.opaque = opaque;
+  return ext->get_type_string_func(ext, &probe);
+}
+
+// The node type with the given type string in 'ext', among the types added
+// by all extensions
+static uint16_t S_find_ext_type(cmark_syntax_extension *ext, const unsigned char *name,
+                                size_t len) {
+  uint16_t type;
+  const char *s;
+
+  if (!ext->get_type_string_func)
+    return 0;
+  for (type = CMARK_NODE_FOOTNOTE_DEFINITION + 1; type <= CMARK_NODE_LAST_BLOCK; type++) {
+    s = S_type_string(ext, type);
+    if (strlen(s) == len && memcmp(s, name, len) == 0)
+      return type;
+  }
+  for (type = CMARK_NODE_FOOTNOTE_REFERENCE + 1; type <= CMARK_NODE_LAST_INLINE; type++) {
+    s = S_type_string(ext, type);
+    if (strlen(s) == len && memcmp(s, name, len) == 0)
+      return type;
+  }
+  return 0;
+}
+
+static int S_ext_index(ast_writer *w, cmark_syntax_extension *ext) {
+  int i;
+
+  for (i = 0; i < w->nexts; i++) {
+    if (w->exts[i] == ext)
+      return i;
+  }
+  if (w->nexts == AST_MAX_EXTENSIONS)
+    return -1;
+  w->exts[w->nexts] = ext;
+  return w->nexts++;
+}
+
+static int S_type_index(ast_writer *w, cmark_node *node) {
+  int i, ext;
+
+  for (i = 0; i < w->ntypes; i++) {
+    if (w->types[i] == node->type)
+      return i;
+  }
+  if (w->ntypes == AST_MAX_TYPES || !node->extension ||
+      !node->extension->get_type_string_func)
+    return -1;
+  ext = S_ext_index(w, node->extension);
+  if (ext < 0)
+    return -1;
+  w->types[w->ntypes] = node->type;
+  w->type_exts[w->ntypes] = ext;
+  w->type_names[w->ntypes] = S_type_string(node->extension, node->type);
+  // the type must be found again by its type string
+  if (S_find_ext_type(node->extension, (const unsigned char *)w->type_names[w->ntypes],
+                      strlen(w->type_names[w->ntypes])) != node->type)
+    return -1;
+  return w->ntypes++;
+}
+
+// The data an extension keeps for the node, through its serialize_func
+static void S_put_extension_data(cmark_strbuf *buf, cmark_mem *mem, cmark_node *node) {
+  cmark_syntax_extension *ext = node->extension;
+  unsigned char small[64], *data = small;
+  size_t len = 0;
+
+  if (ext->serialize_func) {
+    len = ext->serialize_func(ext, node, small, sizeof(small));
+    if (len > sizeof(small)) {
+      data = (unsigned char *)mem->calloc(len, 1);
+      ext->serialize_func(ext, node, data, len);
+    }
+  }
+  S_put_bytes(buf, data, len);
+  if (data != small)
+    mem->free(data);
+}
+
+static bool S_put_node(ast_writer *w, cmark_mem *mem, cmark_node *node, int *prev_line) {
+  cmark_strbuf *buf = w->body;
+  cmark_node *child;
+  uint64_t type;
+  size_t nchildren = 0;
+
+  if (!S_is_core_type(node->type)) {
+    int ix = S_type_index(w, node);
+    if (ix < 0)
+      return false;
+    type = AST_EXT_TYPE + ix;
+  } else if ((node->type & CMARK_NODE_TYPE_MASK) == CMARK_NODE_TYPE_INLINE) {
+    type = AST_INLINE_TYPE + (node->type & 0xff);
+  } else {
+    type = node->type & 0xff;
+  }
+
+  if (node->extension) {
+    int ix = S_ext_index(w, node->extension);
+    if (ix < 0)
+      return false;
+    S_put_varint(buf, type << 1 | 1);
+    S_put_varint(buf, ix);
+  } else {
+    S_put_varint(buf, type << 1);
+  }
+
+  S_put_int(buf, (int64_t)node->start_line - *prev_line);
+  S_put_int(buf, node->start_column);
+  S_put_int(buf, (int64_t)node->end_line - node->start_line);
+  S_put_int(buf, node->end_column);
+  *prev_line = node->start_line;
+
+  for (child = node->first_child; child; child = child->next)
+    nchildren++;
+  S_put_varint(buf, nchildren);
+
+  switch (node->type) {
+  case CMARK_NODE_LIST:
+  case CMARK_NODE_ITEM:
+    S_put_varint(buf, node->as.list.list_type);
+    S_put_int(buf, node->as.list.marker_offset);
+    S_put_int(buf, node->as.list.padding);
+    S_put_int(buf, node->as.list.start);
+    S_put_varint(buf, node->as.list.delimiter);
+    S_put_varint(buf, node->as.list.bullet_char);
+    S_put_varint(buf, node->as.list.tight);
+    break;
+  case CMARK_NODE_CODE_BLOCK:
+    S_put_chunk(buf, &node->as.code.info);
+    S_put_chunk(buf, &node->as.code.literal);
+    S_put_varint(buf, node->as.code.fence_length);
+    S_put_varint(buf, node->as.code.fence_offset);
+    S_put_varint(buf, node->as.code.fence_char);
+    S_put_int(buf, node->as.code.fenced);
+    break;
+  case CMARK_NODE_HEADING:
+    S_put_int(buf, node->as.heading.level);
+    S_put_varint(buf, node->as.heading.setext);
+    break;
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_HTML_INLINE:
+  case CMARK_NODE_CODE:
+  case CMARK_NODE_HTML_BLOCK:
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    S_put_chunk(buf, &node->as.literal);
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    S_put_chunk(buf, &node->as.link.url);
+    S_put_chunk(buf, &node->as.link.title);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    S_put_chunk(buf, &node->as.custom.on_enter);
+    S_put_chunk(buf, &node->as.custom.on_exit);
+    break;
+  default:
+    break;
+  }
+
+  if (node->extension)
+    S_put_extension_data(buf, mem, node);
+  return true;
+}
+
+unsigned char *cmark_ast_save(cmark_node *root, size_t *len, cmark_mem *mem) {
+  cmark_strbuf body, out;
+  ast_writer w;
+  cmark_node *node;
+  int prev_line = 0, i;
+  bufsize_t checksum_pos;
+  uint32_t checksum;
+  bool ok = true;
+
+  if (!mem)
+    mem = cmark_get_default_mem_allocator();
+  *len = 0;
+  if (!root)
+    return NULL;
+
+  // the tree is written as parsed, also when inlines are parsed lazily
+  cmark_parse_pending_inlines(root);
+
+  memset(&w, 0, sizeof(w));
+  cmark_strbuf_init(mem, &body, 0);
+  w.body = &body;
+
+  node = root;
+  while (node && ok) {
+    ok = S_put_node(&w, mem, node, &prev_line);
+    if (node->first_child) {
+      node = node->first_child;
+      continue;
+    }
+    while (node != root && !node->next)
+      node = node->parent;
+    node = node == root ? NULL : node->next;
+  }
+
+  if (!ok) {
+    cmark_strbuf_free(&body);
+    return NULL;
+  }
+
+  cmark_strbuf_init(mem, &out, body.size + 64);
+  cmark_strbuf_put(&out, (const unsigned char *)AST_MAGIC, AST_MAGIC_LEN);
+  S_put_varint(&out, AST_VERSION);
+  checksum_pos = out.size;
+  cmark_strbuf_put(&out, (const unsigned char *)"\0\0\0\0", 4);
+  S_put_varint(&out, w.nexts);
+  for (i = 0; i < w.nexts; i++)
+    S_put_bytes(&out, (const unsigned char *)w.exts[i]->name, strlen(w.exts[i]->name));
+  S_put_varint(&out, w.ntypes);
+  for (i = 0; i < w.ntypes; i++) {
+    S_put_varint(&out, w.type_exts[i]);
+    S_put_bytes(&out, (const unsigned char *)w.type_names[i], strlen(w.type_names[i]));
+  }
+  cmark_strbuf_put(&out, body.ptr, body.size);
+  cmark_strbuf_free(&body);
+
+  checksum = S_checksum(out.ptr + checksum_pos + 4, out.size - checksum_pos - 4);
+  for (i = 0; i < 4; i++)
+    out.ptr[checksum_pos + i] = (unsigned char)(checksum >> (8 * i));
+
+  *len = out.size;
+  return cmark_strbuf_detach(&out);
+}
+
+typedef struct {
+  const unsigned char *p;
+  const unsigned char *end;
+  bool bad;
+} ast_reader;
+
+static uint64_t S_get_varint(ast_reader *r) {
+  uint64_t n = 0;
+  int shift = 0;
+
+  while (r->p < r->end && shift < 64) {
+    unsigned char c = *r->p++;
+    n |= (uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80))
+      return n;
+    shift += 7;
+  }
+  r->bad = true;
+  return 0;
+}
+
+static int S_get_int(ast_reader *r) {
+  uint64_t n = S_get_varint(r);
+  int64_t v = (int64_t)(n >> 1) ^ -(int64_t)(n & 1);
+
+  if (v < INT32_MIN || v > INT32_MAX)
+    r->bad = true;
+  return (int)v;
+}
+
+// Returns the start of 'len' bytes, or NULL if there are not as many left
+static const unsigned char *S_get_bytes(ast_reader *r, size_t *len) {
+  const unsigned char *data;
+
+  *len = S_get_varint(r);
+  if (r->bad || *len > (size_t)(r->end - r->p)) {
+    r->bad = true;
+    *len = 0;
+    return NULL;
+  }
+  data = r->p;
+  r->p += *len;
+  return data;
+}
+
+static cmark_chunk S_get_chunk(ast_reader *r, cmark_mem *mem) {
+  size_t len;
+  const unsigned char *data = S_get_bytes(r, &len);
+  cmark_chunk c;
+
+  if (len >= INT32_MAX)
+    r->bad = true;
+  if (!data || len == 0 || r->bad)
+    return cmark_chunk_literal("");
+
+  c.data = (unsigned char *)mem->calloc(len + 1, 1);
+  memcpy(c.data, data, len);
+  c.len = (bufsize_t)len;
+  c.alloc = 1;
+  return c;
+}
+
+typedef struct {
+  cmark_syntax_extension *exts[AST_MAX_EXTENSIONS];
+  int nexts;
+  uint16_t types[AST_MAX_TYPES];
+  int type_exts[AST_MAX_TYPES];
+  int ntypes;
+} ast_tables;
+
+static bool S_get_tables(ast_reader *r, ast_tables *t) {
+  uint64_t n, i;
+
+  n = S_get_varint(r);
+  if (r->bad || n > AST_MAX_EXTENSIONS)
+    return false;
+  for (i = 0; i < n; i++) {
+    char name[256];
+    size_t len;
+    const unsigned char *data = S_get_bytes(r, &len);
+    if (!data || len >= sizeof(name))
+      return false;
+    memcpy(name, data, len);
+    name[len] = 0;
+    t->exts[i] = cmark_find_syntax_extension(name);
+    if (!t->exts[i])
+      return false;
+  }
+  t->nexts = (int)n;
+
+  n = S_get_varint(r);
+  if (r->bad || n > AST_MAX_TYPES)
+    return false;
+  for (i = 0; i < n; i++) {
+    uint64_t ext = S_get_varint(r);
+    size_t len;
+    const unsigned char *name = S_get_bytes(r, &len);
+    if (!name || ext >= (uint64_t)t->nexts)
+      return false;
+    t->types[i] = S_find_ext_type(t->exts[ext], name, len);
+    t->type_exts[i] = (int)ext;
+    if (!t->types[i])
+      return false;
+  }
+  t->ntypes = (int)n;
+  return true;
+}
+
+// Reads a node without its children and appends it to 'parent', or
+// returns NULL
+static cmark_node *S_get_node(ast_reader *r, ast_tables *t, cmark_mem *mem,
+                              cmark_node *parent, int *prev_line, uint64_t *nchildren) {
+  uint64_t code = S_get_varint(r), type = code >> 1, ext = 0;
+  cmark_syntax_extension *extension = NULL;
+  cmark_node *node;
+  size_t len;
+  const unsigned char *data;
+
+  if (code & 1) {
+    ext = S_get_varint(r);
+    if (ext >= (uint64_t)t->nexts)
+      return NULL;
+    extension = t->exts[ext];
+  }
+  if (r->bad)
+    return NULL;
+  if (type >= AST_EXT_TYPE) {
+    type -= AST_EXT_TYPE;
+    // a node of an extension's type belongs to that extension
+    if (type >= (uint64_t)t->ntypes || !extension || ext != (uint64_t)t->type_exts[type])
+      return NULL;
+    type = t->types[type];
+  } else {
+    type = type >= AST_INLINE_TYPE ? CMARK_NODE_TYPE_INLINE | (type - AST_INLINE_TYPE)
+                                   : CMARK_NODE_TYPE_BLOCK | type;
+    if (!S_is_core_type((uint16_t)type))
+      return NULL;
+  }
+
+  node = (cmark_node *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_NODE, 1, sizeof(*node));
+  cmark_strbuf_init(mem, &node->content, 0);
+  node->type = (uint16_t)type;
+
+  node->start_line = *prev_line + S_get_int(r);
+  node->start_column = S_get_int(r);
+  node->end_line = node->start_line + S_get_int(r);
+  node->end_column = S_get_int(r);
+  *prev_line = node->start_line;
+  *nchildren = S_get_varint(r);
+
+  switch (node->type) {
+  case CMARK_NODE_LIST:
+  case CMARK_NODE_ITEM: {
+    uint64_t list_type = S_get_varint(r), delimiter, bullet_char;
+    node->as.list.marker_offset = S_get_int(r);
+    node->as.list.padding = S_get_int(r);
+    node->as.list.start = S_get_int(r);
+    delimiter = S_get_varint(r);
+    bullet_char = S_get_varint(r);
+    node->as.list.tight = S_get_varint(r) != 0;
+    // a checksum only catches damage, files can be crafted with any value
+    if (list_type > CMARK_ORDERED_LIST || delimiter > CMARK_PAREN_DELIM || bullet_char > 255)
+      r->bad = true;
+    node->as.list.list_type = (cmark_list_type)list_type;
+    node->as.list.delimiter = (cmark_delim_type)delimiter;
+    node->as.list.bullet_char = (unsigned char)bullet_char;
+    break;
+  }
+  case CMARK_NODE_CODE_BLOCK:
+    node->as.code.info = S_get_chunk(r, mem);
+    node->as.code.literal = S_get_chunk(r, mem);
+    node->as.code.fence_length = (uint8_t)S_get_varint(r);
+    node->as.code.fence_offset = (uint8_t)S_get_varint(r);
+    node->as.code.fence_char = (unsigned char)S_get_varint(r);
+    node->as.code.fenced = (int8_t)S_get_int(r);
+    break;
+  case CMARK_NODE_HEADING:
+    node->as.heading.level = S_get_int(r);
+    node->as.heading.setext = S_get_varint(r) != 0;
+    if (node->as.heading.level < 1 || node->as.heading.level > 6)
+      r->bad = true;
+    break;
+  case CMARK_NODE_TEXT:
+  case CMARK_NODE_HTML_INLINE:
+  case CMARK_NODE_CODE:
+  case CMARK_NODE_HTML_BLOCK:
+  case CMARK_NODE_FOOTNOTE_REFERENCE:
+  case CMARK_NODE_FOOTNOTE_DEFINITION:
+    node->as.literal = S_get_chunk(r, mem);
+    break;
+  case CMARK_NODE_LINK:
+  case CMARK_NODE_IMAGE:
+    node->as.link.url = S_get_chunk(r, mem);
+    node->as.link.title = S_get_chunk(r, mem);
+    break;
+  case CMARK_NODE_CUSTOM_BLOCK:
+  case CMARK_NODE_CUSTOM_INLINE:
+    node->as.custom.on_enter = S_get_chunk(r, mem);
+    node->as.custom.on_exit = S_get_chunk(r, mem);
+    break;
+  default:
+    break;
+  }
+
+  if (r->bad)
+    goto failure;
+
+  // the extension can check where its node is
+  if (parent) {
+    if (!cmark_node_can_contain_type(parent, (cmark_node_type)node->type))
+      goto failure;
+    node->parent = parent;
+    node->prev = parent->last_child;
+    if (parent->last_child)
+      parent->last_child->next = node;
+    else
+      parent->first_child = node;
+    parent->last_child = node;
+  }
+
+  if (extension) {
+    data = S_get_bytes(r, &len);
+    if (r->bad)
+      goto failure;
+    // the node only gets its extension when it can be freed by it
+    node->extension = extension;
+    if (extension->deserialize_func) {
+      if (!extension->deserialize_func(extension, mem, node, data, len))
+        goto failure;
+    } else if (len) {
+      goto failure;
+    }
+  }
+
+  if (r->bad)
+    goto failure;
+  return node;
+
+failure:
+  cmark_node_free(node);
+  return NULL;
+}
+
+typedef struct {
+  cmark_node *node;
+  uint64_t children;
+} ast_frame;
+
+cmark_node *cmark_ast_load(const unsigned char *data, size_t len, cmark_mem *mem) {
+  ast_reader r = {data, data + len, false};
+  ast_tables tables;
+  ast_frame *stack = NULL;
+  size_t depth = 0, size = 0;
+  cmark_node *root = NULL, *node;
+  uint64_t nchildren;
+  uint32_t checksum;
+  int prev_line = 0;
+
+  if (!mem)
+    mem = cmark_get_default_mem_allocator();
+
+  if (len < AST_MAGIC_LEN || memcmp(data, AST_MAGIC, AST_MAGIC_LEN) != 0)
+    return NULL;
+  r.p += AST_MAGIC_LEN;
+  if (S_get_varint(&r) != AST_VERSION || r.bad || r.end - r.p < 4)
+    return NULL;
+  checksum = (uint32_t)r.p[0] | (uint32_t)r.p[1] << 8 | (uint32_t)r.p[2] << 16 |
+             (uint32_t)r.p[3] << 24;
+  r.p += 4;
+  if (S_checksum(r.p, r.end - r.p) != checksum)
+    return NULL;
+  memset(&tables, 0, sizeof(tables));
+  if (!S_get_tables(&r, &tables))
+    return NULL;
+
+  root = S_get_node(&r, &tables, mem, NULL, &prev_line, &nchildren);
+  if (!root)
+    return NULL;
+  if (root->type != CMARK_NODE_DOCUMENT) {
+    cmark_node_free(root);
+    return NULL;
+  }
+
+  node = root;
+  while (1) {
+    if (nchildren) {
+      if (depth == size) {
+        size = size ? 2 * size : 64;
+        stack = (ast_frame *)mem->realloc(stack, size * sizeof(ast_frame));
+      }
+      stack[depth].node = node;
+      stack[depth].children = nchildren;
+      depth++;
+    }
+    while (depth && stack[depth - 1].children == 0)
+      depth--;
+    if (!depth)
+      break;
+
+    cmark_node *parent = stack[depth - 1].node;
+    stack[depth - 1].children--;
+    node = S_get_node(&r, &tables, mem, parent, &prev_line, &nchildren);
+    if (!node)
+      goto failure;
+  }
+
+  mem->free(stack);
+  if (r.p != r.end) {
+    cmark_node_free(root);
+    return NULL;
+  }
+  return root;
+
+failure:
+  mem->free(stack);
+  cmark_node_free(root);
+  return NULL;
+}
@@ -20,6 +20,7 @@ void cmark_syntax_extension_free(cmark_mem *mem, cmark_syntax_extension *extensi
   }
 
   cmark_llist_free(mem, extension->special_inline_chars);
+  cmark_llist_free(mem, extension->postprocess_types);
   mem->free(extension->name);
   mem->free(extension);
 }
@@ -112,6 +113,11 @@ void cmark_syntax_extension_set_xml_attr_func(cmark_syntax_extension *extension,
   extension->xml_attr_func = func;
 }
 
+void cmark_syntax_extension_set_json_attr_func(cmark_syntax_extension *extension,
+                                               cmark_json_attr_func func) {
+  extension->json_attr_func = func;
+}
+
 void cmark_syntax_extension_set_man_render_func(cmark_syntax_extension *extension,
                                                 cmark_common_render_func func) {
   extension->man_render_func = func;
@@ -132,6 +138,27 @@ void cmark_syntax_extension_set_postprocess_func(cmark_syntax_extension *extensi
   extension->postprocess_func = func;
 }
 
+void cmark_syntax_extension_set_postprocess_node_func(cmark_syntax_extension *extension,
+                                                      cmark_postprocess_node_func func) {
+  extension->postprocess_node_func = func;
+}
+
+void cmark_syntax_extension_add_postprocess_type(cmark_syntax_extension *extension,
+                                                 cmark_node_type type) {
+  extension->postprocess_types = cmark_llist_append(_mem, extension->postprocess_types,
+                                                    (void *)(size_t)type);
+}
+
+void cmark_syntax_extension_set_serialize_func(cmark_syntax_extension *extension,
+                                               cmark_serialize_func func) {
+  extension->serialize_func = func;
+}
+
+void cmark_syntax_extension_set_deserialize_func(cmark_syntax_extension *extension,
+                                                 cmark_deserialize_func func) {
+  extension->deserialize_func = func;
+}
+
 #ifdef REGISTRY_CHECKS
 void cmark_syntax_extension_set_post_reg_callback_func(cmark_syntax_extension *extension,
                                                       cmark_post_reg_callback_func func) {
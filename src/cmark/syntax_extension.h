@@ -23,13 +23,18 @@ struct cmark_syntax_extension {
   cmark_common_render_func        plaintext_render_func;
   cmark_common_render_func        latex_render_func;
   cmark_xml_attr_func             xml_attr_func;
+  cmark_json_attr_func            json_attr_func;
   cmark_common_render_func        man_render_func;
   cmark_html_render_func          html_render_func;
   cmark_html_filter_func          html_filter_func;
   cmark_postprocess_func          postprocess_func;
+  cmark_postprocess_node_func     postprocess_node_func;
+  cmark_llist                   * postprocess_types;
   cmark_opaque_alloc_func         opaque_alloc_func;
   cmark_opaque_free_func          opaque_free_func;
   cmark_commonmark_escape_func    commonmark_escape_func;
+  cmark_serialize_func            serialize_func;
+  cmark_deserialize_func          deserialize_func;
 #ifdef REGISTRY_CHECKS
   cmark_post_reg_callback_func    post_reg_callback_func;
 #endif
@@ -0,0 +1,198 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cmark-gfm.h"
+#include "syntax_extension.h"
+#include "timings.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Phases and extensions are few, so a small table with linear lookup
+#define MAX_TIMINGS 64
+
+static cmark_timing timings[MAX_TIMINGS];
+static size_t ntimings = 0;
+static cmark_ext_timing ext_timings[MAX_TIMINGS];
+static size_t next_timings = 0;
+
+uint64_t cmark_timer_now(void) {
+#ifdef _WIN32
+  LARGE_INTEGER count, freq;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  return (uint64_t)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#ifdef CMARK_TIMINGS
+
+int cmark_timings_flags = 0;
+static int running = 0;
+
+uint64_t cmark_timer_start(void) {
+  if (!(cmark_timings_flags & CMARK_TIMINGS_PHASES) || running)
+    return 0;
+#ifdef _OPENMP
+  if (omp_in_parallel())
+    return 0;
+#endif
+  running = 1;
+  return cmark_timer_now();
+}
+
+void cmark_timer_stop(uint64_t start, cmark_phase phase, const char *name) {
+  uint64_t elapsed = cmark_timer_now() - start;
+  size_t i;
+
+  running = 0;
+  for (i = 0; i < ntimings; i++) {
+    if (timings[i].phase == phase &&
+        (timings[i].name == name ||
+         (name && timings[i].name && strcmp(timings[i].name, name) == 0)))
+      break;
+  }
+  if (i == ntimings) {
+    if (ntimings == MAX_TIMINGS)
+      return;
+    timings[i].phase = phase;
+    timings[i].name = name;
+    ntimings++;
+  }
+  timings[i].ns += elapsed;
+  timings[i].count++;
+}
+
+// Extensions are keyed by their name pointer, which they own
+void cmark_ext_timer_stop(uint64_t start, cmark_syntax_extension *ext,
+                          cmark_ext_callback callback) {
+  uint64_t elapsed = cmark_timer_now() - start;
+  size_t i;
+
+#ifdef _OPENMP
+#pragma omp critical(cmark_ext_timings)
+#endif
+  {
+    for (i = 0; i < next_timings; i++) {
+      if (ext_timings[i].name == ext->name && ext_timings[i].callback == callback)
+        break;
+    }
+    if (i == next_timings && next_timings < MAX_TIMINGS) {
+      ext_timings[i].name = ext->name;
+      ext_timings[i].callback = callback;
+      next_timings++;
+    }
+    if (i < next_timings) {
+      ext_timings[i].ns += elapsed;
+      ext_timings[i].count++;
+    }
+  }
+}
+
+int cmark_timings_available(void) { return 1; }
+
+void cmark_timings_enable(int flags) { cmark_timings_flags = flags; }
+
+#else
+
+int cmark_timings_available(void) { return 0; }
+
+void cmark_timings_enable(int flags) { (void)flags; }
+
+#endif
+
+void cmark_timings_reset(void) {
+  memset(timings, 0, sizeof(timings));
+  ntimings = 0;
+  memset(ext_timings, 0, sizeof(ext_timings));
+  next_timings = 0;
+}
+
+size_t cmark_timings_get(const cmark_timing **result) {
+  *result = timings;
+  return ntimings;
+}
+
+size_t cmark_ext_timings_get(const cmark_ext_timing **result) {
+  *result = ext_timings;
+  return next_timings;
+}
+
+const char *cmark_phase_name(cmark_phase phase) {
+  switch (phase) {
+  case CMARK_PHASE_BLOCKS:
+    return "blocks";
+  case CMARK_PHASE_FINALIZE:
+    return "finalize";
+  case CMARK_PHASE_INLINES:
+    return "inlines";
+  case CMARK_PHASE_FOOTNOTES:
+    return "footnotes";
+  case CMARK_PHASE_CONSOLIDATE:
+    return "consolidate";
+  case CMARK_PHASE_POSTPROCESS:
+    return "postprocess";
+  case CMARK_PHASE_RENDER:
+    return "render";
+  default:
+    return "unknown";
+  }
+}
+
+const char *cmark_ext_callback_name(cmark_ext_callback callback) {
+  switch (callback) {
+  case CMARK_EXT_TRY_OPENING_BLOCK:
+    return "try_opening_block";
+  case CMARK_EXT_LAST_BLOCK_MATCHES:
+    return "last_block_matches";
+  case CMARK_EXT_MATCH_INLINE:
+    return "match_inline";
+  case CMARK_EXT_INSERT_INLINE_FROM_DELIM:
+    return "insert_inline_from_delim";
+  case CMARK_EXT_POSTPROCESS:
+    return "postprocess";
+  case CMARK_EXT_CONTAINS_INLINES:
+    return "contains_inlines";
+  case CMARK_EXT_CAN_CONTAIN:
+    return "can_contain";
+  case CMARK_EXT_GET_TYPE_STRING:
+    return "get_type_string";
+  case CMARK_EXT_OPAQUE_ALLOC:
+    return "opaque_alloc";
+  case CMARK_EXT_OPAQUE_FREE:
+    return "opaque_free";
+  case CMARK_EXT_HTML_RENDER:
+    return "html_render";
+  case CMARK_EXT_HTML_FILTER:
+    return "html_filter";
+  case CMARK_EXT_XML_ATTR:
+    return "xml_attr";
+  case CMARK_EXT_JSON_ATTR:
+    return "json_attr";
+  case CMARK_EXT_COMMONMARK_RENDER:
+    return "commonmark_render";
+  case CMARK_EXT_COMMONMARK_ESCAPE:
+    return "commonmark_escape";
+  case CMARK_EXT_LATEX_RENDER:
+    return "latex_render";
+  case CMARK_EXT_MAN_RENDER:
+    return "man_render";
+  case CMARK_EXT_PLAINTEXT_RENDER:
+    return "plaintext_render";
+  default:
+    return "unknown";
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef CMARK_TIMINGS_H
+#define CMARK_TIMINGS_H
+
+#include "cmark-gfm.h"
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Monotonic clock in nanoseconds, also available without -DCMARK_TIMINGS
+uint64_t cmark_timer_now(void);
+
+// Phase and extension timers, compiled in with -DCMARK_TIMINGS.
+// CMARK_TIMER_START declares a start time which is 0 when nothing is
+// recorded: timings are disabled, another phase is already running, or
+// we are inside a parallel region. Extension timers may run on any
+// thread, and around every call of an extension callback.
+#ifdef CMARK_TIMINGS
+
+extern int cmark_timings_flags;
+
+uint64_t cmark_timer_start(void);
+void cmark_timer_stop(uint64_t start, cmark_phase phase, const char *name);
+void cmark_ext_timer_stop(uint64_t start, cmark_syntax_extension *ext,
+                          cmark_ext_callback callback);
+
+#define CMARK_TIMER_START(t) uint64_t t = cmark_timer_start()
+#define CMARK_TIMER_STOP(t, phase, name)                                       \
+  do {                                                                         \
+    if (t)                                                                     \
+      cmark_timer_stop(t, phase, name);                                        \
+  } while (0)
+
+#define CMARK_EXT_TIMER_START(t)                                               \
+  uint64_t t = (cmark_timings_flags & CMARK_TIMINGS_EXTENSIONS)                \
+                   ? cmark_timer_now()                                         \
+                   : 0
+#define CMARK_EXT_TIMER_STOP(t, ext, callback)                                 \
+  do {                                                                         \
+    if (t)                                                                     \
+      cmark_ext_timer_stop(t, ext, callback);                                  \
+  } while (0)
+
+#else
+
+#define CMARK_TIMER_START(t)
+#define CMARK_TIMER_STOP(t, phase, name)
+#define CMARK_EXT_TIMER_START(t)
+#define CMARK_EXT_TIMER_STOP(t, ext, callback)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
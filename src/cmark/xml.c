@@ -9,6 +9,7 @@
 #include "buffer.h"
 #include "houdini.h"
 #include "syntax_extension.h"
+#include "timings.h"
 
 #define BUFFER_SIZE 100
 
@@ -52,7 +53,9 @@ static int S_render_node(cmark_node *node, cmark_event_type ev_type,
     }
 
     if (node->extension && node->extension->xml_attr_func) {
+      CMARK_EXT_TIMER_START(timer);
       const char* r = node->extension->xml_attr_func(node->extension, node);
+      CMARK_EXT_TIMER_STOP(timer, node->extension, CMARK_EXT_XML_ATTR);
       if (r != NULL)
         cmark_strbuf_puts(xml, r);
     }
@@ -136,7 +139,8 @@ static int S_render_node(cmark_node *node, cmark_event_type ev_type,
     default:
       break;
     }
-    if (node->first_child) {
+    // parses the inlines of a lazy leaf, as the iterator would next
+    if (cmark_node_first_child(node)) {
       state->indent += 2;
     } else if (!literal) {
       cmark_strbuf_puts(xml, " /");
@@ -164,6 +168,7 @@ char *cmark_render_xml_with_mem(cmark_node *root, int options, cmark_mem *mem) {
   cmark_event_type ev_type;
   cmark_node *cur;
   struct render_state state = {&xml, 0};
+  CMARK_TIMER_START(timer);
 
   cmark_iter *iter = cmark_iter_new(root);
 
@@ -177,5 +182,6 @@ char *cmark_render_xml_with_mem(cmark_node *root, int options, cmark_mem *mem) {
   result = (char *)cmark_strbuf_detach(&xml);
 
   cmark_iter_free(iter);
+  CMARK_TIMER_STOP(timer, CMARK_PHASE_RENDER, NULL);
   return result;
 }
@@ -269,144 +269,127 @@ static cmark_node *match(cmark_syntax_extension *ext, cmark_parser *parser,
   // inline was finished in inlines.c.
 }
 
-static void postprocess_text(cmark_parser *parser, cmark_node *text, int offset, int depth) {
-  // postprocess_text can recurse very deeply if there is a very long line of
-  // '@' only.  Stop at a reasonable depth to ensure it cannot crash.
-  if (depth > 1000) return;
+// Links the email addresses in a text node. The text is scanned once from
+// left to right, and the pieces between the links are only copied into
+// their own nodes at the end, so long runs of '@' or of addresses stay
+// linear.
+static void postprocess_text(cmark_parser *parser, cmark_node *text) {
+  uint8_t *data = text->as.literal.data;
+  size_t size = text->as.literal.len, offset = 0, split = 0, link_end, at;
+  bufsize_t first = -1;
+  cmark_node *last = text;
+  int rewind, max_rewind, nb, np, ns;
+
+  while (offset < size) {
+    uint8_t *p = (uint8_t *)memchr(data + offset, '@', size - offset);
+    if (!p)
+      break;
 
-  size_t link_end;
-  uint8_t *data = text->as.literal.data,
-    *at;
-  size_t size = text->as.literal.len;
-  int rewind, max_rewind,
-      nb = 0, np = 0, ns = 0;
+    at = (size_t)(p - data);
+    max_rewind = (int)(at - offset);
+    // where the next address may start if this one is not linked
+    offset = at + 1;
+    ns = 0;
 
-  if (offset < 0 || (size_t)offset >= size)
-    return;
+    for (rewind = 0; rewind < max_rewind; ++rewind) {
+      uint8_t c = data[at - rewind - 1];
 
-  data += offset;
-  size -= offset;
+      if (cmark_isalnum(c))
+        continue;
 
-  at = (uint8_t *)memchr(data, '@', size);
-  if (!at)
-    return;
+      if (strchr(".+-_", c) != NULL)
+        continue;
 
-  max_rewind = (int)(at - data);
-  data += max_rewind;
-  size -= max_rewind;
+      if (c == '/')
+        ns++;
 
-  for (rewind = 0; rewind < max_rewind; ++rewind) {
-    uint8_t c = data[-rewind - 1];
+      break;
+    }
 
-    if (cmark_isalnum(c))
+    if (rewind == 0 || ns > 0)
       continue;
 
-    if (strchr(".+-_", c) != NULL)
-      continue;
+    nb = np = 0;
+    for (link_end = 0; at + link_end < size; ++link_end) {
+      uint8_t c = data[at + link_end];
 
-    if (c == '/')
-      ns++;
+      if (cmark_isalnum(c))
+        continue;
 
-    break;
-  }
+      // a second '@' rules the address out, no need to scan further
+      if (c == '@') {
+        if (++nb > 1)
+          break;
+      } else if (c == '.' && at + link_end < size - 1 && cmark_isalnum(data[at + link_end + 1]))
+        np++;
+      else if (c != '-' && c != '_')
+        break;
+    }
 
-  if (rewind == 0 || ns > 0) {
-    postprocess_text(parser, text, max_rewind + 1 + offset, depth + 1);
-    return;
-  }
+    if (link_end < 2 || nb != 1 || np == 0 ||
+        (!cmark_isalpha(data[at + link_end - 1]) && data[at + link_end - 1] != '.'))
+      continue;
 
-  for (link_end = 0; link_end < size; ++link_end) {
-    uint8_t c = data[link_end];
+    link_end = autolink_delim(data + at, link_end);
 
-    if (cmark_isalnum(c))
+    if (link_end == 0)
       continue;
 
-    if (c == '@')
-      nb++;
-    else if (c == '.' && link_end < size - 1 && cmark_isalnum(data[link_end + 1]))
-      np++;
-    else if (c != '-' && c != '_')
-      break;
-  }
+    if (first < 0) {
+      cmark_chunk_to_cstr(parser->mem, &text->as.literal);
+      data = text->as.literal.data;
+      first = (bufsize_t)(at - rewind);
+    } else {
+      cmark_node *between = cmark_node_new_with_mem(CMARK_NODE_TEXT, parser->mem);
+      between->as.literal = cmark_chunk_dup(&text->as.literal, (bufsize_t)split,
+                                            (bufsize_t)(at - rewind - split));
+      cmark_chunk_to_cstr(parser->mem, &between->as.literal);
+      cmark_node_insert_after(last, between);
+      last = between;
+    }
 
-  if (link_end < 2 || nb != 1 || np == 0 ||
-      (!cmark_isalpha(data[link_end - 1]) && data[link_end - 1] != '.')) {
-    postprocess_text(parser, text, max_rewind + 1 + offset, depth + 1);
-    return;
+    cmark_node *link_node = cmark_node_new_with_mem(CMARK_NODE_LINK, parser->mem);
+    cmark_strbuf buf;
+    cmark_strbuf_init(parser->mem, &buf, 10);
+    cmark_strbuf_puts(&buf, "mailto:");
+    cmark_strbuf_put(&buf, data + at - rewind, (bufsize_t)(link_end + rewind));
+    link_node->as.link.url = cmark_chunk_buf_detach(&buf);
+
+    cmark_node *link_text = cmark_node_new_with_mem(CMARK_NODE_TEXT, parser->mem);
+    cmark_chunk email = cmark_chunk_dup(
+        &text->as.literal,
+        (bufsize_t)(at - rewind),
+        (bufsize_t)(link_end + rewind));
+    cmark_chunk_to_cstr(parser->mem, &email);
+    link_text->as.literal = email;
+    cmark_node_append_child(link_node, link_text);
+
+    cmark_node_insert_after(last, link_node);
+    last = link_node;
+
+    split = offset = at + link_end;
   }
 
-  link_end = autolink_delim(data, link_end);
-
-  if (link_end == 0) {
-    postprocess_text(parser, text, max_rewind + 1 + offset, depth + 1);
+  if (first < 0)
     return;
-  }
-
-  cmark_chunk_to_cstr(parser->mem, &text->as.literal);
-
-  cmark_node *link_node = cmark_node_new_with_mem(CMARK_NODE_LINK, parser->mem);
-  cmark_strbuf buf;
-  cmark_strbuf_init(parser->mem, &buf, 10);
-  cmark_strbuf_puts(&buf, "mailto:");
-  cmark_strbuf_put(&buf, data - rewind, (bufsize_t)(link_end + rewind));
-  link_node->as.link.url = cmark_chunk_buf_detach(&buf);
-
-  cmark_node *link_text = cmark_node_new_with_mem(CMARK_NODE_TEXT, parser->mem);
-  cmark_chunk email = cmark_chunk_dup(
-      &text->as.literal,
-      offset + max_rewind - rewind,
-      (bufsize_t)(link_end + rewind));
-  cmark_chunk_to_cstr(parser->mem, &email);
-  link_text->as.literal = email;
-  cmark_node_append_child(link_node, link_text);
-
-  cmark_node_insert_after(text, link_node);
 
   cmark_node *post = cmark_node_new_with_mem(CMARK_NODE_TEXT, parser->mem);
-  post->as.literal = cmark_chunk_dup(&text->as.literal,
-    (bufsize_t)(offset + max_rewind + link_end),
-    (bufsize_t)(size - link_end));
+  post->as.literal = cmark_chunk_dup(&text->as.literal, (bufsize_t)split,
+                                     (bufsize_t)(size - split));
   cmark_chunk_to_cstr(parser->mem, &post->as.literal);
+  cmark_node_insert_after(last, post);
 
-  cmark_node_insert_after(link_node, post);
-
-  text->as.literal.len = offset + max_rewind - rewind;
-  text->as.literal.data[text->as.literal.len] = 0;
-
-  postprocess_text(parser, post, 0, depth + 1);
+  text->as.literal.len = first;
+  text->as.literal.data[first] = 0;
 }
 
-static cmark_node *postprocess(cmark_syntax_extension *ext, cmark_parser *parser, cmark_node *root) {
-  cmark_iter *iter;
-  cmark_event_type ev;
-  cmark_node *node;
-  bool in_link = false;
-
-  cmark_consolidate_text_nodes(root);
-  iter = cmark_iter_new(root);
-
-  while ((ev = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
-    node = cmark_iter_get_node(iter);
-    if (in_link) {
-      if (ev == CMARK_EVENT_EXIT && node->type == CMARK_NODE_LINK) {
-        in_link = false;
-      }
-      continue;
-    }
-
-    if (ev == CMARK_EVENT_ENTER && node->type == CMARK_NODE_LINK) {
-      in_link = true;
-      continue;
-    }
-
-    if (ev == CMARK_EVENT_ENTER && node->type == CMARK_NODE_TEXT) {
-      postprocess_text(parser, node, 0, /*depth*/0);
-    }
-  }
-
-  cmark_iter_free(iter);
+// Visits text outside of links
+static int postprocess(cmark_syntax_extension *ext, cmark_parser *parser, cmark_node *node) {
+  if (node->type == CMARK_NODE_LINK)
+    return 0;
 
-  return root;
+  postprocess_text(parser, node);
+  return 1;
 }
 
 cmark_syntax_extension *create_autolink_extension(void) {
@@ -414,7 +397,9 @@ cmark_syntax_extension *create_autolink_extension(void) {
   cmark_llist *special_chars = NULL;
 
   cmark_syntax_extension_set_match_inline_func(ext, match);
-  cmark_syntax_extension_set_postprocess_func(ext, postprocess);
+  cmark_syntax_extension_set_postprocess_node_func(ext, postprocess);
+  cmark_syntax_extension_add_postprocess_type(ext, CMARK_NODE_TEXT);
+  cmark_syntax_extension_add_postprocess_type(ext, CMARK_NODE_LINK);
 
   cmark_mem *mem = cmark_get_default_mem_allocator();
   special_chars = cmark_llist_append(mem, special_chars, (void *)':');
@@ -1,25 +1,35 @@
-/* Generated by re2c 0.15.3 */
+/* Originally generated by re2c 0.15.3 from ext_scanners.re, which is not
+ * part of this tree; the file is now maintained by hand. The generated code
+ * was converted to bounded scanners: each takes (p, end) and reads through
+ * yypeek(), which returns a NUL at 'end' instead of relying on a NUL
+ * sentinel written over the input. table_cell accepts NUL, so it reads
+ * through yypeek_cell(), which returns a line ending at 'end'. Regenerating
+ * this file from upstream re2c sources would bring back the read past the
+ * end of the buffer in table_cell, so apply any change by hand. */
 #include <stdlib.h>
 #include "ext_scanners.h"
 
-bufsize_t _ext_scan_at(bufsize_t (*scanner)(const unsigned char *),
-                       unsigned char *ptr, int len, bufsize_t offset) {
-  bufsize_t res;
-
-  if (ptr == NULL || offset > len) {
+bufsize_t _ext_scan_at(bufsize_t (*scanner)(const unsigned char *, const unsigned char *),
+                       const unsigned char *ptr, int len, bufsize_t offset) {
+  if (ptr == NULL || offset > len)
     return 0;
-  } else {
-    unsigned char lim = ptr[len];
 
-    ptr[len] = '\0';
-    res = scanner(ptr + offset);
-    ptr[len] = lim;
-  }
+  return scanner(ptr + offset, ptr + len);
+}
+
+// Reads past 'end' return a NUL, which none of the patterns accept
+static CMARK_INLINE unsigned char yypeek(const unsigned char *p,
+                                         const unsigned char *end) {
+  return p < end ? *p : 0;
+}
 
-  return res;
+// table_cell accepts NUL, so its reads past 'end' return a line ending
+static CMARK_INLINE unsigned char yypeek_cell(const unsigned char *p,
+                                              const unsigned char *end) {
+  return p < end ? *p : '\n';
 }
 
-bufsize_t _scan_table_start(const unsigned char *p) {
+bufsize_t _scan_table_start(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -39,7 +49,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
         0, 0,   0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 0,   0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0,
     };
-    yych = *(marker = p);
+    yych = yypeek(marker = p, end);
     if (yych <= '{') {
       if (yych <= 0x1F) {
         if (yych <= '\t') {
@@ -97,7 +107,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     }
   yy2 : { return 0; }
   yy3:
-    yych = *(marker = ++p);
+    yych = yypeek(marker = ++p, end);
     if (yybm[0 + yych] & 128) {
       goto yy22;
     }
@@ -119,13 +129,13 @@ bufsize_t _scan_table_start(const unsigned char *p) {
       }
     }
   yy4:
-    yych = *(marker = ++p);
+    yych = yypeek(marker = ++p, end);
     if (yybm[0 + yych] & 128) {
       goto yy22;
     }
     goto yy2;
   yy5:
-    yych = *(marker = ++p);
+    yych = yypeek(marker = ++p, end);
     if (yybm[0 + yych] & 128) {
       goto yy22;
     }
@@ -149,10 +159,10 @@ bufsize_t _scan_table_start(const unsigned char *p) {
       }
     }
   yy6:
-    yych = *++p;
+    yych = yypeek(++p, end);
     goto yy2;
   yy7:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy8;
     if (yych <= 0xBF)
@@ -161,42 +171,42 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     p = marker;
     goto yy2;
   yy9:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x9F)
       goto yy8;
     if (yych <= 0xBF)
       goto yy7;
     goto yy8;
   yy10:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy8;
     if (yych <= 0xBF)
       goto yy7;
     goto yy8;
   yy11:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x8F)
       goto yy8;
     if (yych <= 0xBF)
       goto yy10;
     goto yy8;
   yy12:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy8;
     if (yych <= 0xBF)
       goto yy10;
     goto yy8;
   yy13:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy8;
     if (yych <= 0x8F)
       goto yy10;
     goto yy8;
   yy14:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy8;
     if (yych <= 0x9F)
@@ -204,7 +214,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     goto yy8;
   yy15:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
   yy16:
     if (yybm[0 + yych] & 64) {
       goto yy15;
@@ -221,7 +231,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     }
   yy17:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     if (yych <= 0x1F) {
       if (yych <= '\n') {
         if (yych <= 0x08)
@@ -249,7 +259,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
       }
     }
   yy19:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych != '\n')
       goto yy8;
   yy20:
@@ -257,7 +267,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     { return (bufsize_t)(p - start); }
   yy22:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     if (yybm[0 + yych] & 128) {
       goto yy22;
     }
@@ -290,12 +300,12 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     }
   yy24:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     if (yych != '-')
       goto yy8;
   yy25:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     if (yych <= ' ') {
       if (yych <= '\n') {
         if (yych <= 0x08)
@@ -325,7 +335,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     }
   yy27:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     if (yych <= '\r') {
       if (yych <= '\t') {
         if (yych <= 0x08)
@@ -351,7 +361,7 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     }
   yy29:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     if (yybm[0 + yych] & 128) {
       goto yy22;
     }
@@ -373,14 +383,14 @@ bufsize_t _scan_table_start(const unsigned char *p) {
     }
   yy31:
     ++p;
-    if (yybm[0 + (yych = *p)] & 128) {
+    if (yybm[0 + (yych = yypeek(p, end))] & 128) {
       goto yy22;
     }
     goto yy8;
   }
 }
 
-bufsize_t _scan_table_cell(const unsigned char *p) {
+bufsize_t _scan_table_cell(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -407,7 +417,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
         0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
         0,   0,   0,   0,
     };
-    yych = *(marker = p);
+    yych = yypeek_cell(marker = p, end);
     if (yych <= 0x7F) {
       if (yych <= '\r') {
         if (yych == '\n')
@@ -453,15 +463,15 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     }
   yy34 : { return (bufsize_t)(p - start); }
   yy35:
-    yych = *(marker = ++p);
+    yych = yypeek_cell(marker = ++p, end);
     if (yych == '|')
       goto yy49;
     goto yy50;
   yy36:
-    yych = *(marker = ++p);
+    yych = yypeek_cell(marker = ++p, end);
     goto yy50;
   yy37:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0xBF)
@@ -470,42 +480,42 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     p = marker;
     goto yy34;
   yy39:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x9F)
       goto yy38;
     if (yych <= 0xBF)
       goto yy37;
     goto yy38;
   yy40:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0xBF)
       goto yy37;
     goto yy38;
   yy41:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x8F)
       goto yy38;
     if (yych <= 0xBF)
       goto yy40;
     goto yy38;
   yy42:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0xBF)
       goto yy40;
     goto yy38;
   yy43:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0x8F)
       goto yy40;
     goto yy38;
   yy44:
-    yych = *++p;
+    yych = yypeek_cell(++p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0x9F)
@@ -516,7 +526,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     { return 0; }
   yy47:
     marker = ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yybm[0 + yych] & 64) {
       goto yy47;
     }
@@ -552,7 +562,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     }
   yy49:
     marker = ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
   yy50:
     if (yybm[0 + yych] & 128) {
       goto yy49;
@@ -588,7 +598,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     }
   yy51:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0xBF)
@@ -596,7 +606,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy38;
   yy52:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x9F)
       goto yy38;
     if (yych <= 0xBF)
@@ -604,7 +614,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy38;
   yy53:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0xBF)
@@ -612,7 +622,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy38;
   yy54:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x8F)
       goto yy38;
     if (yych <= 0xBF)
@@ -620,7 +630,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy38;
   yy55:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0xBF)
@@ -628,7 +638,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy38;
   yy56:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0x8F)
@@ -636,7 +646,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
     goto yy38;
   yy57:
     ++p;
-    yych = *p;
+    yych = yypeek_cell(p, end);
     if (yych <= 0x7F)
       goto yy38;
     if (yych <= 0x9F)
@@ -645,7 +655,7 @@ bufsize_t _scan_table_cell(const unsigned char *p) {
   }
 }
 
-bufsize_t _scan_table_cell_end(const unsigned char *p) {
+bufsize_t _scan_table_cell_end(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -667,7 +677,7 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0,
     };
-    yych = *(marker = p);
+    yych = yypeek(marker = p, end);
     if (yych <= 0xDF) {
       if (yych <= '{') {
         if (yych != '\n')
@@ -699,14 +709,14 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
   yy60 : { return 0; }
   yy61:
     yyaccept = 1;
-    yych = *(marker = ++p);
+    yych = yypeek(marker = ++p, end);
     goto yy73;
   yy62 : { return (bufsize_t)(p - start); }
   yy63:
-    yych = *++p;
+    yych = yypeek(++p, end);
     goto yy60;
   yy64:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy65;
     if (yych <= 0xBF)
@@ -719,42 +729,42 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
       goto yy62;
     }
   yy66:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x9F)
       goto yy65;
     if (yych <= 0xBF)
       goto yy64;
     goto yy65;
   yy67:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy65;
     if (yych <= 0xBF)
       goto yy64;
     goto yy65;
   yy68:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x8F)
       goto yy65;
     if (yych <= 0xBF)
       goto yy67;
     goto yy65;
   yy69:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy65;
     if (yych <= 0xBF)
       goto yy67;
     goto yy65;
   yy70:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy65;
     if (yych <= 0x8F)
       goto yy67;
     goto yy65;
   yy71:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy65;
     if (yych <= 0x9F)
@@ -763,7 +773,7 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
   yy72:
     yyaccept = 1;
     marker = ++p;
-    yych = *p;
+    yych = yypeek(p, end);
   yy73:
     if (yybm[0 + yych] & 128) {
       goto yy72;
@@ -774,17 +784,17 @@ bufsize_t _scan_table_cell_end(const unsigned char *p) {
       goto yy75;
     if (yych >= 0x0E)
       goto yy62;
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych != '\n')
       goto yy65;
   yy75:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
     goto yy62;
   }
 }
 
-bufsize_t _scan_table_row_end(const unsigned char *p) {
+bufsize_t _scan_table_row_end(const unsigned char *p, const unsigned char *end) {
   const unsigned char *marker = NULL;
   const unsigned char *start = p;
 
@@ -805,7 +815,7 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0, 0, 0, 0, 0,
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,   0,   0, 0, 0,
     };
-    yych = *(marker = p);
+    yych = yypeek(marker = p, end);
     if (yych <= 0xC1) {
       if (yych <= '\f') {
         if (yych <= 0x08)
@@ -849,7 +859,7 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
     }
   yy78 : { return 0; }
   yy79:
-    yych = *(marker = ++p);
+    yych = yypeek(marker = ++p, end);
     if (yych <= 0x08)
       goto yy78;
     if (yych <= '\r')
@@ -858,17 +868,17 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
       goto yy94;
     goto yy78;
   yy80:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych != '\n')
       goto yy78;
   yy81:
     ++p;
     { return (bufsize_t)(p - start); }
   yy83:
-    yych = *++p;
+    yych = yypeek(++p, end);
     goto yy78;
   yy84:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy85;
     if (yych <= 0xBF)
@@ -877,55 +887,55 @@ bufsize_t _scan_table_row_end(const unsigned char *p) {
     p = marker;
     goto yy78;
   yy86:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x9F)
       goto yy85;
     if (yych <= 0xBF)
       goto yy84;
     goto yy85;
   yy87:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy85;
     if (yych <= 0xBF)
       goto yy84;
     goto yy85;
   yy88:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x8F)
       goto yy85;
     if (yych <= 0xBF)
       goto yy87;
     goto yy85;
   yy89:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy85;
     if (yych <= 0xBF)
       goto yy87;
     goto yy85;
   yy90:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy85;
     if (yych <= 0x8F)
       goto yy87;
     goto yy85;
   yy91:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych <= 0x7F)
       goto yy85;
     if (yych <= 0x9F)
       goto yy84;
     goto yy85;
   yy92:
-    yych = *++p;
+    yych = yypeek(++p, end);
     if (yych == '\n')
       goto yy81;
     goto yy85;
   yy93:
     ++p;
-    yych = *p;
+    yych = yypeek(p, end);
   yy94:
     if (yybm[0 + yych] & 128) {
       goto yy93;
@@ -82,7 +82,6 @@ static cmark_node *match(cmark_syntax_extension *self, cmark_parser *parser,
     res = cmark_node_new_with_mem(CMARK_NODE_TEXT, parser->mem);
     cmark_node_set_literal(res, buffer);
 
-    cmark_node_set_string_content(res, cmark_chunk_to_cstr(parser->mem, cmark_inline_parser_get_chunk(inline_parser)));
     res->start_line = res->end_line = cmark_inline_parser_get_line(inline_parser);
     res->internal_offset = cmark_inline_parser_get_offset(inline_parser);
     res->start_column = cmark_inline_parser_get_column(inline_parser) - delims;
@@ -125,17 +124,15 @@ static delimiter *insert(cmark_syntax_extension *self, cmark_parser *parser,
 
   parser_input = cmark_inline_parser_get_chunk(inline_parser);
   iptchk = cmark_chunk_dup(parser_input, start_pos, end_pos - start_pos);
+  // freed when done, after it is copied into the node
   target = cmark_chunk_to_cstr(parser->mem, &iptchk);
-  cmark_chunk_free(parser->mem, &iptchk);
 
 #ifdef DEBUG
   Rprintf("Inserting delimiter $ of length %d.\n", opener->length);
-  Rprintf("  opener: content = \"%s\", literal = \"%s\", offset = %d.\n",
-          cmark_node_get_string_content(math),
+  Rprintf("  opener: literal = \"%s\", offset = %d.\n",
           cmark_node_get_literal(math),
           math->internal_offset);
-  Rprintf("  closer: content = \"%s\", literal = \"%s\", offset = %d.\n",
-          cmark_node_get_string_content(cmath),
+  Rprintf("  closer: literal = \"%s\", offset = %d.\n",
           cmark_node_get_literal(cmath),
           cmath->internal_offset);
 
@@ -222,6 +219,7 @@ static delimiter *insert(cmark_syntax_extension *self, cmark_parser *parser,
   cmark_inline_parser_remove_delimiter(inline_parser, opener);
 
   done:
+    cmark_chunk_free(parser->mem, &iptchk);
     return res;
 }
 
@@ -376,6 +374,23 @@ static void plaintext_render(cmark_syntax_extension *extension,
   }
 }
 
+// The math type of a node is saved as one byte
+static size_t serialize(cmark_syntax_extension *self, cmark_node *node,
+                        unsigned char *buf, size_t size) {
+  const math_type *t = (const math_type *) cmark_node_get_user_data(node);
+  if (size)
+    buf[0] = t ? (unsigned char) *t : unknown_math;
+  return 1;
+}
+
+static int deserialize(cmark_syntax_extension *self, cmark_mem *mem,
+                       cmark_node *node, const unsigned char *data, size_t len) {
+  if (len != 1 || data[0] >= sizeof(math_types) / sizeof(math_types[0]))
+    return 0;
+  cmark_node_set_user_data(node, (void *)(math_types + data[0]));
+  return 1;
+}
+
 #ifdef REGISTRY_CHECKS
 static bool contain_test(unsigned id) {
   for (int i = 0; i < n_compat; i++) {
@@ -406,6 +421,8 @@ cmark_syntax_extension *create_math_extension(void) {
   cmark_syntax_extension_set_latex_render_func(ext, latex_render);
   cmark_syntax_extension_set_html_render_func(ext, html_render);
   cmark_syntax_extension_set_plaintext_render_func(ext, plaintext_render);
+  cmark_syntax_extension_set_serialize_func(ext, serialize);
+  cmark_syntax_extension_set_deserialize_func(ext, deserialize);
 
 #ifdef REGISTRY_CHECKS
   cmark_syntax_extension_set_post_reg_callback_func(ext, postreg_callback);
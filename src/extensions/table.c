@@ -5,6 +5,7 @@
 #include <references.h>
 #include <string.h>
 #include <render.h>
+#include <mem_stats.h>
 
 #include "ext_scanners.h"
 #include "strikethrough.h"
@@ -22,10 +23,14 @@ typedef struct {
 typedef struct {
   uint16_t n_columns;
   uint8_t *alignments;
+  // cells so far, for the max_table_cells limit
+  size_t n_cells;
 } node_table;
 
 typedef struct {
   bool is_header;
+  // cells loaded so far by deserialize()
+  uint16_t n_cells;
 } node_table_row;
 
 typedef struct {
@@ -91,7 +96,7 @@ static int set_table_alignments(cmark_node *node, uint8_t *alignments) {
 
 static cmark_strbuf *unescape_pipes(cmark_mem *mem, unsigned char *string, bufsize_t len)
 {
-  cmark_strbuf *res = (cmark_strbuf *)mem->calloc(1, sizeof(cmark_strbuf));
+  cmark_strbuf *res = (cmark_strbuf *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(cmark_strbuf));
   bufsize_t r, w;
 
   cmark_strbuf_init(mem, res, len + 1);
@@ -114,9 +119,10 @@ static table_row *row_from_string(cmark_syntax_extension *self,
                                   cmark_parser *parser, unsigned char *string,
                                   int len) {
   table_row *row = NULL;
+  cmark_llist *last = NULL;
   bufsize_t cell_matched, pipe_matched, offset;
 
-  row = (table_row *)parser->mem->calloc(1, sizeof(table_row));
+  row = (table_row *)cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(table_row));
   row->n_columns = 0;
   row->cells = NULL;
 
@@ -131,7 +137,7 @@ static table_row *row_from_string(cmark_syntax_extension *self,
           cell_matched);
       cmark_strbuf_trim(cell_buf);
 
-      node_cell *cell = (node_cell *)parser->mem->calloc(1, sizeof(*cell));
+      node_cell *cell = (node_cell *)cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(*cell));
       cell->buf = cell_buf;
       cell->start_offset = offset;
       cell->end_offset = offset + cell_matched - 1;
@@ -140,7 +146,11 @@ static table_row *row_from_string(cmark_syntax_extension *self,
         ++cell->internal_offset;
       }
       row->n_columns += 1;
-      row->cells = cmark_llist_append(parser->mem, row->cells, cell);
+      // appending to the end directly, as wide rows have many cells
+      if (last)
+        last = last->next = cmark_llist_append(parser->mem, NULL, cell);
+      else
+        last = row->cells = cmark_llist_append(parser->mem, NULL, cell);
     }
 
     offset += cell_matched + pipe_matched;
@@ -159,6 +169,60 @@ static table_row *row_from_string(cmark_syntax_extension *self,
   return row;
 }
 
+// The loop of row_from_string() without building the cells: counts them
+// from *offset on, and returns whether the string up to len is a row.
+static bool count_row_cells(const unsigned char *string, bufsize_t len,
+                            bufsize_t *offset, int *n_cells) {
+  bufsize_t cell_matched, pipe_matched, pos = *offset;
+
+  if (!pos)
+    pos = scan_table_cell_end(string, len, 0);
+
+  do {
+    cell_matched = scan_table_cell(string, len, pos);
+    pipe_matched = scan_table_cell_end(string, len, pos + cell_matched);
+
+    if (cell_matched || pipe_matched)
+      *n_cells += 1;
+
+    pos += cell_matched + pipe_matched;
+
+    if (!pipe_matched) {
+      pipe_matched = scan_table_row_end(string, len, pos);
+      pos += pipe_matched;
+    }
+  } while ((cell_matched || pipe_matched) && pos < len);
+
+  *offset = pos;
+  return pos == len;
+}
+
+// Number of cells the paragraph has as a header row, or 0 if it is not one.
+// A paragraph followed by many lines that look like delimiter rows is tried
+// as a header for each of them, so the scan resumes where the last one
+// stopped: the scanners never look past a newline, and the paragraph only
+// grows by whole lines.
+static int count_header_cells(cmark_parser *parser, cmark_node *paragraph) {
+  cmark_strbuf *content = &paragraph->content;
+
+  if (parser->header_scan.node != paragraph ||
+      parser->header_scan.start_line != paragraph->start_line ||
+      parser->header_scan.offset > content->size) {
+    parser->header_scan.node = paragraph;
+    parser->header_scan.start_line = paragraph->start_line;
+    parser->header_scan.offset = 0;
+    parser->header_scan.n_cells = 0;
+    parser->header_scan.failed = false;
+  }
+
+  if (!parser->header_scan.failed && parser->header_scan.offset < content->size)
+    parser->header_scan.failed =
+        !count_row_cells(content->ptr, content->size,
+                         &parser->header_scan.offset, &parser->header_scan.n_cells);
+
+  return parser->header_scan.failed ? 0 : parser->header_scan.n_cells;
+}
+
 static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
                                             cmark_parser *parser,
                                             cmark_node *parent_container,
@@ -170,11 +234,23 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
   table_row *marker_row = NULL;
   node_table_row *ntr;
   const char *parent_string;
+  bufsize_t marker_offset = 0;
+  int header_cells, marker_cells = 0;
   uint16_t i;
 
   if (!matched)
     return parent_container;
 
+  // rule out most lines before building the rows
+  header_cells = count_header_cells(parser, parent_container);
+  if (!header_cells)
+    return parent_container;
+  if (!count_row_cells(input + cmark_parser_get_first_nonspace(parser),
+                       len - cmark_parser_get_first_nonspace(parser),
+                       &marker_offset, &marker_cells) ||
+      (uint16_t)header_cells != (uint16_t)marker_cells)
+    return parent_container;
+
   parent_string = cmark_node_get_string_content(parent_container);
 
   cmark_arena_push();
@@ -194,7 +270,9 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
 
   assert(marker_row);
 
-  if (header_row->n_columns != marker_row->n_columns) {
+  if (header_row->n_columns != marker_row->n_columns ||
+      (parser->limits.max_table_cells &&
+       header_row->n_columns > parser->limits.max_table_cells)) {
     free_table_row(parser->mem, header_row);
     free_table_row(parser->mem, marker_row);
     cmark_arena_pop();
@@ -217,12 +295,13 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
 
   cmark_node_set_syntax_extension(parent_container, self);
 
-  parent_container->as.opaque = parser->mem->calloc(1, sizeof(node_table));
+  parent_container->as.opaque = cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table));
 
   set_n_table_columns(parent_container, header_row->n_columns);
+  ((node_table *)parent_container->as.opaque)->n_cells = header_row->n_columns;
 
   uint8_t *alignments =
-      (uint8_t *)parser->mem->calloc(header_row->n_columns, sizeof(uint8_t));
+      (uint8_t *)cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_EXTENSION, header_row->n_columns, sizeof(uint8_t));
   cmark_llist *it = marker_row->cells;
   for (i = 0; it; it = it->next, ++i) {
     node_cell *node = (node_cell *)it->data;
@@ -244,7 +323,7 @@ static cmark_node *try_opening_table_header(cmark_syntax_extension *self,
   table_header->end_column = parent_container->start_column + (int)strlen(parent_string) - 2;
   table_header->start_line = table_header->end_line = parent_container->start_line;
 
-  table_header->as.opaque = ntr = (node_table_row *)parser->mem->calloc(1, sizeof(node_table_row));
+  table_header->as.opaque = ntr = (node_table_row *)cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table_row));
   ntr->is_header = true;
 
   {
@@ -286,10 +365,12 @@ static cmark_node *try_opening_table_row(cmark_syntax_extension *self,
                              parent_container->start_column);
   cmark_node_set_syntax_extension(table_row_block, self);
   table_row_block->end_column = parent_container->end_column;
-  table_row_block->as.opaque = parser->mem->calloc(1, sizeof(node_table_row));
+  table_row_block->as.opaque = cmark_mem_calloc_at(parser->mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table_row));
 
   row = row_from_string(self, parser, input + cmark_parser_get_first_nonspace(parser),
       len - cmark_parser_get_first_nonspace(parser));
+  ((node_table *)parent_container->as.opaque)->n_cells +=
+      get_n_table_columns(parent_container);
 
   {
     cmark_llist *tmp;
@@ -347,6 +428,13 @@ static int matches(cmark_syntax_extension *self, cmark_parser *parser,
         len - cmark_parser_get_first_nonspace(parser));
     if (new_row && new_row->n_columns)
       res = 1;
+    // every row has as many cells as the header, so a row that would go
+    // past max_table_cells ends the table
+    if (res && parser->limits.max_table_cells &&
+        ((node_table *)parent_container->as.opaque)->n_cells +
+                get_n_table_columns(parent_container) >
+            parser->limits.max_table_cells)
+      res = 0;
     free_table_row(parser->mem, new_row);
     cmark_arena_pop();
   }
@@ -489,17 +577,22 @@ static void latex_render(cmark_syntax_extension *extension,
   }
 }
 
+// The alignment of a cell from the delimiter row: 'l', 'c', 'r' or 0
+static uint8_t cell_alignment(cmark_node *node) {
+  uint8_t *alignments = get_table_alignments(node->parent->parent);
+  int i = 0;
+  cmark_node *n;
+  for (n = node->parent->first_child; n; n = n->next, ++i)
+    if (n == node)
+      break;
+  return alignments[i];
+}
+
 static const char *xml_attr(cmark_syntax_extension *extension,
                             cmark_node *node) {
   if (node->type == CMARK_NODE_TABLE_CELL) {
     if (cmark_gfm_extensions_get_table_row_is_header(node->parent)) {
-      uint8_t *alignments = get_table_alignments(node->parent->parent);
-      int i = 0;
-      cmark_node *n;
-      for (n = node->parent->first_child; n; n = n->next, ++i)
-        if (n == node)
-          break;
-      switch (alignments[i]) {
+      switch (cell_alignment(node)) {
       case 'l': return " align=\"left\"";
       case 'c': return " align=\"center\"";
       case 'r': return " align=\"right\"";
@@ -510,6 +603,20 @@ static const char *xml_attr(cmark_syntax_extension *extension,
   return NULL;
 }
 
+// Unlike in xml, the alignment is given for every cell
+static const char *json_attr(cmark_syntax_extension *extension,
+                             cmark_node *node) {
+  if (node->type == CMARK_NODE_TABLE_CELL) {
+    switch (cell_alignment(node)) {
+    case 'l': return ",\"align\":\"left\"";
+    case 'c': return ",\"align\":\"center\"";
+    case 'r': return ",\"align\":\"right\"";
+    }
+  }
+
+  return NULL;
+}
+
 static void man_render(cmark_syntax_extension *extension,
                        cmark_renderer *renderer, cmark_node *node,
                        cmark_event_type ev_type, int options) {
@@ -580,6 +687,8 @@ static void html_table_add_align(cmark_strbuf* html, const char* align, int opti
 struct html_table_state {
   unsigned need_closing_table_body : 1;
   unsigned in_table_header : 1;
+  // of the current cell, instead of counting its preceding siblings
+  unsigned column : 30;
 };
 
 static void html_render(cmark_syntax_extension *extension,
@@ -587,7 +696,6 @@ static void html_render(cmark_syntax_extension *extension,
                         cmark_event_type ev_type, int options) {
   bool entering = (ev_type == CMARK_EVENT_ENTER);
   cmark_strbuf *html = renderer->html;
-  cmark_node *n;
 
   // XXX: we just monopolise renderer->opaque.
   struct html_table_state *table_state =
@@ -623,6 +731,7 @@ static void html_render(cmark_syntax_extension *extension,
         cmark_html_render_cr(html);
         table_state->need_closing_table_body = 1;
       }
+      table_state->column = 0;
       cmark_strbuf_puts(html, "<tr");
       cmark_html_render_sourcepos(node, html, options);
       cmark_strbuf_putc(html, '>');
@@ -645,12 +754,7 @@ static void html_render(cmark_syntax_extension *extension,
         cmark_strbuf_puts(html, "<td");
       }
 
-      int i = 0;
-      for (n = node->parent->first_child; n; n = n->next, ++i)
-        if (n == node)
-          break;
-
-      switch (alignments[i]) {
+      switch (alignments[table_state->column]) {
       case 'l': html_table_add_align(html, "left", options); break;
       case 'c': html_table_add_align(html, "center", options); break;
       case 'r': html_table_add_align(html, "right", options); break;
@@ -664,6 +768,7 @@ static void html_render(cmark_syntax_extension *extension,
       } else {
         cmark_strbuf_puts(html, "</td>");
       }
+      table_state->column++;
     }
   } else {
     assert(false);
@@ -672,11 +777,11 @@ static void html_render(cmark_syntax_extension *extension,
 
 static void opaque_alloc(cmark_syntax_extension *self, cmark_mem *mem, cmark_node *node) {
   if (node->type == CMARK_NODE_TABLE) {
-    node->as.opaque = mem->calloc(1, sizeof(node_table));
+    node->as.opaque = cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table));
   } else if (node->type == CMARK_NODE_TABLE_ROW) {
-    node->as.opaque = mem->calloc(1, sizeof(node_table_row));
+    node->as.opaque = cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table_row));
   } else if (node->type == CMARK_NODE_TABLE_CELL) {
-    node->as.opaque = mem->calloc(1, sizeof(node_cell));
+    node->as.opaque = cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_cell));
   }
 }
 
@@ -688,6 +793,67 @@ static void opaque_free(cmark_syntax_extension *self, cmark_mem *mem, cmark_node
   }
 }
 
+// A table is saved as its number of columns, in two bytes, followed by
+// the alignment of every column, and a row as whether it is the header.
+static size_t serialize(cmark_syntax_extension *self, cmark_node *node,
+                        unsigned char *buf, size_t size) {
+  if (node->type == CMARK_NODE_TABLE) {
+    node_table *t = (node_table *)node->as.opaque;
+    size_t len = 2 + (size_t)t->n_columns;
+    if (len <= size) {
+      buf[0] = (unsigned char)(t->n_columns & 0xff);
+      buf[1] = (unsigned char)(t->n_columns >> 8);
+      memcpy(buf + 2, t->alignments, t->n_columns);
+    }
+    return len;
+  } else if (node->type == CMARK_NODE_TABLE_ROW) {
+    if (size)
+      buf[0] = ((node_table_row *)node->as.opaque)->is_header;
+    return 1;
+  }
+  return 0;
+}
+
+// The renderers index the alignments of the table with the position of a
+// cell, so rows must be in a table and have at most its number of columns.
+static int deserialize(cmark_syntax_extension *self, cmark_mem *mem, cmark_node *node,
+                       const unsigned char *data, size_t len) {
+  size_t i;
+
+  if (node->type == CMARK_NODE_TABLE) {
+    node_table *t = (node_table *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table));
+    node->as.opaque = t;
+    if (len < 3 || len != 2 + (size_t)(data[0] | data[1] << 8))
+      return 0;
+    t->n_columns = (uint16_t)(data[0] | data[1] << 8);
+    t->alignments = (uint8_t *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, t->n_columns + 1, 1);
+    for (i = 0; i < t->n_columns; i++) {
+      if (data[2 + i] && data[2 + i] != 'l' && data[2 + i] != 'c' && data[2 + i] != 'r')
+        return 0;
+      t->alignments[i] = data[2 + i];
+    }
+    return 1;
+  } else if (node->type == CMARK_NODE_TABLE_ROW) {
+    node_table_row *ntr = (node_table_row *)cmark_mem_calloc_at(mem, CMARK_MEM_SITE_EXTENSION, 1, sizeof(node_table_row));
+    node->as.opaque = ntr;
+    if (len != 1 || !node->parent || node->parent->type != CMARK_NODE_TABLE)
+      return 0;
+    ntr->is_header = data[0] != 0;
+    return 1;
+  } else if (node->type == CMARK_NODE_TABLE_CELL) {
+    cmark_node *row = node->parent;
+    if (len || !row || row->type != CMARK_NODE_TABLE_ROW || !row->as.opaque)
+      return 0;
+    node_table_row *ntr = (node_table_row *)row->as.opaque;
+    if (ntr->n_cells >= ((node_table *)row->parent->as.opaque)->n_columns)
+      return 0;
+    ntr->n_cells++;
+    return 1;
+  }
+  // the renderers assert on node types they do not know
+  return 0;
+}
+
 static int escape(cmark_syntax_extension *self, cmark_node *node, int c) {
   return
     node->type != CMARK_NODE_TABLE &&
@@ -708,10 +874,13 @@ cmark_syntax_extension *create_table_extension(void) {
   cmark_syntax_extension_set_plaintext_render_func(self, commonmark_render);
   cmark_syntax_extension_set_latex_render_func(self, latex_render);
   cmark_syntax_extension_set_xml_attr_func(self, xml_attr);
+  cmark_syntax_extension_set_json_attr_func(self, json_attr);
   cmark_syntax_extension_set_man_render_func(self, man_render);
   cmark_syntax_extension_set_html_render_func(self, html_render);
   cmark_syntax_extension_set_opaque_alloc_func(self, opaque_alloc);
   cmark_syntax_extension_set_opaque_free_func(self, opaque_free);
+  cmark_syntax_extension_set_serialize_func(self, serialize);
+  cmark_syntax_extension_set_deserialize_func(self, deserialize);
   cmark_syntax_extension_set_commonmark_escape_func(self, escape);
   CMARK_NODE_TABLE = cmark_syntax_extension_add_node(0);
   CMARK_NODE_TABLE_ROW = cmark_syntax_extension_add_node(0);
@@ -739,7 +908,7 @@ int cmark_gfm_extensions_set_table_columns(cmark_node *node, uint16_t n_columns)
 }
 
 int cmark_gfm_extensions_set_table_alignments(cmark_node *node, uint16_t ncols, uint8_t *alignments) {
-  uint8_t *a = (uint8_t *)cmark_node_mem(node)->calloc(1, ncols);
+  uint8_t *a = (uint8_t *)cmark_mem_calloc_at(cmark_node_mem(node), CMARK_MEM_SITE_EXTENSION, 1, ncols);
   memcpy(a, alignments, ncols);
   return set_table_alignments(node, a);
 }
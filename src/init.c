@@ -4,11 +4,29 @@
 #include "extensions/cmark-gfm-core-extensions.h"
 
 extern SEXP R_list_extensions_jg();
-extern SEXP R_render_markdown(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_render_markdown(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_parser_new(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_parser_feed(SEXP, SEXP);
+extern SEXP R_parser_finish(SEXP, SEXP, SEXP);
+extern SEXP R_md_ast(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_md_extract(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_md_text(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_md_save(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_md_load(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP R_md_stream(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 
 static const R_CallMethodDef CallEntries[] = {
   {"R_list_extensions_jg", (DL_FUNC) &R_list_extensions_jg, 0},
-  {"R_render_markdown", (DL_FUNC) &R_render_markdown, 9},
+  {"R_render_markdown", (DL_FUNC) &R_render_markdown, 12},
+  {"R_parser_new", (DL_FUNC) &R_parser_new, 6},
+  {"R_parser_feed", (DL_FUNC) &R_parser_feed, 2},
+  {"R_parser_finish", (DL_FUNC) &R_parser_finish, 3},
+  {"R_md_ast", (DL_FUNC) &R_md_ast, 5},
+  {"R_md_extract", (DL_FUNC) &R_md_extract, 6},
+  {"R_md_text", (DL_FUNC) &R_md_text, 7},
+  {"R_md_save", (DL_FUNC) &R_md_save, 7},
+  {"R_md_load", (DL_FUNC) &R_md_load, 5},
+  {"R_md_stream", (DL_FUNC) &R_md_stream, 6},
   {NULL, NULL, 0}
 };
 
@@ -4,12 +4,24 @@
  */
 
 #include <Rinternals.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "cmark-gfm.h"
 
 /* Github extensions */
 #include "extensions/cmark-gfm-core-extensions.h"
 #include "registry.h"
+#include "node.h"
+#include "buffer.h"
 
 typedef enum {
   FORMAT_NONE,
@@ -18,37 +30,216 @@ typedef enum {
   FORMAT_MAN,
   FORMAT_COMMONMARK,
   FORMAT_PLAINTEXT,
-  FORMAT_LATEX
+  FORMAT_LATEX,
+  FORMAT_JSON
 } writer_format;
 
-static char* print_document(cmark_node *document, writer_format writer, int options, int width){
+/* Threads for parsing and html rendering, set with options(cmarkjg.threads = n) */
+static int get_num_threads(void){
+  SEXP opt = Rf_GetOption1(Rf_install("cmarkjg.threads"));
+  return Rf_isNull(opt) ? 1 : Rf_asInteger(opt);
+}
+
+/* Allocation statistics, enabled with options(cmarkjg.mem_stats = TRUE) */
+static int get_mem_stats(void){
+  SEXP opt = Rf_GetOption1(Rf_install("cmarkjg.mem_stats"));
+  return !Rf_isNull(opt) && Rf_asLogical(opt) == TRUE;
+}
+
+/* Phase timings, enabled with options(cmarkjg.timings = TRUE) as done by md_profile().
+ * An integer value gives the CMARK_TIMINGS_* flags, to also time extension callbacks. */
+static int get_timings(void){
+  SEXP opt = Rf_GetOption1(Rf_install("cmarkjg.timings"));
+  if(Rf_isNull(opt) || Rf_asLogical(opt) != TRUE)
+    return 0;
+  if(!cmark_timings_available())
+    Rf_error("cmarkjg was built without CMARK_TIMINGS");
+  return Rf_isLogical(opt) ? CMARK_TIMINGS_PHASES : Rf_asInteger(opt);
+}
+
+/* Limits for untrusted input, set with options(cmarkjg.limits = list(...)) */
+#define LIMIT_COUNT 5
+static const char *limit_names[LIMIT_COUNT] = {"max_depth", "max_nodes", "max_table_cells",
+                                               "max_output", "max_seconds"};
+
+static void get_limits(cmark_limits *limits){
+  memset(limits, 0, sizeof(*limits));
+  SEXP opt = Rf_GetOption1(Rf_install("cmarkjg.limits"));
+  if(Rf_isNull(opt))
+    return;
+  SEXP names = Rf_getAttrib(opt, R_NamesSymbol);
+  if(TYPEOF(opt) != VECSXP || Rf_isNull(names))
+    Rf_error("Option 'cmarkjg.limits' must be a named list.");
+  for(int i = 0; i < Rf_length(opt); i++){
+    const char *name = CHAR(STRING_ELT(names, i));
+    double value = Rf_asReal(VECTOR_ELT(opt, i));
+    int k;
+    for(k = 0; k < LIMIT_COUNT && strcmp(name, limit_names[k]); k++)
+      ;
+    if(k == LIMIT_COUNT)
+      Rf_error("Unknown limit '%s' in option 'cmarkjg.limits'.", name);
+    if(ISNAN(value) || value < 0)
+      Rf_error("Limit '%s' must be a non-negative number.", name);
+    switch(k){
+    case 0: limits->max_depth = value > INT_MAX ? 0 : (int) value; break;
+    case 1: limits->max_nodes = value > 1e15 ? 0 : (size_t) value; break;
+    case 2: limits->max_table_cells = value > 1e15 ? 0 : (size_t) value; break;
+    case 3: limits->max_output = value > 1e15 ? 0 : (size_t) value; break;
+    case 4: limits->max_seconds = value; break;
+    }
+  }
+}
+
+static char* print_document(cmark_node *document, writer_format writer, int options, int width,
+                            int num_threads, cmark_mem *mem){
   switch (writer) {
   case FORMAT_HTML:
-    return cmark_render_html(document, options, NULL);
+    return cmark_render_html_threaded(document, options, NULL, mem, num_threads);
   case FORMAT_XML:
-    return cmark_render_xml(document, options);
+    return cmark_render_xml_with_mem(document, options, mem);
   case FORMAT_MAN:
-    return cmark_render_man(document, options, width);
+    return cmark_render_man_with_mem(document, options, width, mem);
   case FORMAT_COMMONMARK:
-    return cmark_render_commonmark(document, options, width);
+    return cmark_render_commonmark_with_mem(document, options, width, mem);
   case FORMAT_LATEX:
-    return cmark_render_latex(document, options, width);
+    return cmark_render_latex_with_mem(document, options, width, mem);
   case FORMAT_PLAINTEXT:
-    return cmark_render_plaintext(document, options, width);
+    return cmark_render_plaintext_with_mem(document, options, width, mem);
+  case FORMAT_JSON:
+    return cmark_render_json_with_mem(document, options, mem);
   default:
     Rf_error("Unknown output format %d", writer);
   }
 }
 
-SEXP R_render_markdown(SEXP text, SEXP format, SEXP sourcepos, SEXP hardbreaks,
-                       SEXP smart, SEXP max_strikethrough, SEXP normalize,
-                       SEXP width, SEXP extensions) {
+/* Size of the blocks in which files are read into the parser */
+#define FEED_BUFFER_SIZE 65536
 
-  /* input validation */
-  if(!Rf_isString(text))
-    Rf_error("Argument 'text' must be string.");
-  if(!Rf_isInteger(format))
-    Rf_error("Argument 'format' must be integer.");
+/* cmark_parser_feed, or cmark_parser_feed_references for a first pass */
+typedef void (*feed_func)(cmark_parser *parser, const char *buffer, size_t len);
+
+/* Feed a character vector line by line, as if it had been pasted with "\n".
+ * Each element is converted to UTF-8 separately so we never hold a second
+ * copy of the complete document. */
+static void feed_text(cmark_parser *parser, SEXP text, feed_func feed){
+  R_xlen_t len = Rf_xlength(text);
+  for(R_xlen_t i = 0; i < len; i++){
+    const void *vmax = vmaxget();
+    const char *line = Rf_translateCharUTF8(STRING_ELT(text, i));
+    if(i > 0)
+      feed(parser, "\n", 1);
+    feed(parser, line, strlen(line));
+    vmaxset(vmax);
+  }
+}
+
+/* Raw vectors are passed to the parser byte-for-byte */
+static void feed_raw(cmark_parser *parser, SEXP raw, feed_func feed){
+  feed(parser, (const char *) RAW(raw), XLENGTH(raw));
+}
+
+/* Read a file in fixed-size blocks; incomplete lines are carried over by the parser */
+static void feed_file(cmark_parser *parser, FILE *fp, feed_func feed){
+  char buffer[FEED_BUFFER_SIZE];
+  size_t bytes;
+  while((bytes = fread(buffer, 1, sizeof(buffer), fp)) > 0){
+    feed(parser, buffer, bytes);
+    if(bytes < sizeof(buffer))
+      break;
+  }
+}
+
+#ifdef _WIN32
+/* Read a file into a malloc'ed buffer, or NULL if it does not fit in memory */
+static char *read_whole_file(FILE *fp, size_t *len){
+  size_t size = FEED_BUFFER_SIZE, bytes;
+  char *data = malloc(size);
+  *len = 0;
+  if(!data)
+    return NULL;
+  while((bytes = fread(data + *len, 1, size - *len, fp)) > 0){
+    *len += bytes;
+    if(*len == size){
+      char *tmp = realloc(data, size *= 2);
+      if(!tmp){
+        free(data);
+        return NULL;
+      }
+      data = tmp;
+    }
+  }
+  if(ferror(fp)){
+    free(data);
+    return NULL;
+  }
+  return data;
+}
+#endif
+
+/* Map a file into memory, or read it whole where mmap is not available */
+static char *map_file(const char *path, size_t *len){
+#ifdef _WIN32
+  FILE *fp = fopen(path, "rb");
+  if(!fp)
+    return NULL;
+  char *data = read_whole_file(fp, len);
+  fclose(fp);
+  return data;
+#else
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+  if(fd < 0)
+    return NULL;
+  if(fstat(fd, &st) < 0){
+    close(fd);
+    return NULL;
+  }
+  *len = (size_t) st.st_size;
+  /* mmap refuses empty files */
+  void *data = *len ? mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0) : (void *) "";
+  close(fd);
+  return data == MAP_FAILED ? NULL : data;
+#endif
+}
+
+static void unmap_file(char *data, size_t len){
+#ifdef _WIN32
+  free(data);
+#else
+  if(len)
+    munmap(data, len);
+#endif
+}
+
+/* The threaded parser can only split the document if it is fed in one piece,
+ * so the lines are joined in an R_alloc buffer, which is released once fed */
+static void feed_text_whole(cmark_parser *parser, SEXP text){
+  R_xlen_t n = Rf_xlength(text);
+  size_t len = 0;
+  for(R_xlen_t i = 0; i < n; i++){
+    const void *vmax = vmaxget();
+    len += strlen(Rf_translateCharUTF8(STRING_ELT(text, i))) + 1;
+    vmaxset(vmax);
+  }
+  const void *vmax = vmaxget();
+  char *buf = R_alloc(len + 1, 1), *p = buf;
+  const void *vmax_buf = vmaxget();
+  for(R_xlen_t i = 0; i < n; i++){
+    const char *line = Rf_translateCharUTF8(STRING_ELT(text, i));
+    size_t linelen = strlen(line);
+    if(i > 0)
+      *p++ = '\n';
+    memcpy(p, line, linelen);
+    p += linelen;
+    vmaxset(vmax_buf);
+  }
+  cmark_parser_feed(parser, buf, p - buf);
+  vmaxset(vmax);
+}
+
+/* Validate the logical flags and combine them into cmark options */
+static int get_options(SEXP sourcepos, SEXP hardbreaks, SEXP smart,
+                       SEXP max_strikethrough, SEXP normalize){
   if(!Rf_isLogical(sourcepos))
     Rf_error("Argument 'sourcepos' must be logical.");
   if(!Rf_isLogical(hardbreaks))
@@ -59,10 +250,7 @@ SEXP R_render_markdown(SEXP text, SEXP format, SEXP sourcepos, SEXP hardbreaks,
     Rf_error("Argument 'max_strikethrough' must be logical.");
   if(!Rf_isLogical(normalize))
     Rf_error("Argument 'normalize' must be logical.");
-  if(!Rf_isInteger(width))
-    Rf_error("Argument 'width' must be integer.");
 
-  /* combine options */
   int options = CMARK_OPT_DEFAULT | CMARK_OPT_STRIKETHROUGH_DOUBLE_TILDE;
   if (Rf_asLogical(max_strikethrough))
     options &= ~CMARK_OPT_STRIKETHROUGH_DOUBLE_TILDE;
@@ -75,32 +263,883 @@ SEXP R_render_markdown(SEXP text, SEXP format, SEXP sourcepos, SEXP hardbreaks,
   if (Rf_asLogical(normalize))
     options |= CMARK_OPT_NORMALIZE;
 
-
   /* Prevent filtering embedded resources: https://github.com/github/cmark-gfm#security */
-  options += CMARK_OPT_UNSAFE;
+  options |= CMARK_OPT_UNSAFE;
+  return options;
+}
 
-  /* parse input */
-  SEXP input = STRING_ELT(text, 0);
-  cmark_parser *parser = cmark_parser_new(options);
+/* Look up all extensions before anything is allocated, so that errors do not leak */
+static void check_extensions(SEXP extensions){
+  if(!Rf_isNull(extensions) && !Rf_isString(extensions))
+    Rf_error("Argument 'extensions' must be string.");
   for(int i = 0; i < Rf_length(extensions); i++){
     const char * ext_name = CHAR(STRING_ELT(extensions, i));
-    cmark_syntax_extension *syntax_extension = cmark_find_syntax_extension(ext_name);
-    if(!syntax_extension)
+    if(!cmark_find_syntax_extension(ext_name))
       Rf_error("Failed to find load '%s' extension", ext_name);
-    cmark_parser_attach_syntax_extension(parser, syntax_extension);
   }
-  cmark_parser_feed(parser, CHAR(input), LENGTH(input));
+}
+
+static cmark_parser *new_parser(int options, SEXP extensions, cmark_mem *mem){
+  cmark_parser *parser = cmark_parser_new_with_mem(options, mem);
+  cmark_parser_set_num_threads(parser, get_num_threads());
+  for(int i = 0; i < Rf_length(extensions); i++){
+    const char * ext_name = CHAR(STRING_ELT(extensions, i));
+    cmark_parser_attach_syntax_extension(parser, cmark_find_syntax_extension(ext_name));
+  }
+  return parser;
+}
+
+/* Either text (string or raw) or a single file path */
+static void check_input(SEXP text, SEXP file){
+  if(Rf_isNull(file)){
+    if(!Rf_isString(text) && TYPEOF(text) != RAWSXP)
+      Rf_error("Argument 'text' must be string or raw vector.");
+  } else if(!Rf_isString(file) || Rf_length(file) != 1){
+    Rf_error("Argument 'file' must be a single path.");
+  }
+}
+
+/* Parse the text or file into a document, or its first max_blocks top-level
+ * blocks if that is not 0. Any errors are raised before the parser is
+ * allocated. */
+static cmark_node *parse_input(SEXP text, SEXP file, int options, SEXP extensions,
+                               int max_blocks, cmark_mem *mem){
+  cmark_limits limits;
+  get_limits(&limits);
+
+  /* Bytes that did not come from an R string may not be valid UTF-8 */
+  if(!Rf_isNull(file) || TYPEOF(text) == RAWSXP)
+    options |= CMARK_OPT_VALIDATE_UTF8;
+
+  /* open or map the file before allocating the parser; the threaded parser
+   * gets the mapped file in one piece */
+  int whole = get_num_threads() > 1;
+  FILE *fp = NULL;
+  char *data = NULL;
+  size_t len = 0;
+  if(!Rf_isNull(file)){
+    const char *path = R_ExpandFileName(Rf_translateChar(STRING_ELT(file, 0)));
+    if(whole ? !(data = map_file(path, &len)) : !(fp = fopen(path, "rb"))){
+      cmark_timings_enable(0);
+      Rf_error("Failed to open file '%s'", path);
+    }
+  }
+
+  cmark_parser *parser = new_parser(options, extensions, mem);
+  cmark_parser_set_max_blocks(parser, max_blocks);
+  cmark_parser_set_limits(parser, &limits);
+  if(data){
+    cmark_parser_feed(parser, data, len);
+    unmap_file(data, len);
+  } else if(fp){
+    feed_file(parser, fp, cmark_parser_feed);
+    fclose(fp);
+  } else if(TYPEOF(text) == RAWSXP){
+    feed_raw(parser, text, cmark_parser_feed);
+  } else if(whole){
+    feed_text_whole(parser, text);
+  } else {
+    feed_text(parser, text, cmark_parser_feed);
+  }
   cmark_node *doc = cmark_parser_finish(parser);
+  cmark_limit exceeded = cmark_parser_limit_exceeded(parser);
   cmark_parser_free(parser);
+  if(exceeded != CMARK_LIMIT_NONE){
+    cmark_node_free(doc);
+    cmark_timings_enable(0);
+    Rf_error("Document exceeds the limit '%s'.",
+             exceeded == CMARK_LIMIT_NODES ? "max_nodes" : "max_seconds");
+  }
+  return doc;
+}
 
-  /* render output format */
-  char *output = print_document(doc, Rf_asInteger(format), options, Rf_asInteger(width));
-  cmark_node_free(doc);
+/* Counters per allocation site, as a named numeric vector */
+static SEXP mem_site_counts(const size_t *counts){
+  SEXP res = PROTECT(Rf_allocVector(REALSXP, CMARK_MEM_SITE_COUNT));
+  SEXP names = PROTECT(Rf_allocVector(STRSXP, CMARK_MEM_SITE_COUNT));
+  for(int i = 0; i < CMARK_MEM_SITE_COUNT; i++){
+    REAL(res)[i] = (double) counts[i];
+    SET_STRING_ELT(names, i, Rf_mkChar(cmark_mem_site_name((cmark_mem_site) i)));
+  }
+  Rf_setAttrib(res, R_NamesSymbol, names);
+  UNPROTECT(2);
+  return res;
+}
+
+static SEXP mem_stats_list(void){
+  cmark_mem_stats stats;
+  cmark_mem_stats_get(&stats);
+  const char *names[] = {"peak_bytes", "live_bytes", "frees", "calls", "bytes", ""};
+  SEXP res = PROTECT(Rf_mkNamed(VECSXP, names));
+  SET_VECTOR_ELT(res, 0, Rf_ScalarReal((double) stats.peak_bytes));
+  SET_VECTOR_ELT(res, 1, Rf_ScalarReal((double) stats.live_bytes));
+  SET_VECTOR_ELT(res, 2, Rf_ScalarReal((double) stats.frees));
+  SET_VECTOR_ELT(res, 3, mem_site_counts(stats.calls));
+  SET_VECTOR_ELT(res, 4, mem_site_counts(stats.bytes));
+  UNPROTECT(1);
+  return res;
+}
+
+/* Timings per phase (and extension), as columns for a data frame */
+static SEXP timings_list(void){
+  const cmark_timing *timings;
+  size_t n = cmark_timings_get(&timings);
+  const char *names[] = {"phase", "extension", "count", "ns", ""};
+  SEXP res = PROTECT(Rf_mkNamed(VECSXP, names));
+  SEXP phase = SET_VECTOR_ELT(res, 0, Rf_allocVector(STRSXP, n));
+  SEXP extension = SET_VECTOR_ELT(res, 1, Rf_allocVector(STRSXP, n));
+  SEXP count = SET_VECTOR_ELT(res, 2, Rf_allocVector(REALSXP, n));
+  SEXP ns = SET_VECTOR_ELT(res, 3, Rf_allocVector(REALSXP, n));
+  for(size_t i = 0; i < n; i++){
+    SET_STRING_ELT(phase, i, Rf_mkChar(cmark_phase_name(timings[i].phase)));
+    SET_STRING_ELT(extension, i, timings[i].name ? Rf_mkChar(timings[i].name) : NA_STRING);
+    REAL(count)[i] = (double) timings[i].count;
+    REAL(ns)[i] = (double) timings[i].ns;
+  }
+  UNPROTECT(1);
+  return res;
+}
 
-  /* cmark always returns UTF8 output */
+/* Timings per extension callback, as columns for a data frame */
+static SEXP ext_timings_list(void){
+  const cmark_ext_timing *timings;
+  size_t n = cmark_ext_timings_get(&timings);
+  const char *names[] = {"extension", "callback", "count", "ns", ""};
+  SEXP res = PROTECT(Rf_mkNamed(VECSXP, names));
+  SEXP extension = SET_VECTOR_ELT(res, 0, Rf_allocVector(STRSXP, n));
+  SEXP callback = SET_VECTOR_ELT(res, 1, Rf_allocVector(STRSXP, n));
+  SEXP count = SET_VECTOR_ELT(res, 2, Rf_allocVector(REALSXP, n));
+  SEXP ns = SET_VECTOR_ELT(res, 3, Rf_allocVector(REALSXP, n));
+  for(size_t i = 0; i < n; i++){
+    SET_STRING_ELT(extension, i, Rf_mkChar(timings[i].name));
+    SET_STRING_ELT(callback, i, Rf_mkChar(cmark_ext_callback_name(timings[i].callback)));
+    REAL(count)[i] = (double) timings[i].count;
+    REAL(ns)[i] = (double) timings[i].ns;
+  }
+  UNPROTECT(1);
+  return res;
+}
+
+/* Render and free the document. cmark always returns UTF8 output. When the
+ * counting allocator was used, the statistics are added as attr(, "stats"),
+ * after everything was freed, so live_bytes is 0 unless something leaked.
+ * Output longer than max_output bytes, unless that is 0, is an error. */
+static SEXP render_document(cmark_node *doc, int format, int options, int width,
+                            cmark_mem *mem, int mem_stats, int timings,
+                            size_t max_output){
+  char *output = print_document(doc, format, options, width, get_num_threads(), mem);
+  cmark_node_free(doc);
+  if(max_output && strlen(output) > max_output){
+    mem->free(output);
+    cmark_timings_enable(0);
+    Rf_error("Output exceeds the limit 'max_output'.");
+  }
   SEXP res = PROTECT(Rf_allocVector(STRSXP, 1));
   SET_STRING_ELT(res, 0, Rf_mkCharCE(output, CE_UTF8));
+  mem->free(output);
+  if(mem_stats)
+    Rf_setAttrib(res, Rf_install("stats"), mem_stats_list());
+  if(timings){
+    cmark_timings_enable(0);
+    Rf_setAttrib(res, Rf_install("timings"), timings_list());
+    if(timings & CMARK_TIMINGS_EXTENSIONS)
+      Rf_setAttrib(res, Rf_install("callbacks"), ext_timings_list());
+  }
   UNPROTECT(1);
-  free(output);
   return res;
 }
+
+SEXP R_render_markdown(SEXP text, SEXP format, SEXP sourcepos, SEXP hardbreaks,
+                       SEXP smart, SEXP max_strikethrough, SEXP normalize,
+                       SEXP width, SEXP extensions, SEXP file, SEXP max_blocks,
+                       SEXP max_chars) {
+
+  /* input validation */
+  check_input(text, file);
+  if(!Rf_isInteger(format))
+    Rf_error("Argument 'format' must be integer.");
+  if(!Rf_isInteger(width))
+    Rf_error("Argument 'width' must be integer.");
+  int blocks = Rf_asInteger(max_blocks);
+  if(blocks == NA_INTEGER || blocks < 0)
+    Rf_error("Argument 'max_blocks' must be a non-negative number.");
+  double chars = Rf_asReal(max_chars);
+  if(ISNAN(chars) || chars < 0)
+    Rf_error("Argument 'max_chars' must be a non-negative number.");
+  int options = get_options(sourcepos, hardbreaks, smart, max_strikethrough, normalize);
+  check_extensions(extensions);
+  cmark_limits limits;
+  get_limits(&limits);
+
+  /* inlines are parsed as the excerpt is cut, so only those it includes */
+  if(chars > 0 && chars <= INT_MAX)
+    options |= CMARK_OPT_LAZY_INLINES;
+
+  int mem_stats = get_mem_stats();
+  int timings = get_timings();
+
+  /* parse input */
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  if(mem_stats){
+    mem = cmark_get_counting_mem_allocator(mem);
+    cmark_mem_stats_reset();
+  }
+  if(timings){
+    cmark_timings_reset();
+    cmark_timings_enable(timings);
+  }
+  cmark_node *doc = parse_input(text, file, options, extensions, blocks, mem);
+  if(chars > 0 && chars <= INT_MAX)
+    cmark_node_truncate(doc, (size_t) chars);
+
+  /* render output format */
+  return render_document(doc, Rf_asInteger(format), options, Rf_asInteger(width), mem, mem_stats,
+                         timings, limits.max_output);
+}
+
+/* Incremental parsing: the parser lives in an external pointer and holds the
+ * document parsed so far, plus any incomplete line, between calls to feed. */
+typedef struct {
+  cmark_parser *parser;
+  int options;
+} stream_parser;
+
+static void fin_stream_parser(SEXP ptr){
+  stream_parser *sp = R_ExternalPtrAddr(ptr);
+  if(!sp)
+    return;
+  cmark_parser_free(sp->parser);
+  free(sp);
+  R_ClearExternalPtr(ptr);
+}
+
+static stream_parser *get_stream_parser(SEXP ptr){
+  if(TYPEOF(ptr) != EXTPTRSXP || !Rf_inherits(ptr, "md_parser"))
+    Rf_error("Argument 'parser' must be a md_parser object.");
+  stream_parser *sp = R_ExternalPtrAddr(ptr);
+  if(!sp)
+    Rf_error("This parser has already been finished.");
+  return sp;
+}
+
+SEXP R_parser_new(SEXP sourcepos, SEXP hardbreaks, SEXP smart,
+                  SEXP max_strikethrough, SEXP normalize, SEXP extensions){
+  int options = get_options(sourcepos, hardbreaks, smart, max_strikethrough, normalize);
+  check_extensions(extensions);
+  stream_parser *sp = malloc(sizeof(stream_parser));
+  if(!sp)
+    Rf_error("Failed to allocate parser");
+  sp->options = options | CMARK_OPT_VALIDATE_UTF8;
+  sp->parser = new_parser(sp->options, extensions, cmark_get_default_mem_allocator());
+  SEXP ptr = PROTECT(R_MakeExternalPtr(sp, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, fin_stream_parser, TRUE);
+  Rf_setAttrib(ptr, R_ClassSymbol, Rf_mkString("md_parser"));
+  UNPROTECT(1);
+  return ptr;
+}
+
+SEXP R_parser_feed(SEXP ptr, SEXP chunk){
+  stream_parser *sp = get_stream_parser(ptr);
+  if(TYPEOF(chunk) == RAWSXP){
+    feed_raw(sp->parser, chunk, cmark_parser_feed);
+  } else if(Rf_isString(chunk)){
+    /* character chunks are complete lines */
+    if(Rf_xlength(chunk) > 0){
+      feed_text(sp->parser, chunk, cmark_parser_feed);
+      cmark_parser_feed(sp->parser, "\n", 1);
+    }
+  } else {
+    Rf_error("Argument 'chunk' must be string or raw vector.");
+  }
+  return ptr;
+}
+
+SEXP R_parser_finish(SEXP ptr, SEXP format, SEXP width){
+  stream_parser *sp = get_stream_parser(ptr);
+  if(!Rf_isInteger(format))
+    Rf_error("Argument 'format' must be integer.");
+  if(!Rf_isInteger(width))
+    Rf_error("Argument 'width' must be integer.");
+  cmark_node *doc = cmark_parser_finish(sp->parser);
+  int options = sp->options;
+  fin_stream_parser(ptr);
+  return render_document(doc, Rf_asInteger(format), options, Rf_asInteger(width),
+                         cmark_get_default_mem_allocator(), 0, 0, 0);
+}
+
+/* Columns of the md_ast() data frame, one row per node in document order */
+enum {
+  AST_ID, AST_PARENT, AST_DEPTH, AST_TYPE, AST_START_LINE, AST_START_COLUMN,
+  AST_END_LINE, AST_END_COLUMN, AST_LITERAL, AST_URL, AST_TITLE, AST_LEVEL,
+  AST_LIST_TYPE, AST_LIST_START, AST_LIST_TIGHT, AST_LIST_DELIM, AST_INFO, AST_NCOL
+};
+
+/* Type strings are static, so their CHARSXP is looked up once per type */
+#define AST_TYPE_CACHE 32
+
+static SEXP mk_string_or_na(const char *str){
+  return str ? Rf_mkCharCE(str, CE_UTF8) : NA_STRING;
+}
+
+/* The info string of fenced code blocks; indented ones have an empty info
+ * string, but no fence, so they get NULL like other nodes */
+static const char *code_info(cmark_node *node){
+  int length, offset;
+  char fence;
+  return cmark_node_get_fenced(node, &length, &offset, &fence) ?
+    cmark_node_get_fence_info(node) : NULL;
+}
+
+/* Containers without children are exited right after they are entered,
+ * so only nodes with children count towards the depth of their descendants */
+static SEXP ast_columns(cmark_node *doc){
+  /* first walk: count nodes and the maximum depth */
+  cmark_iter *iter = cmark_iter_new(doc);
+  cmark_event_type ev;
+  R_xlen_t n = 0;
+  int depth = 0, max_depth = 0;
+  while ((ev = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    int has_children = cmark_node_first_child(cmark_iter_get_node(iter)) != NULL;
+    if (ev == CMARK_EVENT_ENTER) {
+      n++;
+      if (has_children && ++depth > max_depth)
+        max_depth = depth;
+    } else if (has_children) {
+      depth--;
+    }
+  }
+
+  const char *names[] = {"id", "parent", "depth", "type", "start_line", "start_column",
+                         "end_line", "end_column", "literal", "url", "title", "level",
+                         "list_type", "list_start", "list_tight", "list_delim", "info", ""};
+  SEXP res = PROTECT(Rf_mkNamed(VECSXP, names));
+  SEXPTYPE types[AST_NCOL] = {INTSXP, INTSXP, INTSXP, STRSXP, INTSXP, INTSXP, INTSXP, INTSXP,
+                              STRSXP, STRSXP, STRSXP, INTSXP, STRSXP, INTSXP, LGLSXP, STRSXP,
+                              STRSXP};
+  SEXP col[AST_NCOL];
+  for (int j = 0; j < AST_NCOL; j++)
+    col[j] = SET_VECTOR_ELT(res, j, Rf_allocVector(types[j], n));
+
+  /* ids of the open ancestors, indexed by depth */
+  int *parents = (int *) R_alloc(max_depth + 1, sizeof(int));
+  const char *cached_type[AST_TYPE_CACHE];
+  SEXP cached_char[AST_TYPE_CACHE];
+  int ncached = 0;
+
+  /* second walk: fill the columns */
+  cmark_iter_free(iter);
+  iter = cmark_iter_new(doc);
+  R_xlen_t i = 0;
+  depth = 0;
+  while ((ev = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cmark_node *node = cmark_iter_get_node(iter);
+    if (ev == CMARK_EVENT_EXIT) {
+      if (cmark_node_first_child(node))
+        depth--;
+      continue;
+    }
+    int id = (int) i + 1;
+    INTEGER(col[AST_ID])[i] = id;
+    INTEGER(col[AST_PARENT])[i] = depth ? parents[depth - 1] : NA_INTEGER;
+    INTEGER(col[AST_DEPTH])[i] = depth;
+
+    const char *type = cmark_node_get_type_string(node);
+    int k;
+    for (k = 0; k < ncached && cached_type[k] != type; k++)
+      ;
+    if (k == ncached) {
+      SEXP chr = Rf_mkChar(type);
+      if (ncached < AST_TYPE_CACHE) {
+        cached_type[ncached] = type;
+        cached_char[ncached++] = chr;
+      }
+      SET_STRING_ELT(col[AST_TYPE], i, chr);
+    } else {
+      SET_STRING_ELT(col[AST_TYPE], i, cached_char[k]);
+    }
+
+    INTEGER(col[AST_START_LINE])[i] = cmark_node_get_start_line(node);
+    INTEGER(col[AST_START_COLUMN])[i] = cmark_node_get_start_column(node);
+    INTEGER(col[AST_END_LINE])[i] = cmark_node_get_end_line(node);
+    INTEGER(col[AST_END_COLUMN])[i] = cmark_node_get_end_column(node);
+    SET_STRING_ELT(col[AST_LITERAL], i, mk_string_or_na(cmark_node_get_literal(node)));
+
+    cmark_node_type node_type = cmark_node_get_type(node);
+    int is_link = node_type == CMARK_NODE_LINK || node_type == CMARK_NODE_IMAGE;
+    SET_STRING_ELT(col[AST_URL], i, mk_string_or_na(is_link ? cmark_node_get_url(node) : NULL));
+    SET_STRING_ELT(col[AST_TITLE], i, mk_string_or_na(is_link ? cmark_node_get_title(node) : NULL));
+    INTEGER(col[AST_LEVEL])[i] =
+      node_type == CMARK_NODE_HEADING ? cmark_node_get_heading_level(node) : NA_INTEGER;
+
+    if (node_type == CMARK_NODE_LIST) {
+      int ordered = cmark_node_get_list_type(node) == CMARK_ORDERED_LIST;
+      SET_STRING_ELT(col[AST_LIST_TYPE], i, Rf_mkChar(ordered ? "ordered" : "bullet"));
+      INTEGER(col[AST_LIST_START])[i] = ordered ? cmark_node_get_list_start(node) : NA_INTEGER;
+      LOGICAL(col[AST_LIST_TIGHT])[i] = cmark_node_get_list_tight(node);
+      SET_STRING_ELT(col[AST_LIST_DELIM], i, !ordered ? NA_STRING :
+        Rf_mkChar(cmark_node_get_list_delim(node) == CMARK_PAREN_DELIM ? "paren" : "period"));
+    } else {
+      SET_STRING_ELT(col[AST_LIST_TYPE], i, NA_STRING);
+      INTEGER(col[AST_LIST_START])[i] = NA_INTEGER;
+      LOGICAL(col[AST_LIST_TIGHT])[i] = NA_LOGICAL;
+      SET_STRING_ELT(col[AST_LIST_DELIM], i, NA_STRING);
+    }
+    SET_STRING_ELT(col[AST_INFO], i, mk_string_or_na(code_info(node)));
+
+    if (cmark_node_first_child(node))
+      parents[depth++] = id;
+    i++;
+  }
+  cmark_iter_free(iter);
+  UNPROTECT(1);
+  return res;
+}
+
+/* Parse a document and return its nodes as the columns of a data frame,
+ * without rendering to XML first */
+SEXP R_md_ast(SEXP text, SEXP smart, SEXP max_strikethrough, SEXP extensions, SEXP file){
+  check_input(text, file);
+  int options = get_options(Rf_ScalarLogical(FALSE), Rf_ScalarLogical(FALSE), smart,
+                            max_strikethrough, Rf_ScalarLogical(FALSE));
+  check_extensions(extensions);
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_node *doc = parse_input(text, file, options, extensions, 0, mem);
+  SEXP res = ast_columns(doc);
+  cmark_node_free(doc);
+  return res;
+}
+
+/* md_stream(): the parser runs in event mode and every top-level block is
+ * passed to an R function as soon as it is closed, so only one block is in
+ * memory at a time. The parser and file live in an external pointer, which
+ * frees them if the R function raises an error. */
+typedef struct {
+  cmark_parser *parser;
+  FILE *fp;
+  SEXP fun;
+  SEXP results;
+  PROTECT_INDEX index;
+  R_xlen_t n;
+} block_stream;
+
+static void fin_block_stream(SEXP ptr){
+  block_stream *bs = R_ExternalPtrAddr(ptr);
+  if(!bs)
+    return;
+  if(bs->fp)
+    fclose(bs->fp);
+  if(bs->parser)
+    cmark_parser_free(bs->parser);
+  free(bs);
+  R_ClearExternalPtr(ptr);
+}
+
+static void stream_block(cmark_event_type ev, cmark_node *node, void *data){
+  block_stream *bs = data;
+  cmark_node *parent = cmark_node_parent(node);
+  if (ev != CMARK_EVENT_ENTER || !parent || cmark_node_get_type(parent) != CMARK_NODE_DOCUMENT)
+    return;
+  /* ast_columns() uses R_alloc, which is only released by vmaxset */
+  const void *vmax = vmaxget();
+  SEXP cols = PROTECT(ast_columns(node));
+  SEXP call = PROTECT(Rf_lang2(bs->fun, cols));
+  SEXP val = PROTECT(Rf_eval(call, R_GlobalEnv));
+  if (bs->n == Rf_xlength(bs->results)) {
+    bs->results = Rf_xlengthgets(bs->results, 2 * bs->n);
+    REPROTECT(bs->results, bs->index);
+  }
+  SET_VECTOR_ELT(bs->results, bs->n++, val);
+  UNPROTECT(3);
+  vmaxset(vmax);
+}
+
+SEXP R_md_stream(SEXP text, SEXP fun, SEXP smart, SEXP max_strikethrough, SEXP extensions,
+                 SEXP file){
+  check_input(text, file);
+  if(!Rf_isFunction(fun))
+    Rf_error("Argument 'FUN' must be a function.");
+  int options = get_options(Rf_ScalarLogical(FALSE), Rf_ScalarLogical(FALSE), smart,
+                            max_strikethrough, Rf_ScalarLogical(FALSE));
+  check_extensions(extensions);
+  if(!Rf_isNull(file) || TYPEOF(text) == RAWSXP)
+    options |= CMARK_OPT_VALIDATE_UTF8;
+
+  block_stream *bs = calloc(1, sizeof(block_stream));
+  if(!bs)
+    Rf_error("Failed to allocate parser");
+  SEXP ptr = PROTECT(R_MakeExternalPtr(bs, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, fin_block_stream, TRUE);
+  if(!Rf_isNull(file)){
+    const char *path = R_ExpandFileName(Rf_translateChar(STRING_ELT(file, 0)));
+    bs->fp = fopen(path, "rb");
+    if(!bs->fp)
+      Rf_error("Failed to open file '%s'", path);
+  }
+  bs->parser = new_parser(options, extensions, cmark_get_default_mem_allocator());
+  bs->fun = fun;
+  PROTECT_WITH_INDEX(bs->results = Rf_allocVector(VECSXP, 16), &bs->index);
+  cmark_parser_set_event_func(bs->parser, stream_block, bs);
+
+  /* the first pass collects the link reference definitions */
+  if(bs->fp){
+    feed_file(bs->parser, bs->fp, cmark_parser_feed_references);
+    rewind(bs->fp);
+    feed_file(bs->parser, bs->fp, cmark_parser_feed);
+  } else if(TYPEOF(text) == RAWSXP){
+    feed_raw(bs->parser, text, cmark_parser_feed_references);
+    feed_raw(bs->parser, text, cmark_parser_feed);
+  } else {
+    feed_text(bs->parser, text, cmark_parser_feed_references);
+    feed_text(bs->parser, text, cmark_parser_feed);
+  }
+  cmark_node_free(cmark_parser_finish(bs->parser));
+  SEXP res = Rf_xlengthgets(bs->results, bs->n);
+  fin_block_stream(ptr);
+  UNPROTECT(2);
+  return res;
+}
+
+/* Nodes collected by md_extract(), each into a table with its own columns.
+ * All tables start with the document index, and end with the source positions. */
+typedef enum {
+  EXTRACT_LINKS, EXTRACT_IMAGES, EXTRACT_HEADINGS, EXTRACT_CODE, EXTRACT_FOOTNOTES, EXTRACT_KINDS
+} extract_kind;
+
+static const char *extract_kinds[] = {"links", "images", "headings", "code", "footnotes", ""};
+
+static const char *extract_columns[EXTRACT_KINDS][9] = {
+  {"doc", "url", "title", "text", "start_line", "start_column", "end_line", "end_column", ""},
+  {"doc", "url", "title", "text", "start_line", "start_column", "end_line", "end_column", ""},
+  {"doc", "level", "text", "start_line", "start_column", "end_line", "end_column", ""},
+  {"doc", "info", "code", "start_line", "start_column", "end_line", "end_column", ""},
+  {"doc", "label", "text", "start_line", "start_column", "end_line", "end_column", ""}
+};
+
+/* Column vectors grow by doubling and are truncated at the end */
+typedef struct {
+  SEXP cols;
+  int ncol;
+  R_xlen_t n;
+  R_xlen_t cap;
+} extract_table;
+
+static void extract_table_init(extract_table *t, SEXP tables, extract_kind kind){
+  const char **names = extract_columns[kind];
+  t->cols = SET_VECTOR_ELT(tables, kind, Rf_mkNamed(VECSXP, names));
+  for (t->ncol = 0; names[t->ncol][0]; t->ncol++)
+    ;
+  for (int j = 0; j < t->ncol; j++) {
+    int is_integer = j == 0 || j >= t->ncol - 4 || !strcmp(names[j], "level");
+    SET_VECTOR_ELT(t->cols, j, Rf_allocVector(is_integer ? INTSXP : STRSXP, 0));
+  }
+  t->n = 0;
+  t->cap = 0;
+}
+
+static void extract_table_resize(extract_table *t, R_xlen_t size){
+  for (int j = 0; j < t->ncol; j++)
+    SET_VECTOR_ELT(t->cols, j, Rf_xlengthgets(VECTOR_ELT(t->cols, j), size));
+  t->cap = size;
+}
+
+/* Adds a row for the node with the document index and source positions */
+static R_xlen_t extract_row(extract_table *t, int doc, cmark_node *node){
+  if (t->n == t->cap)
+    extract_table_resize(t, t->cap ? 2 * t->cap : 16);
+  R_xlen_t i = t->n++;
+  INTEGER(VECTOR_ELT(t->cols, 0))[i] = doc;
+  INTEGER(VECTOR_ELT(t->cols, t->ncol - 4))[i] = cmark_node_get_start_line(node);
+  INTEGER(VECTOR_ELT(t->cols, t->ncol - 3))[i] = cmark_node_get_start_column(node);
+  INTEGER(VECTOR_ELT(t->cols, t->ncol - 2))[i] = cmark_node_get_end_line(node);
+  INTEGER(VECTOR_ELT(t->cols, t->ncol - 1))[i] = cmark_node_get_end_column(node);
+  return i;
+}
+
+static void extract_string(extract_table *t, R_xlen_t i, int col, const char *str){
+  SET_STRING_ELT(VECTOR_ELT(t->cols, col), i, mk_string_or_na(str));
+}
+
+/* The text content of a node is collected while its descendants are walked;
+ * captures nest for e.g. an image inside a link inside a heading. */
+#define EXTRACT_MAX_CAPTURES 16
+
+typedef struct {
+  cmark_node *node;
+  extract_table *table;
+  R_xlen_t row;
+  int col;
+  cmark_strbuf buf;
+} extract_capture;
+
+/* Everything md_extract() allocates outside of R is owned by an external
+ * pointer, so it is freed when an error in a later document jumps out */
+typedef struct {
+  extract_capture captures[EXTRACT_MAX_CAPTURES];
+  cmark_node *doc;
+  cmark_iter *iter;
+} extract_state;
+
+static void fin_extract_state(SEXP ptr){
+  extract_state *st = R_ExternalPtrAddr(ptr);
+  if(!st)
+    return;
+  if(st->iter)
+    cmark_iter_free(st->iter);
+  if(st->doc)
+    cmark_node_free(st->doc);
+  for(int k = 0; k < EXTRACT_MAX_CAPTURES; k++)
+    cmark_strbuf_free(&st->captures[k].buf);
+  free(st);
+  R_ClearExternalPtr(ptr);
+}
+
+static void extract_document(extract_state *st, int index, int what, extract_table *tables){
+  extract_capture *captures = st->captures;
+  int ncaptures = 0;
+  cmark_event_type ev;
+  cmark_iter *iter = st->iter = cmark_iter_new(st->doc);
+  while ((ev = cmark_iter_next(iter)) != CMARK_EVENT_DONE) {
+    cmark_node *node = cmark_iter_get_node(iter);
+    cmark_node_type type = cmark_node_get_type(node);
+
+    /* skip the inlines of paragraphs and table cells which were not parsed */
+    if (ev == CMARK_EVENT_ENTER && (node->flags & CMARK_NODE__INLINES_PENDING) &&
+        type != CMARK_NODE_HEADING) {
+      cmark_iter_reset(iter, node, CMARK_EVENT_EXIT);
+      continue;
+    }
+    if (ev == CMARK_EVENT_EXIT) {
+      if (ncaptures && captures[ncaptures - 1].node == node) {
+        extract_capture *cap = &captures[--ncaptures];
+        extract_string(cap->table, cap->row, cap->col, cmark_strbuf_cstr(&cap->buf));
+        cmark_strbuf_clear(&cap->buf);
+      }
+      continue;
+    }
+
+    /* text of leaf nodes goes to all open captures */
+    const char *text = NULL;
+    if (type == CMARK_NODE_TEXT || type == CMARK_NODE_CODE)
+      text = cmark_node_get_literal(node);
+    else if (type == CMARK_NODE_SOFTBREAK || type == CMARK_NODE_LINEBREAK ||
+             type == CMARK_NODE_PARAGRAPH)
+      text = " ";
+    for (int k = 0; text && k < ncaptures; k++) {
+      if (type != CMARK_NODE_PARAGRAPH || captures[k].buf.size > 0)
+        cmark_strbuf_puts(&captures[k].buf, text);
+    }
+
+    extract_table *t = NULL;
+    R_xlen_t i = 0;
+    int text_col = 0;
+    if ((type == CMARK_NODE_LINK && (what & (1 << EXTRACT_LINKS))) ||
+        (type == CMARK_NODE_IMAGE && (what & (1 << EXTRACT_IMAGES)))) {
+      t = &tables[type == CMARK_NODE_LINK ? EXTRACT_LINKS : EXTRACT_IMAGES];
+      i = extract_row(t, index, node);
+      extract_string(t, i, 1, cmark_node_get_url(node));
+      extract_string(t, i, 2, cmark_node_get_title(node));
+      text_col = 3;
+    } else if (type == CMARK_NODE_HEADING && (what & (1 << EXTRACT_HEADINGS))) {
+      t = &tables[EXTRACT_HEADINGS];
+      i = extract_row(t, index, node);
+      INTEGER(VECTOR_ELT(t->cols, 1))[i] = cmark_node_get_heading_level(node);
+      text_col = 2;
+    } else if (type == CMARK_NODE_CODE_BLOCK && (what & (1 << EXTRACT_CODE))) {
+      t = &tables[EXTRACT_CODE];
+      i = extract_row(t, index, node);
+      extract_string(t, i, 1, code_info(node));
+      extract_string(t, i, 2, cmark_node_get_literal(node));
+    } else if (type == CMARK_NODE_FOOTNOTE_DEFINITION && (what & (1 << EXTRACT_FOOTNOTES))) {
+      t = &tables[EXTRACT_FOOTNOTES];
+      i = extract_row(t, index, node);
+      SET_STRING_ELT(VECTOR_ELT(t->cols, 1), i,
+                     Rf_mkCharLenCE((const char *) node->as.literal.data,
+                                    node->as.literal.len, CE_UTF8));
+      text_col = 2;
+    }
+    if (text_col) {
+      /* without children there is nothing to capture */
+      if (cmark_node_first_child(node) && ncaptures < EXTRACT_MAX_CAPTURES) {
+        extract_capture *cap = &captures[ncaptures++];
+        cap->node = node;
+        cap->table = t;
+        cap->row = i;
+        cap->col = text_col;
+      } else {
+        extract_string(t, i, text_col, cmark_node_first_child(node) ? NULL : "");
+      }
+    }
+  }
+  cmark_iter_free(iter);
+  st->iter = NULL;
+}
+
+/* Open every file up front, so a missing one fails before any is parsed */
+static void check_files(SEXP files){
+  for(R_xlen_t i = 0; i < Rf_xlength(files); i++){
+    const char *path = R_ExpandFileName(Rf_translateChar(STRING_ELT(files, i)));
+    FILE *fp = fopen(path, "rb");
+    if(!fp)
+      Rf_error("Failed to open file '%s'", path);
+    fclose(fp);
+  }
+}
+
+/* one of several documents, which are either elements of a list or files */
+static cmark_node *parse_nth_input(SEXP docs, SEXP files, R_xlen_t i, int options,
+                                   SEXP extensions, cmark_mem *mem){
+  if(Rf_isNull(files))
+    return parse_input(VECTOR_ELT(docs, i), R_NilValue, options, extensions, 0, mem);
+  SEXP file = PROTECT(Rf_ScalarString(STRING_ELT(files, i)));
+  cmark_node *doc = parse_input(R_NilValue, file, options, extensions, 0, mem);
+  UNPROTECT(1);
+  return doc;
+}
+
+/* Parse every document in turn and collect the requested nodes. Documents are
+ * either the elements of a list (string or raw vectors) or files. */
+SEXP R_md_extract(SEXP docs, SEXP what, SEXP smart, SEXP max_strikethrough,
+                  SEXP extensions, SEXP files){
+  if(!Rf_isNull(files) && !Rf_isString(files))
+    Rf_error("Argument 'file' must be a character vector.");
+  if(Rf_isNull(files) && TYPEOF(docs) != VECSXP)
+    Rf_error("Argument 'text' must be a list of documents.");
+  if(!Rf_isString(what))
+    Rf_error("Argument 'what' must be a character vector.");
+  int flags = 0;
+  for(int i = 0; i < Rf_length(what); i++){
+    int k;
+    for(k = 0; k < EXTRACT_KINDS && strcmp(CHAR(STRING_ELT(what, i)), extract_kinds[k]); k++)
+      ;
+    if(k == EXTRACT_KINDS)
+      Rf_error("Unknown node kind '%s'", CHAR(STRING_ELT(what, i)));
+    flags |= 1 << k;
+  }
+  R_xlen_t ndocs = Rf_isNull(files) ? Rf_xlength(docs) : Rf_xlength(files);
+  for(R_xlen_t i = 0; Rf_isNull(files) && i < ndocs; i++)
+    check_input(VECTOR_ELT(docs, i), R_NilValue);
+  check_files(files);
+  int options = get_options(Rf_ScalarLogical(FALSE), Rf_ScalarLogical(FALSE), smart,
+                            max_strikethrough, Rf_ScalarLogical(FALSE));
+  check_extensions(extensions);
+
+  /* footnote definitions are only parsed when they are requested, and only
+   * headings need their inlines if there are no links or images */
+  if(flags & (1 << EXTRACT_FOOTNOTES))
+    options |= CMARK_OPT_FOOTNOTES;
+  if(!(flags & (1 << EXTRACT_LINKS | 1 << EXTRACT_IMAGES | 1 << EXTRACT_FOOTNOTES)))
+    options |= CMARK_OPT_LAZY_INLINES;
+
+  SEXP res = PROTECT(Rf_mkNamed(VECSXP, extract_kinds));
+  extract_table tables[EXTRACT_KINDS];
+  for(int k = 0; k < EXTRACT_KINDS; k++)
+    extract_table_init(&tables[k], res, (extract_kind) k);
+
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  extract_state *st = calloc(1, sizeof(extract_state));
+  if(!st)
+    Rf_error("Failed to allocate memory for extraction");
+  SEXP ptr = PROTECT(R_MakeExternalPtr(st, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, fin_extract_state, TRUE);
+  for(int k = 0; k < EXTRACT_MAX_CAPTURES; k++)
+    cmark_strbuf_init(mem, &st->captures[k].buf, 0);
+  for(R_xlen_t i = 0; i < ndocs; i++){
+    st->doc = parse_nth_input(docs, files, i, options, extensions, mem);
+    extract_document(st, (int) i + 1, flags, tables);
+    cmark_node_free(st->doc);
+    st->doc = NULL;
+  }
+  fin_extract_state(ptr);
+
+  for(int k = 0; k < EXTRACT_KINDS; k++)
+    extract_table_resize(&tables[k], tables[k].n);
+  UNPROTECT(2);
+  return res;
+}
+
+SEXP R_md_text(SEXP docs, SEXP normalize_space, SEXP max_length, SEXP smart,
+               SEXP max_strikethrough, SEXP extensions, SEXP files){
+  if(!Rf_isNull(files) && !Rf_isString(files))
+    Rf_error("Argument 'file' must be a character vector.");
+  if(Rf_isNull(files) && TYPEOF(docs) != VECSXP)
+    Rf_error("Argument 'text' must be a list of documents.");
+  double max_len = Rf_asReal(max_length);
+  if(ISNAN(max_len) || max_len < 0)
+    Rf_error("Argument 'max_length' must be a non-negative number.");
+  R_xlen_t ndocs = Rf_isNull(files) ? Rf_xlength(docs) : Rf_xlength(files);
+  for(R_xlen_t i = 0; Rf_isNull(files) && i < ndocs; i++)
+    check_input(VECTOR_ELT(docs, i), R_NilValue);
+  check_files(files);
+  int options = get_options(Rf_ScalarLogical(FALSE), Rf_ScalarLogical(FALSE), smart,
+                            max_strikethrough, Rf_ScalarLogical(FALSE));
+  check_extensions(extensions);
+
+  /* inlines are parsed as the text is extracted, so a truncated text only
+   * parses the blocks it includes */
+  options |= CMARK_OPT_LAZY_INLINES;
+
+  SEXP res = PROTECT(Rf_allocVector(STRSXP, ndocs));
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  for(R_xlen_t i = 0; i < ndocs; i++){
+    cmark_node *doc = parse_nth_input(docs, files, i, options, extensions, mem);
+    char *text = cmark_extract_text(doc, Rf_asLogical(normalize_space) == TRUE,
+                                    max_len > INT_MAX ? 0 : (size_t) max_len, mem);
+    cmark_node_free(doc);
+    SET_STRING_ELT(res, i, Rf_mkCharCE(text, CE_UTF8));
+    mem->free(text);
+  }
+  UNPROTECT(1);
+  return res;
+}
+
+/* Parse a document and write its tree to a file in the binary format of
+ * cmark_ast_save(), to render it later without parsing */
+SEXP R_md_save(SEXP text, SEXP path, SEXP smart, SEXP max_strikethrough, SEXP normalize,
+               SEXP extensions, SEXP file){
+  check_input(text, file);
+  if(!Rf_isString(path) || Rf_length(path) != 1)
+    Rf_error("Argument 'path' must be a single path.");
+  int options = get_options(Rf_ScalarLogical(FALSE), Rf_ScalarLogical(FALSE), smart,
+                            max_strikethrough, normalize);
+  check_extensions(extensions);
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_node *doc = parse_input(text, file, options, extensions, 0, mem);
+  size_t len;
+  unsigned char *data = cmark_ast_save(doc, &len, mem);
+  cmark_node_free(doc);
+  if(!data)
+    Rf_error("Failed to serialize document");
+  const char *out = R_ExpandFileName(Rf_translateChar(STRING_ELT(path, 0)));
+  FILE *fp = fopen(out, "wb");
+  size_t written = fp ? fwrite(data, 1, len, fp) : 0;
+  int closed = fp ? fclose(fp) == 0 : 0;
+  mem->free(data);
+  if(!fp)
+    Rf_error("Failed to open file '%s'", out);
+  if(written != len || !closed)
+    Rf_error("Failed to write file '%s'", out);
+  return path;
+}
+
+/* Load a tree written by md_save() and render it */
+SEXP R_md_load(SEXP path, SEXP format, SEXP sourcepos, SEXP hardbreaks, SEXP width){
+  if(!Rf_isString(path) || Rf_length(path) != 1)
+    Rf_error("Argument 'path' must be a single path.");
+  if(!Rf_isInteger(format))
+    Rf_error("Argument 'format' must be integer.");
+  if(!Rf_isInteger(width))
+    Rf_error("Argument 'width' must be integer.");
+  int options = get_options(sourcepos, hardbreaks, Rf_ScalarLogical(FALSE),
+                            Rf_ScalarLogical(FALSE), Rf_ScalarLogical(FALSE));
+  const char *in = R_ExpandFileName(Rf_translateChar(STRING_ELT(path, 0)));
+  size_t len;
+  char *data = map_file(in, &len);
+  if(!data)
+    Rf_error("Failed to read file '%s': %s", in, strerror(errno));
+  cmark_mem *mem = cmark_get_default_mem_allocator();
+  cmark_node *doc = cmark_ast_load((const unsigned char *) data, len, mem);
+  unmap_file(data, len);
+  if(!doc)
+    Rf_error("File '%s' is not a document saved by this version of md_save()", in);
+  return render_document(doc, Rf_asInteger(format), options, Rf_asInteger(width), mem, 0, 0, 0);
+}
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Renders the same generated files with --batch on one and on several
+# threads, with inline extensions, and checks that the outputs agree.
+# Usage: test-batch.sh [path to the cmarkjg CLI]
+set -e
+cmark=${1:-./cmarkjg.exe}
+case $cmark in /*) ;; *) cmark=$(pwd)/$cmark ;; esac
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+exts="-e strikethrough -e math -e superscript -e subscript -e table -e autolink"
+
+cd "$dir"
+mkdir in
+# long enough that parses on different threads overlap
+para='word ~~del~~ and H~2~O x^2^ $a+b$ *em* www.example.com\n\n| a | b |\n|---|---|\n| ~c~ | ^x^ |\n\n'
+i=0
+while [ $i -lt 100 ]; do
+  para="$para$para"
+  i=$((i + 20))
+done
+i=0
+while [ $i -lt 300 ]; do
+  printf "$para" > in/doc$i.md
+  i=$((i + 1))
+done
+
+"$cmark" --batch -j 1 --out-dir serial $exts in/*.md 2> /dev/null
+"$cmark" --batch -j 8 --out-dir parallel $exts in/*.md 2> /dev/null
+grep -q "<del>del</del>" serial/in/doc0.html
+diff -r serial parallel
+
+# phases are not timed on the batch threads
+if "$cmark" --batch -j 2 --out-dir timed --timings in/doc0.md 2> /dev/null; then
+  echo "batch: --timings accepted with -j 2"
+  exit 1
+fi
+"$cmark" --batch -j 1 --out-dir timed --timings in/doc0.md 2>&1 | grep -q "^blocks"
+echo "batch: ok"
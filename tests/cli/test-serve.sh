@@ -0,0 +1,27 @@
+#!/bin/sh
+# Sends requests to --serve, including headers with invalid or huge
+# lengths, which must be answered with an error instead of a crash.
+# Usage: test-serve.sh [path to the cmarkjg CLI]
+cmark=${1:-./cmarkjg.exe}
+failed=0
+
+# serve REQUEST EXPECTED-EXIT-STATUS EXPECTED-OUTPUT-PATTERN
+serve() {
+  out=$(printf '%b' "$1" | "$cmark" --serve 2> /dev/null)
+  status=$?
+  if [ $status -ne $2 ] || ! printf '%s' "$out" | grep -q "$3"; then
+    echo "serve: request '$1' gave status $status and output '$out'"
+    failed=1
+  fi
+}
+
+serve '4\n# Hi' 0 '^ok 12$'
+serve '4\n# Hi3 -t xml\nabc' 0 '<text xml:space="preserve">abc</text>'
+serve '-1\n' 1 'Invalid request header'
+serve ' 4\n# Hi' 1 'Invalid request header'
+serve '18446744073709551615\n' 1 'longer than the maximum'
+serve '99999999999999\n' 1 'longer than the maximum'
+serve '99999999999999999999999\n' 1 'longer than the maximum'
+
+[ $failed -eq 0 ] && echo "serve: ok"
+exit $failed
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Renders html on several threads with the tagfilter extension, for a
+# document split across the threads and one too short to be split, and
+# checks that the filter applies to both.
+# Usage: test-threads.sh [path to the cmarkjg CLI]
+set -e
+cmark=${1:-./cmarkjg.exe}
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+printf '<script>alert(1)</script>\n\ntext\n' > "$dir/short.md"
+i=0
+while [ $i -lt 200 ]; do
+  printf 'para %d\n\n<title>t</title>\n\n' $i >> "$dir/long.md"
+  i=$((i + 1))
+done
+
+for f in short long; do
+  "$cmark" --unsafe --threads 1 -e tagfilter "$dir/$f.md" > "$dir/$f.1.html"
+  "$cmark" --unsafe --threads 4 -e tagfilter "$dir/$f.md" > "$dir/$f.4.html"
+  if grep -q "<script\|<title" "$dir/$f.4.html"; then
+    echo "threads: tags not filtered in $f.md"
+    exit 1
+  fi
+  cmp "$dir/$f.1.html" "$dir/$f.4.html"
+done
+echo "threads: ok"